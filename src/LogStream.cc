@@ -8,11 +8,18 @@
  */
 
 
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+
 #include "LogStream.h"
+#include "LogWriter.h"
 
 
 LogStream::LogStream():
-    _str( stderr, QIODevice::WriteOnly )
+    _str( stderr, QIODevice::WriteOnly ),
+    _writer( 0 ),
+    _syncLine( false )
 {
 
 }
@@ -35,6 +42,9 @@ bool LogStream::open( const QString & filename )
         if ( filename != "/dev/null" && filename != "/dev/stderr" )
             openMode |= QIODevice::Append;
 
+        QWriteLocker locker( &_writerLock );
+
+        deleteWriter();
         _logFile.setFileName( filename );
 
         if ( _logFile.open( openMode ) )
@@ -53,11 +63,135 @@ bool LogStream::open( const QString & filename )
 
 void LogStream::close()
 {
+    QWriteLocker locker( &_writerLock );
+
+    deleteWriter();
+
     if ( _logFile.isOpen() )
         _logFile.close();
 }
 
 
+void LogStream::startWriter( int flushInterval )
+{
+    QWriteLocker locker( &_writerLock );
+
+    createWriter( flushInterval );
+}
+
+
+void LogStream::stopWriter()
+{
+    QWriteLocker locker( &_writerLock );
+
+    deleteWriter();
+}
+
+
+void LogStream::restartWriter( int flushInterval )
+{
+    QWriteLocker locker( &_writerLock );
+
+    deleteWriter();
+    createWriter( flushInterval );
+}
+
+
+void LogStream::createWriter( int flushInterval )
+{
+    if ( _writer || ! _logFile.isOpen() )
+        return;
+
+    _str.flush();
+    _writer = new LogWriter( &_logFile, flushInterval );
+
+    _lineBuffer.clear();
+    _str.setString( &_lineBuffer, QIODevice::WriteOnly );
+}
+
+
+void LogStream::deleteWriter()
+{
+    if ( ! _writer )
+        return;
+
+    delete _writer;  // This writes everything that is pending
+    _writer = 0;
+
+    _str.setDevice( &_logFile );
+    _str << _lineBuffer;  // An incomplete line
+    _lineBuffer.clear();
+}
+
+
+void LogStream::endLine()
+{
+    QReadLocker locker( &_writerLock );
+
+    if ( _writer )
+    {
+        // QTextStream appends to _lineBuffer right away with setString(),
+        // there is nothing to flush.
+
+        _lineBuffer += '\n';
+        _writer->write( _lineBuffer.toUtf8() );
+        _lineBuffer.resize( 0 );  // Keep the capacity for the next line
+
+        if ( _syncLine )
+            _writer->flush();
+    }
+    else
+    {
+        QMutexLocker strLocker( &_strMutex );
+
+        _str << '\n';
+        _str.flush();
+    }
+
+    _syncLine = false;
+}
+
+
+void LogStream::writeLine( const QByteArray & line, bool sync )
+{
+    // Other threads may write at the same time, but the writer can't be
+    // started or stopped while we hold this lock.
+
+    QReadLocker locker( &_writerLock );
+
+    if ( _writer )
+    {
+        _writer->write( line + '\n' );
+
+        if ( sync )
+            _writer->flush();
+    }
+    else
+    {
+        QMutexLocker strLocker( &_strMutex );
+
+        _str << QString::fromUtf8( line ) << '\n';
+        _str.flush();
+    }
+}
+
+
+void LogStream::flush()
+{
+    QReadLocker locker( &_writerLock );
+
+    if ( _writer )
+    {
+        _writer->flush();
+    }
+    else
+    {
+        QMutexLocker strLocker( &_strMutex );
+        _str.flush();
+    }
+}
+
+
 LogStream & LogStream::operator<<( LogStream & (*func)( LogStream & str ) )
 {
     func( *this );
@@ -70,8 +204,7 @@ namespace LogStr
 {
     LogStream & endl( LogStream & str )
     {
-        str.str() << '\n';
-        str.str().flush();
+        str.endLine();
 
         return str;
     }
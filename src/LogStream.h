@@ -11,11 +11,16 @@
 #define LogStream_h
 
 #include <QFile>
+#include <QMutex>
+#include <QReadWriteLock>
 #include <QString>
 #include <QStringList>
 #include <QTextStream>
 
 
+class LogWriter;
+
+
 
 /**
  * Stream class for the logger as a base for overloaded stream output operators
@@ -27,6 +32,12 @@
  * versions.
  *
  * This class uses composition, not inheritance to avoid this problem.
+ *
+ * The operator<<() functions and endl are meant for one thread only.
+ * writeLine() and flush() may be called from any thread: With a background
+ * writer, the lines go to its lock-free queue; without one, they are written
+ * to the log under a mutex. Starting and stopping the writer waits until
+ * no other thread is writing.
  **/
 class LogStream
 {
@@ -54,9 +65,61 @@ public:
 
     /**
      * Close the current log if it is open.
+     * This also stops the background writer.
      **/
     void close();
 
+    /**
+     * Write complete lines to the open log in the background (see LogWriter)
+     * rather than each one right away, at the latest after 'flushInterval'
+     * milliseconds. With 0, each line is still written right away.
+     *
+     * From now on, the output is collected in a line buffer until the next
+     * 'endl'.
+     **/
+    void startWriter( int flushInterval );
+
+    /**
+     * Write all pending lines and go back to writing to the log directly.
+     **/
+    void stopWriter();
+
+    /**
+     * Stop the background writer and start a new one with 'flushInterval'
+     * without letting any other thread write in between.
+     **/
+    void restartWriter( int flushInterval );
+
+    /**
+     * Return 'true' if lines are written in the background.
+     **/
+    bool hasWriter() const { return _writer != 0; }
+
+    /**
+     * Write the line that is now complete (after 'endl').
+     * If 'setSyncLine()' was called for it, wait until it is written.
+     **/
+    void endLine();
+
+    /**
+     * Wait until the current line is written to the log file when it is
+     * complete rather than writing it in the background.
+     **/
+    void setSyncLine( bool sync = true ) { _syncLine = sync; }
+
+    /**
+     * Write a complete preformatted line (without newline) to the log.
+     *
+     * Unlike the operator<<() functions, this is thread-safe. If 'sync' is
+     * 'true', this waits until the line is written.
+     **/
+    void writeLine( const QByteArray & line, bool sync = false );
+
+    /**
+     * Write all pending lines now.
+     **/
+    void flush();
+
     /**
      * Return the internally used stream.
      * This can be used in overloaded operator<<() methods.
@@ -81,8 +144,25 @@ public:
 
 protected:
 
-    QTextStream _str;
-    QFile       _logFile;
+    /**
+     * Create the background writer. _writerLock must be locked for writing.
+     **/
+    void createWriter( int flushInterval );
+
+    /**
+     * Delete the background writer. _writerLock must be locked for writing.
+     **/
+    void deleteWriter();
+
+
+    QTextStream     _str;
+    QFile           _logFile;
+    LogWriter *     _writer;
+    QString         _lineBuffer;
+    bool            _syncLine;
+
+    QReadWriteLock  _writerLock;    // for _writer and _logFile
+    QMutex          _strMutex;      // for _str without a writer
 
 }; // class LogStream
 
@@ -91,7 +171,8 @@ protected:
 namespace LogStr
 {
     /**
-     * 'endl' stream manipulator: Output a newline and flush the stream.
+     * 'endl' stream manipulator: Output a newline and write the line
+     * (see LogStream::endLine()).
      **/
     LogStream & endl( LogStream & str );
 
@@ -0,0 +1,149 @@
+/*  ---------------------------------------------------------
+               __  __            _
+              |  \/  |_   _ _ __| |_   _ _ __
+              | |\/| | | | | '__| | | | | '_ \
+              | |  | | |_| | |  | | |_| | | | |
+              |_|  |_|\__, |_|  |_|\__, |_| |_|
+                      |___/        |___/
+    ---------------------------------------------------------
+
+    Project:  Myrlyn Package Manager GUI
+    Copyright (c) Stefan Hundhammer <Stefan.Hundhammer@gmx.de>
+    License:  GPL V2 - See file LICENSE for details.
+
+ */
+
+
+#include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+
+#include "LogWriter.h"
+
+
+// Wake up the writer thread before the flush interval is over if this many
+// lines are pending
+
+#define MAX_PENDING_RECORDS     512
+
+
+// Not using the logger here: This is what the logger uses.
+
+
+LogWriter::LogWriter( QFile * file, int flushInterval )
+    : _file( file )
+    , _flushInterval( flushInterval )
+    , _pending( 0 )
+    , _thread( 0 )
+{
+    if ( _flushInterval > 0 )
+    {
+        _thread = QThread::create( [this]() { run(); } );
+        _thread->start();
+    }
+}
+
+
+LogWriter::~LogWriter()
+{
+    {
+        QMutexLocker locker( &_waitMutex );
+
+        _stop.storeRelaxed( 1 );
+        _wakeUp.wakeOne();
+    }
+
+    if ( _thread )
+    {
+        _thread->wait();
+        delete _thread;
+    }
+
+    flush();  // Anything that was written during the last round
+}
+
+
+void LogWriter::write( const QByteArray & line )
+{
+    Record * record = new Record( line );
+    Record * head   = _pending.loadRelaxed();
+
+    do
+    {
+        record->next = head;
+    }
+    while ( ! _pending.testAndSetRelease( head, record, head ) );
+
+    int pendingCount = _pendingCount.fetchAndAddRelaxed( 1 ) + 1;
+
+    if ( ! _thread )  // No buffering
+        flush();
+    else if ( pendingCount == MAX_PENDING_RECORDS )
+    {
+        // Not taking _waitMutex here: If the writer thread misses this
+        // wakeup, it will still write this line after the flush interval.
+
+        _wakeUp.wakeOne();
+    }
+}
+
+
+LogWriter::Record * LogWriter::takePending()
+{
+    Record * record = _pending.fetchAndStoreAcquire( 0 );
+    Record * result = 0;
+    int      count  = 0;
+
+    // Reverse the list
+
+    while ( record )
+    {
+        Record * next = record->next;
+
+        record->next = result;
+        result = record;
+        record = next;
+        ++count;
+    }
+
+    _pendingCount.fetchAndSubRelaxed( count );
+
+    return result;
+}
+
+
+void LogWriter::flush()
+{
+    QMutexLocker locker( &_writeMutex );
+
+    Record * record = takePending();
+
+    if ( ! record )
+        return;
+
+    // QFile buffers this, so this is only very few write() system calls for
+    // the whole batch.
+
+    while ( record )
+    {
+        Record * next = record->next;
+
+        _file->write( record->line );
+        delete record;
+        record = next;
+    }
+
+    _file->flush();
+}
+
+
+void LogWriter::run()
+{
+    QMutexLocker locker( &_waitMutex );
+
+    while ( ! _stop.loadRelaxed() )
+    {
+        _wakeUp.wait( &_waitMutex, _flushInterval );
+        flush();
+    }
+}
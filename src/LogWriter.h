@@ -0,0 +1,127 @@
+/*  ---------------------------------------------------------
+               __  __            _
+              |  \/  |_   _ _ __| |_   _ _ __
+              | |\/| | | | | '__| | | | | '_ \
+              | |  | | |_| | |  | | |_| | | | |
+              |_|  |_|\__, |_|  |_|\__, |_| |_|
+                      |___/        |___/
+    ---------------------------------------------------------
+
+    Project:  Myrlyn Package Manager GUI
+    Copyright (c) Stefan Hundhammer <Stefan.Hundhammer@gmx.de>
+    License:  GPL V2 - See file LICENSE for details.
+
+ */
+
+
+#ifndef LogWriter_h
+#define LogWriter_h
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QByteArray>
+#include <QMutex>
+#include <QWaitCondition>
+
+
+class QFile;
+class QThread;
+
+
+/**
+ * Background writer for a log file: Any thread can hand over complete,
+ * preformatted log lines with write(); a writer thread collects them and
+ * writes them to the file in batches, at the latest every 'flushInterval'
+ * milliseconds, or earlier if a lot of lines are pending.
+ *
+ * write() never blocks and never takes a mutex: The pending lines are a
+ * lock-free list (any number of producers, one consumer at a time) that the
+ * consumer takes over as a whole.
+ *
+ * flush() writes everything that is pending right away in the calling
+ * thread; use that for lines that must not get lost if the program crashes
+ * (errors) and before exiting.
+ *
+ * This class does not own the file; it only writes to it until it is
+ * destroyed. Don't write to the file directly during that time.
+ **/
+class LogWriter
+{
+public:
+
+    /**
+     * Constructor: Start the writer thread for 'file' which must already be
+     * open for writing.
+     *
+     * If 'flushInterval' is 0 or less, there is no writer thread, and each
+     * write() writes the line to the file right away.
+     **/
+    LogWriter( QFile * file, int flushInterval );
+
+    /**
+     * Destructor: Write everything that is pending and stop the writer
+     * thread.
+     **/
+    ~LogWriter();
+
+    /**
+     * Add a complete log line (including the trailing newline) to the
+     * pending lines. This may be called from any thread.
+     **/
+    void write( const QByteArray & line );
+
+    /**
+     * Write all pending lines to the file now and flush the file.
+     * This may be called from any thread.
+     **/
+    void flush();
+
+    /**
+     * Return the interval in milliseconds after which pending lines are
+     * written at the latest.
+     **/
+    int flushInterval() const { return _flushInterval; }
+
+
+protected:
+
+    /**
+     * One pending log line.
+     **/
+    struct Record
+    {
+        Record( const QByteArray & line ): next( 0 ), line( line ) {}
+
+        Record *   next;
+        QByteArray line;
+    };
+
+    /**
+     * The main loop of the writer thread.
+     **/
+    void run();
+
+    /**
+     * Take all pending records and return them in the order in which they
+     * were written (the list has the most recent one first).
+     **/
+    Record * takePending();
+
+
+    // Data members
+
+    QFile *                 _file;
+    int                     _flushInterval;
+
+    QAtomicPointer<Record>  _pending;       // most recent first
+    QAtomicInt              _pendingCount;
+    QAtomicInt              _stop;
+
+    QMutex                  _writeMutex;    // for _file
+    QMutex                  _waitMutex;
+    QWaitCondition          _wakeUp;
+    QThread *               _thread;
+};
+
+
+#endif // LogWriter_h
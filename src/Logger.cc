@@ -15,8 +15,10 @@
 #include <QStringList>
 
 #include <iostream>     // cerr
-#include <string.h>     // strlen()
-#include <stdlib.h>     // abort(), mkdtemp()
+#include <string.h>     // strlen(), strrchr()
+#include <stdio.h>      // snprintf()
+#include <stdlib.h>     // abort(), mkdtemp(), atexit()
+#include <time.h>       // clock_gettime(), localtime_r(), strftime()
 #include <unistd.h>     // getpid()
 #include <errno.h>
 #include <pwd.h>        // getpwuid()
@@ -25,7 +27,8 @@
 #include "Logger.h"
 
 
-#define VERBOSE_ROTATE  0
+#define VERBOSE_ROTATE          0
+#define DEFAULT_FLUSH_INTERVAL  500     // millisec
 
 using std::cerr;
 using LogStr::endl;
@@ -38,8 +41,9 @@ static void qt_logger( QtMsgType                  msgType,
                        const QString &            msg );
 
 
-Logger * Logger::_defaultLogger = 0;
-QString  Logger::_lastLogDir;
+Logger *        Logger::_defaultLogger = 0;
+QString         Logger::_lastLogDir;
+QList<Logger *> Logger::_loggers;
 
 
 Logger::Logger( const QString & filename )
@@ -73,10 +77,12 @@ Logger::Logger( const QString & rawLogDir,
 
 Logger::~Logger()
 {
+    _loggers.removeAll( this );
+
     if ( _logStream.isOpen() )
     {
         // logInfo() << "-- Log End --\n" << endl;
-        _logStream.close();
+        _logStream.close();  // This writes all pending lines
     }
 
     if ( this == _defaultLogger )
@@ -89,7 +95,19 @@ Logger::~Logger()
 
 void Logger::init()
 {
-    _logLevel = LogSeverityVerbose;
+    _logLevel      = LogSeverityVerbose;
+    _flushInterval = DEFAULT_FLUSH_INTERVAL;
+
+    bool ok      = false;
+    int interval = qEnvironmentVariableIntValue( "MYRLYN_LOG_FLUSH_INTERVAL", &ok );
+
+    if ( ok )
+        _flushInterval = interval;
+
+    if ( _loggers.isEmpty() )
+        atexit( flushAll );  // No harm if that is done more than once
+
+    _loggers << this;
 }
 
 
@@ -120,6 +138,7 @@ void Logger::openLogFile( const QString & filename )
 
             cerr << "Logging to " << qPrintable( filename ) << std::endl;
             _logStream << "\n\n";
+            _logStream.startWriter( _flushInterval );
             log( __FILE__, __LINE__, __FUNCTION__, LogSeverityInfo )
                 << "-- Log Start --" << endl;
         }
@@ -143,6 +162,19 @@ LogStream & Logger::log( Logger *        logger,
                          int             srcLine,
                          const QString & srcFunction,
                          LogSeverity     severity )
+{
+    return log( logger,
+                srcFile.toUtf8().constData(), srcLine,
+                srcFunction.toUtf8().constData(),
+                severity );
+}
+
+
+LogStream & Logger::log( Logger *        logger,
+                         const char *    srcFile,
+                         int             srcLine,
+                         const char *    srcFunction,
+                         LogSeverity     severity )
 {
     static LogStream stderrStream;
 
@@ -165,11 +197,22 @@ LogStream & Logger::log( const QString & srcFile,
                          int             srcLine,
                          const QString & srcFunction,
                          LogSeverity     severity )
+{
+    return log( srcFile.toUtf8().constData(), srcLine,
+                srcFunction.toUtf8().constData(),
+                severity );
+}
+
+
+LogStream & Logger::log( const char *    srcFile,
+                         int             srcLine,
+                         const char *    srcFunction,
+                         LogSeverity     severity )
 {
     if ( severity < _logLevel )
         return _nullStream;
 
-    std::string sev;
+    const char * sev = "";
 
     switch ( severity )
     {
@@ -182,36 +225,32 @@ LogStream & Logger::log( const QString & srcFile,
             // complain about unhandled enum values
     }
 
+    // Don't let errors get lost if the program crashes
+
+    _logStream.setSyncLine( severity >= LogSeverityError );
+
     _logStream << Logger::timeStamp() << " "
-               << "[" << (int) getpid() << "] "
+               << "[" << pid() << "] "
                << sev << " ";
 
-    if ( ! srcFile.isEmpty() )
+    if ( srcFile && *srcFile )
     {
-        if ( srcFile.contains( "/") )
-        {
-            // CMake just dumps the whole path wholesale to the compiler
-            // command line which gcc merrily uses as __FILE__;
-            // which results in an abysmal-looking log line.
-            // So let's cut off the path: Use only the last (No. -1)
-            // section delimited with '/'.
+        // CMake just dumps the whole path wholesale to the compiler
+        // command line which gcc merrily uses as __FILE__;
+        // which results in an abysmal-looking log line.
+        // So let's cut off the path: Use only the part after the last '/'.
+        //
+        // I hate CMake. Seriously, WTF?!
 
-            QString basename = srcFile.section( '/', -1 );
-            _logStream << basename;
-
-            // I hate CMake. Seriously, WTF?!
-        }
-        else
-        {
-            _logStream << srcFile;
-        }
+        const char * basename = strrchr( srcFile, '/' );
+        _logStream << ( basename ? basename + 1 : srcFile );
 
         if ( srcLine > 0 )
             _logStream << ":" << srcLine;
 
         _logStream << " ";
 
-        if ( ! srcFunction.isEmpty() )
+        if ( srcFunction && *srcFunction )
             _logStream << srcFunction << "():  ";
     }
 
@@ -257,9 +296,73 @@ void Logger::newline()
 }
 
 
+void Logger::flush()
+{
+    _logStream.flush();
+}
+
+
+void Logger::flush( Logger * logger )
+{
+    if ( ! logger )
+        logger = Logger::defaultLogger();
+
+    if ( logger )
+        logger->flush();
+}
+
+
+void Logger::setFlushInterval( int millisec )
+{
+    _flushInterval = millisec;
+
+    if ( _logStream.hasWriter() )
+        _logStream.restartWriter( _flushInterval );
+}
+
+
+void Logger::flushAll()
+{
+    // exit() does not destroy the Logger on the stack of main(), and the
+    // logger for libzypp is typically not destroyed either.
+
+    for ( Logger * logger: Logger::_loggers )
+        logger->flush();
+}
+
+
 QString Logger::timeStamp()
 {
-    return QDateTime::currentDateTime().toString( "yyyy-MM-dd hh:mm:ss.zzz" );
+    // QDateTime::toString() is expensive with all the time zone and locale
+    // handling. Format the date and time only once per second for each
+    // thread and add the milliseconds.
+
+    thread_local time_t lastSec = -1;
+    thread_local char   secStr[ 32 ];
+
+    struct timespec now;
+    clock_gettime( CLOCK_REALTIME, &now );
+
+    if ( now.tv_sec != lastSec )
+    {
+        struct tm localTime;
+        localtime_r( &now.tv_sec, &localTime );
+        strftime( secStr, sizeof( secStr ), "%Y-%m-%d %H:%M:%S", &localTime );
+        lastSec = now.tv_sec;
+    }
+
+    char result[ 48 ];
+    snprintf( result, sizeof( result ), "%s.%03ld", secStr, now.tv_nsec / 1000000 );
+
+    return QString::fromLatin1( result );
+}
+
+
+int Logger::pid()
+{
+    static const int pid = (int) getpid();
+
+    return pid;
 }
 
 
@@ -399,6 +502,7 @@ static void qt_logger( QtMsgType                  msgType,
         {
             cerr << "FATAL: " << qPrintable( msg ) << std::endl;
             logInfo() << "-- Aborting with core dump --\n" << endl;
+            Logger::flush( 0 ); // abort() doesn't call flushAll()
             abort(); // Exit with core dump (it might contain a useful backtrace)
         }
     }
@@ -13,6 +13,7 @@
 
 #include <string>
 
+#include <QList>
 #include <QString>
 #include <QStringList>
 
@@ -104,6 +105,14 @@ enum LogSeverity
  * QByteArray, int).
  *
  * This class also redirects Qt logging (qDebug() etc.) to the same log file.
+ *
+ * The complete lines are written to the log file by a background thread
+ * (see LogWriter) in batches at the latest after the flush interval, so
+ * verbose logging does not slow down the application much. Errors are
+ * written right away, and so is everything that is pending when the logger
+ * is destroyed or when the program calls exit().
+ *
+ * The stream output is not thread-safe; use it only in the main thread.
  */
 class Logger
 {
@@ -142,6 +151,11 @@ public:
      * Internal logging function. In most cases, better use the logDebug(),
      * logWarning() etc. macros instead.
      */
+    LogStream & log( const char *    srcFile,
+                     int             srcLine,
+                     const char *    srcFunction,
+                     LogSeverity     severity );
+
     LogStream & log( const QString & srcFile,
                      int             srcLine,
                      const QString & srcFunction,
@@ -153,6 +167,12 @@ public:
      *
      * If 'logger' is 0, the default logger is used.
      */
+    static LogStream & log( Logger        * logger,
+                            const char    * srcFile,
+                            int             srcLine,
+                            const char    * srcFunction,
+                            LogSeverity     severity );
+
     static LogStream & log( Logger        * logger,
                             const QString & srcFile,
                             int             srcLine,
@@ -166,12 +186,46 @@ public:
     void newline();
     static void newline( Logger * logger );
 
+    /**
+     * Write all pending log lines to the log file now.
+     */
+    void flush();
+
+    /**
+     * Static version of flush().
+     *
+     * If 'logger' is 0, the default logger is used.
+     */
+    static void flush( Logger * logger );
+
+    /**
+     * Return the interval in milliseconds after which pending log lines are
+     * written to the log file at the latest.
+     *
+     * The default is taken from the MYRLYN_LOG_FLUSH_INTERVAL environment
+     * variable or, if that is not set, 500 milliseconds.
+     */
+    int flushInterval() const { return _flushInterval; }
+
+    /**
+     * Set the flush interval. 0 means to write each line right away like a
+     * plain file would.
+     */
+    void setFlushInterval( int millisec );
+
     /**
      * Return a timestamp string in the format used in the log file:
      * "yyyy-MM-dd hh:mm:ss.zzz"
+     *
+     * This is thread-safe.
      */
     static QString timeStamp();
 
+    /**
+     * Return the process ID for the log lines.
+     */
+    static int pid();
+
     /**
      * Prefix each line of a multi-line text with 'prefix'.
      */
@@ -297,6 +351,11 @@ protected:
      **/
     static QString expandVariables( const QString & unexpanded );
 
+    /**
+     * Write the pending log lines of all loggers. This is called at exit().
+     **/
+    static void flushAll();
+
     /**
      * Return the name for an old log file based on 'filename' for old log
      * no. 'no'.
@@ -312,13 +371,15 @@ protected:
 
 private:
 
-    static Logger * _defaultLogger;
-    static QString  _lastLogDir;
+    static Logger *         _defaultLogger;
+    static QString          _lastLogDir;
+    static QList<Logger *>  _loggers;   // for flushing them at exit()
 
     LogStream       _logStream;
     QString         _logFilename;
     LogStream       _nullStream;
     LogSeverity     _logLevel;
+    int             _flushInterval;
 };
 
 
@@ -43,6 +43,7 @@ enum MyrlynAppOption
     OptDownloadOnly     = 0x04,
     OptNoRepoRefresh    = 0x08,
     OptForceServiceView = 0x10,
+    OptPrefetch         = 0x20,
 
     // For debugging
 
@@ -23,12 +23,14 @@
 #include <zypp/ZYppFactory.h>
 #include <zypp/Locale.h>
 #include <zypp/ZConfig.h>
+#include <zypp/Target.h>
 
 #include "Exception.h"
 #include "KeyRingCallbacks.h"
 #include "Logger.h"
 #include "MainWindow.h"
 #include "MyrlynApp.h"
+#include "PkgSearchIndex.h"
 #include "QY2CursorHelper.h"
 #include "YQi18n.h"
 #include "utf8.h"
@@ -175,6 +177,10 @@ void MyrlynRepoManager::attachRepos()
         findEnabledRepos();
         refreshRepos();
         loadRepos();
+
+        // This loads or builds the index in the background
+
+        PkgSearchIndex::instance()->setCacheKey( searchIndexKey() );
     }
     catch ( const zypp::Exception & ex )
     {
@@ -289,6 +295,31 @@ void MyrlynRepoManager::loadRepos()
 }
 
 
+QString MyrlynRepoManager::searchIndexKey()
+{
+    QStringList keyParts;
+
+    zypp::Target_Ptr target = zyppPtr()->target();
+
+    if ( target )
+        keyParts << QString( "@System:%1" ).arg( (qlonglong) (time_t) target->timestamp() );
+
+    for ( const ZyppRepoInfo & repo: _repos )
+    {
+        if ( repo.enabled() )
+        {
+            zypp::RepoStatus status = repoManager()->metadataStatus( repo );
+
+            keyParts << QString( "%1:%2" )
+                .arg( fromUTF8( repo.alias() ) )
+                .arg( fromUTF8( status.checksum() ) );
+        }
+    }
+
+    return keyParts.join( "|" );
+}
+
+
 void MyrlynRepoManager::notifyUserToRunZypperDup() const
 {
     logInfo() << "Run 'sudo zypper refresh' and restart the program." << endl;
@@ -154,6 +154,12 @@ protected:
      **/
     void loadRepos();
 
+    /**
+     * Return a key for the package search index that changes whenever the
+     * metadata of any enabled repo or the installed packages change.
+     **/
+    QString searchIndexKey();
+
     /**
      * Notify the user to run 'zypper dup' in a warning pop-up and on stderr.
      * This does not exit.
@@ -28,6 +28,7 @@
 #include <zypp/sat/FileConflicts.h>
 
 #include "utf8.h"
+#include "PkgCommitTimings.h"
 #include "YQZypp.h"     // ZyppRes
 
 #define TEST_FILE_CONFLICTS     0
@@ -203,6 +204,7 @@ struct PkgDownloadCallback:
 
     virtual void start( ZyppRes zyppRes, const Url & /*url*/ ) override
         {
+            PkgCommitTimings::instance()->record( zyppRes, PkgCommitTimings::DownloadStart );
             PkgCommitSignalForwarder::instance()->sendPkgDownloadStart( zyppRes );
         }
 
@@ -219,6 +221,7 @@ struct PkgDownloadCallback:
                          PkgDownloadError    error,
                          const std::string & reason )  override
         {
+            PkgCommitTimings::instance()->record( zyppRes, PkgCommitTimings::DownloadEnd );
             PkgCommitSignalForwarder::instance()->sendPkgDownloadEnd( zyppRes );
         }
 
@@ -246,6 +249,7 @@ struct PkgDownloadCallback:
     virtual void infoInCache( ZyppRes zyppRes,
                               const Pathname & /*localfile*/ )  override
         {
+            PkgCommitTimings::instance()->record( zyppRes, PkgCommitTimings::CacheHit );
             PkgCommitSignalForwarder::instance()->sendPkgCachedNotify( zyppRes );
         }
 
@@ -297,6 +301,7 @@ struct PkgInstallCallback:
 {
     virtual void start( ZyppRes zyppRes ) override
         {
+            PkgCommitTimings::instance()->record( zyppRes, PkgCommitTimings::InstallStart );
             PkgCommitSignalForwarder::instance()->sendPkgInstallStart( zyppRes );
         }
 
@@ -314,6 +319,7 @@ struct PkgInstallCallback:
                          const std::string & /*reason*/,
                          RpmLevel /*level*/ ) override
         {
+            PkgCommitTimings::instance()->record( zyppRes, PkgCommitTimings::InstallEnd );
             PkgCommitSignalForwarder::instance()->sendPkgInstallEnd( zyppRes );
         }
 
@@ -347,6 +353,7 @@ struct PkgRemoveCallback:
 {
     virtual void start( ZyppRes zyppRes ) override
         {
+            PkgCommitTimings::instance()->record( zyppRes, PkgCommitTimings::RemoveStart );
             PkgCommitSignalForwarder::instance()->sendPkgRemoveStart( zyppRes );
         }
 
@@ -363,6 +370,7 @@ struct PkgRemoveCallback:
                          PkgRemoveError error,
                          const std::string & /*reason*/ ) override
         {
+            PkgCommitTimings::instance()->record( zyppRes, PkgCommitTimings::RemoveEnd );
             PkgCommitSignalForwarder::instance()->sendPkgRemoveEnd( zyppRes );
         }
 
@@ -25,6 +25,7 @@
 #include "Exception.h"
 #include "Logger.h"
 #include "MainWindow.h"
+#include "PkgCommitTimings.h"
 #include "PkgTasks.h"
 #include "PkgTaskListWidget.h"
 #include "ProgressDialog.h"
@@ -40,6 +41,18 @@
 #define VERBOSE_TRANSACT        1
 #define SORT_TO_DO_LIST         1
 
+// Update the widgets and process events from the commit callbacks no more
+// often than this (about 30 times per second)
+#define UI_UPDATE_INTERVAL_MILLISEC     33
+
+// How much the rates measured in the last commit count for the rates used to
+// predict the next one (0.0 .. 1.0); the rest is the history.
+#define RATE_SMOOTHING                  0.5
+
+// Show the ETA from the time spent so far only above this progress percent;
+// below that, use the predicted duration.
+#define MIN_ETA_PROGRESS_PERCENT        5
+
 
 PkgCommitPage * PkgCommitPage::_instance = 0;
 
@@ -51,6 +64,12 @@ PkgCommitPage::PkgCommitPage( QWidget * parent )
     , _showDetails( false )
     , _startedInstallingPkg( false )
     , _fileConflictsProgressDialog( 0 )
+    , _progressBase( 0.0 )
+    , _weightedProgressBase( 0.0 )
+    , _downloadBytesPerSec( 0.0 )
+    , _actionBytesPerSec( 0.0 )
+    , _millisecPerPkg( 0.0 )
+    , _predictedMillisec( 0 )
 {
     CHECK_PTR( _ui );
     _ui->setupUi( this ); // Actually create the widgets from the .ui form
@@ -107,7 +126,11 @@ void PkgCommitPage::commit()
     _startedInstallingPkg = false;
     _ui->totalProgressBar->show();
     _ui->totalProgressBar->setValue( 0 );
+    _ui->totalProgressBar->resetFormat();
+    _uiUpdateTimer.invalidate();
+    _commitTimer.start();
     PkgCommitSignalForwarder::instance()->reset();
+    PkgCommitTimings::instance()->start();
 
     if ( MyrlynApp::isOptionSet( OptFakeCommit ) )
         fakeCommit();
@@ -203,6 +226,9 @@ void PkgCommitPage::realCommit()
 {
     processEvents();
 
+    if ( MyrlynApp::isOptionSet( OptPrefetch ) )
+        enablePrefetch();
+
     // Create and install the callbacks.
     // They are uninstalled when the 'callbacks' variable goes out of scope.
     PkgCommitCallbacks callbacks;
@@ -221,6 +247,39 @@ void PkgCommitPage::realCommit()
         logInfo() << "libzypp aborted as requested" << endl;
     }
 
+    updateUi( true ); // Show any pending changes
+
+    PkgCommitTimings::instance()->finish();
+    PkgCommitTimings::instance()->writeReport( Logger::lastLogDir() );
+
+    if ( ! PkgCommitSignalForwarder::instance()->doAbort() )
+        updateRates();
+}
+
+
+void PkgCommitPage::enablePrefetch()
+{
+    // libzypp can fetch the packages of a transaction with several parallel
+    // connections per repo before it starts the RPM transactions (the
+    // package preloader); the number of connections is
+    // download.max_concurrent_connections in /etc/zypp/zypp.conf.
+    //
+    // That makes a big difference for many small packages where the latency
+    // of each single request and not the bandwidth is the limiting factor.
+    //
+    // It is still opt-in in libzypp, so enable it here unless the user
+    // explicitly set it in the environment.
+
+    if ( qEnvironmentVariableIsSet( "ZYPP_PCK_PRELOAD" ) )
+    {
+        logInfo() << "Using ZYPP_PCK_PRELOAD=" << qEnvironmentVariable( "ZYPP_PCK_PRELOAD" )
+                  << " from the environment" << endl;
+    }
+    else
+    {
+        logInfo() << "Enabling parallel package downloads" << endl;
+        qputenv( "ZYPP_PCK_PRELOAD", "1" );
+    }
 }
 
 
@@ -240,6 +299,14 @@ PkgCommitPage::commitPolicy() const
         logInfo() << "download only" << endl;
         policy.downloadMode( zypp::DownloadOnly );
     }
+    else if ( MyrlynApp::isOptionSet( OptPrefetch ) )
+    {
+        // Download all packages into the package cache first; the RPM
+        // transactions then only get cache hits. See also enablePrefetch().
+
+        logInfo() << "prefetch: download in advance" << endl;
+        policy.downloadMode( zypp::DownloadInAdvance );
+    }
 
     policy.allowDowngrade( true );
 
@@ -359,6 +426,10 @@ void PkgCommitPage::readSettings()
     _showDetails         = settings.value( "showDetails",  true ).toBool();
     bool showSummaryPage = settings.value( "showSummaryPage", true ).toBool();
 
+    _downloadBytesPerSec = settings.value( "downloadBytesPerSec", 0.0 ).toDouble();
+    _actionBytesPerSec   = settings.value( "actionBytesPerSec",   0.0 ).toDouble();
+    _millisecPerPkg      = settings.value( "millisecPerPkg",      0.0 ).toDouble();
+
     settings.endGroup();
 
     _ui->showSummaryPageCheckBox->setChecked( showSummaryPage );
@@ -373,6 +444,10 @@ void PkgCommitPage::writeSettings()
     settings.setValue( "showDetails",    _showDetails );
     settings.setValue( "showSummaryPage", showSummaryPage() );
 
+    settings.setValue( "downloadBytesPerSec", _downloadBytesPerSec );
+    settings.setValue( "actionBytesPerSec",   _actionBytesPerSec   );
+    settings.setValue( "millisecPerPkg",      _millisecPerPkg      );
+
     settings.endGroup();
 }
 
@@ -394,6 +469,9 @@ void PkgCommitPage::initProgressData()
     _completedInstalledSize = 0;
     _completedTasksCount    = 0;
 
+    _progressBase           = 0.0;
+    _weightedProgressBase   = 0.0;
+
     const PkgTaskList & tasks = pkgTasks()->todo();
 
     for ( const PkgTask * task: tasks )
@@ -409,6 +487,22 @@ void PkgCommitPage::initProgressData()
     logDebug() << "total installed size: " << _totalInstalledSize.asString() << endl;
     logDebug() << "total tasks: "          << _totalTasksCount << endl;
 
+    calcProgressWeights();
+
+    logDebug() << "pkgDownloadWeight:  " << _pkgDownloadWeight  << endl;
+    logDebug() << "pkgActionWeight:    " << _pkgActionWeight    << endl;
+    logDebug() << "pkgFixedCostWeight: " << _pkgFixedCostWeight << endl;
+
+    if ( _predictedMillisec > 0 )
+    {
+        logDebug() << "predicted duration: "
+                   << PkgCommitTimings::formatMillisec( _predictedMillisec ) << endl;
+    }
+}
+
+
+void PkgCommitPage::calcProgressWeights()
+{
     // Weights for different sub-tasks of downloading and installing packages:
     // There is a constant cost for doing anything with a package, no matter if
     // it's installing or removing it: The 'handling' of the package.
@@ -417,18 +511,190 @@ void PkgCommitPage::initProgressData()
     // cost of actually installing or removing it, be it unpacking an RPM (for
     // installing a package) or removing it (removing every item of its file
     // list).
+    //
+    // With the rates measured in previous commits, the weights are the
+    // predicted share of the time for each of them, so the progress bar
+    // moves with a roughly constant speed.
+
+    // Fixed weights if nothing was measured yet
 
     _pkgDownloadWeight  = 0.60;
     _pkgActionWeight    = 0.30;
     _pkgFixedCostWeight = 0.10;
 
-    logDebug() << "pkgDownloadWeight:  " << _pkgDownloadWeight  << endl;
-    logDebug() << "pkgActionWeight:    " << _pkgActionWeight    << endl;
-    logDebug() << "pkgFixedCostWeight: " << _pkgFixedCostWeight << endl;
+    if ( _totalDownloadSize <= 0 ) // Nothing (more) to download
+    {
+        _pkgDownloadWeight  = 0.0;
+        _pkgActionWeight    = 0.75;
+        _pkgFixedCostWeight = 0.25;
+    }
+
+    _predictedMillisec = 0;
+
+    // The predicted time for each part that has a measured rate; -1.0 if
+    // there is none. Each rate is used on its own: A part without a measured
+    // rate gets the share of the total time that its fixed weight would give
+    // it, with the total extrapolated from the parts that have one.
+
+    double downloadMillisec = -1.0;
+    double actionMillisec   = -1.0;
+    double fixedMillisec    = -1.0;
+    double knownMillisec    = 0.0;
+    double knownWeight      = 0.0;
+
+    if ( _downloadBytesPerSec > 0.0 )
+    {
+        downloadMillisec = 1000.0 * _totalDownloadSize / _downloadBytesPerSec;
+        knownMillisec   += downloadMillisec;
+        knownWeight     += _pkgDownloadWeight;
+    }
+
+    if ( _actionBytesPerSec > 0.0 )
+    {
+        actionMillisec   = 1000.0 * _totalInstalledSize / _actionBytesPerSec;
+        knownMillisec   += actionMillisec;
+        knownWeight     += _pkgActionWeight;
+    }
+
+    if ( _millisecPerPkg > 0.0 )
+    {
+        fixedMillisec    = _totalTasksCount * _millisecPerPkg;
+        knownMillisec   += fixedMillisec;
+        knownWeight     += _pkgFixedCostWeight;
+    }
+
+    if ( knownMillisec <= 0.0 || knownWeight <= 0.0 )
+        return; // Keep the fixed weights
+
+    double extrapolatedMillisec = knownMillisec / knownWeight;
+
+    if ( downloadMillisec < 0.0 ) downloadMillisec = _pkgDownloadWeight  * extrapolatedMillisec;
+    if ( actionMillisec   < 0.0 ) actionMillisec   = _pkgActionWeight    * extrapolatedMillisec;
+    if ( fixedMillisec    < 0.0 ) fixedMillisec    = _pkgFixedCostWeight * extrapolatedMillisec;
+
+    double totalMillisec = downloadMillisec + actionMillisec + fixedMillisec;
+
+    _pkgDownloadWeight  = downloadMillisec / totalMillisec;
+    _pkgActionWeight    = actionMillisec   / totalMillisec;
+    _pkgFixedCostWeight = fixedMillisec    / totalMillisec;
+    _predictedMillisec  = (qint64) totalMillisec;
+}
+
+
+void PkgCommitPage::updateRates()
+{
+    const PkgCommitTimings * timings = PkgCommitTimings::instance();
+
+    if ( timings->isEmpty() )
+        return;
+
+    typedef PkgCommitTimings::PhaseTimes PhaseTimes;
+
+    PhaseTimes downloads = timings->phaseTimes( PkgCommitTimings::DownloadStart, PkgCommitTimings::DownloadEnd );
+    PhaseTimes installs  = timings->phaseTimes( PkgCommitTimings::InstallStart,  PkgCommitTimings::InstallEnd  );
+    PhaseTimes removes   = timings->phaseTimes( PkgCommitTimings::RemoveStart,   PkgCommitTimings::RemoveEnd   );
+
+    qint64    actionMillisec = installs.millisec + removes.millisec;
+    ByteCount actionBytes    = installs.bytes    + removes.bytes;
+    int       pkgCount       = installs.count    + removes.count;
+
+    if ( downloads.millisec > 0 && downloads.bytes > 0 )
+        smoothRate( _downloadBytesPerSec, 1000.0 * downloads.bytes / downloads.millisec );
+
+    if ( actionMillisec > 0 && actionBytes > 0 )
+        smoothRate( _actionBytesPerSec, 1000.0 * actionBytes / actionMillisec );
+
+    if ( pkgCount > 0 )
+    {
+        // Everything that is neither downloading nor the RPM transaction of
+        // a package: Pre- and post-transaction scripts, file conflicts
+        // check, overhead.
+
+        qint64 otherMillisec = timings->totalMillisec() - downloads.millisec - actionMillisec;
+        smoothRate( _millisecPerPkg, qMax( (qint64) 0, otherMillisec ) / (double) pkgCount );
+    }
+
+    logDebug() << "download rate: " << (qint64) _downloadBytesPerSec << " bytes/s" << endl;
+    logDebug() << "action rate:   " << (qint64) _actionBytesPerSec   << " bytes/s" << endl;
+    logDebug() << "fixed cost:    " << (qint64) _millisecPerPkg      << " millisec/pkg" << endl;
+
+    writeSettings();
+}
+
+
+void PkgCommitPage::smoothRate( double & rate, double measured )
+{
+    if ( rate > 0.0 )
+        rate = RATE_SMOOTHING * measured + ( 1.0 - RATE_SMOOTHING ) * rate;
+    else
+        rate = measured;
+}
+
+
+void PkgCommitPage::updateEta()
+{
+    int    percent   = _ui->totalProgressBar->value();
+    qint64 elapsed   = _commitTimer.elapsed();
+    qint64 remaining = -1;
+
+    if ( percent >= MIN_ETA_PROGRESS_PERCENT && percent < 100 )
+    {
+        // The weights make the progress roughly proportional to the time, so
+        // this adapts to the real speed of this commit as it goes on.
+
+        remaining = elapsed * ( 100 - percent ) / percent;
+    }
+    else if ( percent < MIN_ETA_PROGRESS_PERCENT && _predictedMillisec > 0 )
+    {
+        remaining = qMax( (qint64) 0, _predictedMillisec - elapsed );
+    }
+
+    if ( remaining > 0 )
+    {
+        // Translators: %p% is the progress percent; %1 is a duration
+        _ui->totalProgressBar->setFormat( _( "%p% (about %1 left)" )
+                                          .arg( PkgCommitTimings::formatMillisec( remaining ) ) );
+    }
+    else
+    {
+        _ui->totalProgressBar->resetFormat();
+    }
 }
 
 
 int PkgCommitPage::currentProgressPercent()
+{
+    return qBound( 0, (int) ( progressPercent() + 0.5 ), 100 );
+}
+
+
+float PkgCommitPage::progressPercent()
+{
+    float progress = weightedProgressPercent();
+
+    if ( _weightedProgressBase < 100.0 )
+    {
+        // Scale the progress since the weights were last recalculated to
+        // the part that was left at that time
+
+        progress = _progressBase + ( 100.0 - _progressBase )
+            * ( progress - _weightedProgressBase ) / ( 100.0 - _weightedProgressBase );
+    }
+
+    return qMax( progress, _progressBase );
+}
+
+
+void PkgCommitPage::reweightRemainingProgress( float progress )
+{
+    calcProgressWeights();
+
+    _progressBase         = progress;
+    _weightedProgressBase = weightedProgressPercent();
+}
+
+
+float PkgCommitPage::weightedProgressPercent()
 {
     float downloadPercent  = 0.0;
     float installedPercent = 0.0;
@@ -512,7 +778,29 @@ int PkgCommitPage::currentProgressPercent()
     logVerbose() << "Progress: " << progress << "%" << endl;
 #endif
 
-    return qBound( 0, (int) ( progress + 0.5 ), 100 );
+    return progress;
+}
+
+
+void PkgCommitPage::updateUi( bool force )
+{
+    if ( ! force &&
+         _uiUpdateTimer.isValid() &&
+         _uiUpdateTimer.elapsed() < UI_UPDATE_INTERVAL_MILLISEC )
+    {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    updateListHeaders();
+    updateTotalProgressBar();
+    updateEta();
+    processEvents();
+
+    PkgCommitTimings::instance()->addGuiTime( timer.elapsed() );
+    _uiUpdateTimer.start();
 }
 
 
@@ -597,12 +885,10 @@ void PkgCommitPage::pkgDownloadStart( ZyppRes zyppRes )
 
     // Move the task from the todo list widget to the downloads list widget
 
-    _ui->todoList->removeTaskItem( task );
-    PkgTaskListWidgetItem * item = _ui->downloadsList->addTaskItem( task );
+    PkgTaskListWidgetItem * item = _ui->todoList->moveTaskItem( task, _ui->downloadsList );
     item->setIcon( _downloadOngoingIcon );
-    updateListHeaders();
 
-    processEvents(); // Update the UI
+    updateUi();
 }
 
 
@@ -632,11 +918,7 @@ void PkgCommitPage::pkgDownloadProgress( ZyppRes zyppRes, int percent )
     if ( percent != task->downloadedPercent() ) // only if there really was a change
     {
         task->setDownloadedPercent( percent );
-
-        // Update the UI
-
-        if ( updateTotalProgressBar() ) // This is somewhat expensive
-            processEvents();
+        updateUi();
     }
 }
 
@@ -660,10 +942,9 @@ void PkgCommitPage::pkgDownloadEnd( ZyppRes zyppRes )
     PkgTaskListWidgetItem * item = _ui->downloadsList->findTaskItem( task );
 
     if ( item )
-    {
         item->setIcon( _downloadDoneIcon );
-        processEvents();
-    }
+
+    updateUi();
 
     // Important: Not adding the download size to _completedDownloadSize just
     // yet, or it would be counted twice while the task is still in the doing
@@ -686,19 +967,31 @@ void PkgCommitPage::pkgCachedNotify( ZyppRes zyppRes )
     logVerbose() << task << endl;
 #endif
 
+    float progress = progressPercent();
+
     // Move the task from the todo list to the downloads list
 
     PkgTasks::moveTask( task, pkgTasks()->todo(), pkgTasks()->downloads() );
     task->setDownloadedPercent( 100 );
 
+    // Nothing to download for this one after all: Take it out of the
+    // download progress and recalculate the weights for the remaining work,
+    // so the progress bar doesn't jump ahead for cached packages and then
+    // crawl, and it doesn't jump back either.
+
+    if ( task->downloadSize() > 0 )
+    {
+        _totalDownloadSize -= task->downloadSize();
+        task->setDownloadSize( 0.0 );
+        reweightRemainingProgress( progress );
+    }
+
     // Move the task from the todo list widget to the downloads list widget
 
-    _ui->todoList->removeTaskItem( task );
-    PkgTaskListWidgetItem * item = _ui->downloadsList->addTaskItem( task );
+    PkgTaskListWidgetItem * item = _ui->todoList->moveTaskItem( task, _ui->downloadsList );
     item->setIcon( _downloadDoneIcon );
-    updateListHeaders();
 
-    processEvents(); // Update the UI
+    updateUi();
 
 
     // Important: Not adding the download size to _completedDownloadSize just
@@ -819,9 +1112,7 @@ void PkgCommitPage::pkgActionStart( ZyppRes       zyppRes,
 
             // Move the task from the downloads list widget to the doing list widget
 
-            _ui->downloadsList->removeTaskItem( task );
-            _ui->doingList->addTaskItem( task );
-            updateListHeaders();
+            _ui->downloadsList->moveTaskItem( task, _ui->doingList );
 
             // Update the bookkeeping sums.
             // We already know that the task was in the downloads list.
@@ -848,9 +1139,7 @@ void PkgCommitPage::pkgActionStart( ZyppRes       zyppRes,
 
         // Move the task from the todo list widget to the doing list widget
 
-        _ui->todoList->removeTaskItem( task );
-        _ui->doingList->addTaskItem( task );
-        updateListHeaders();
+        _ui->todoList->moveTaskItem( task, _ui->doingList );
     }
 
 #if VERBOSE_TRANSACT
@@ -859,7 +1148,7 @@ void PkgCommitPage::pkgActionStart( ZyppRes       zyppRes,
 
     task->setDownloadedPercent( 100 ); // The download is complete for sure
     task->setCompletedPercent( 0 );    // But the task itself isn't completed
-    processEvents(); // Update the UI
+    updateUi();
 
     // No
     //
@@ -911,11 +1200,7 @@ void PkgCommitPage::pkgActionProgress( ZyppRes       zyppRes,
     if ( percent != task->completedPercent() )
     {
         task->setCompletedPercent( percent );
-
-        // Update the UI
-
-        if ( updateTotalProgressBar() ) // This is somewhat expensive
-            processEvents();
+        updateUi();
     }
 }
 
@@ -953,9 +1238,7 @@ void PkgCommitPage::pkgActionEnd( ZyppRes       zyppRes,
 
     // Move the task from the doing list widget to the done list widget
 
-    _ui->doingList->removeTaskItem( task );
-    _ui->doneList->addTaskItem( task );
-    updateListHeaders();
+    _ui->doingList->moveTaskItem( task, _ui->doneList );
 
 
     // Update the internal bookkeeping sums
@@ -971,9 +1254,12 @@ void PkgCommitPage::pkgActionEnd( ZyppRes       zyppRes,
 
     // Was this the last task?
 
-    if ( pkgTasks()->todo().isEmpty()      &&
-         pkgTasks()->downloads().isEmpty() &&
-         pkgTasks()->doing().isEmpty() )
+    bool lastTask =
+        pkgTasks()->todo().isEmpty()      &&
+        pkgTasks()->downloads().isEmpty() &&
+        pkgTasks()->doing().isEmpty();
+
+    if ( lastTask )
     {
         QString msg = _( "[Post-transaction scripts]" );
         _ui->doingList->addItem( new QListWidgetItem( msg ) );
@@ -981,10 +1267,10 @@ void PkgCommitPage::pkgActionEnd( ZyppRes       zyppRes,
     }
 
 
-    // Update the UI
+    // Update the UI. After the last task, libzypp will be busy with the
+    // post-transaction scripts for a while, so do that right now.
 
-    updateTotalProgressBar(); // This may or may not be needed
-    processEvents();          // But this is needed for sure
+    updateUi( lastTask );
 }
 
 
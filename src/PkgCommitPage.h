@@ -18,6 +18,7 @@
 #define PkgCommitPage_h
 
 
+#include <QElapsedTimer>
 #include <QStringList>
 #include <QWidget>
 
@@ -211,7 +212,8 @@ protected:
      * The real package commit: Tell libzypp to start downloading and
      * installing / updating / removing packages.
      *
-     * See also the '--dry-run' and '--download-only' command line options.
+     * See also the '--dry-run', '--download-only' and '--prefetch' command
+     * line options.
      **/
     void realCommit();
 
@@ -224,6 +226,12 @@ protected:
      **/
     void fakeCommit();
 
+    /**
+     * Enable downloading all packages with parallel connections before the
+     * RPM transactions for the '--prefetch' command line option.
+     **/
+    void enablePrefetch();
+
     /**
      * Return a commit policy based on the app's options.
      **/
@@ -295,6 +303,32 @@ protected:
      **/
     void initProgressData();
 
+    /**
+     * Calculate the weights for the download, the package action (install /
+     * update / remove) and the fixed cost per package for the total progress
+     * from the rates measured in previous commits and the sizes of the
+     * current transaction. Each measured rate is used even if the others are
+     * unknown. Use fixed weights if nothing was measured yet.
+     **/
+    void calcProgressWeights();
+
+    /**
+     * Update the measured rates with the timings of the commit that just
+     * finished and save them in the settings.
+     **/
+    void updateRates();
+
+    /**
+     * Update 'rate' with a newly 'measured' value, taking the previous value
+     * into account to smooth out outliers.
+     **/
+    static void smoothRate( double & rate, double measured );
+
+    /**
+     * Show the estimated remaining time in the total progress bar.
+     **/
+    void updateEta();
+
     /**
      * Calculate the current progress percent based on the weighted progress
      * percent of number of completed tasks, completed download size, completed
@@ -302,6 +336,41 @@ protected:
      **/
     int currentProgressPercent();
 
+    /**
+     * Return the current progress percent without rounding. If the weights
+     * were recalculated during the commit, the progress up to that point is
+     * kept, and only the remaining work is scaled with the new weights (see
+     * reweightRemainingProgress()).
+     **/
+    float progressPercent();
+
+    /**
+     * Return the progress percent with the current weights, not taking any
+     * earlier weights into account.
+     **/
+    float weightedProgressPercent();
+
+    /**
+     * Recalculate the weights during the commit without changing the
+     * progress that was already made: 'progress' (from progressPercent()
+     * before the totals changed) is kept as the base, and only the remaining
+     * work is weighted with the new weights. So the progress bar never jumps
+     * backwards or forwards because of that.
+     **/
+    void reweightRemainingProgress( float progress );
+
+    /**
+     * Update the list headers and the total progress bar and process the
+     * pending Qt events, but only if the last update was long enough ago
+     * (unless 'force' is 'true').
+     *
+     * The commit callbacks only update the task lists and list widgets and
+     * then call this, so a burst of callbacks (e.g. download progress for
+     * many small packages) does not result in a repaint for each one; the
+     * latest state of each task is shown with the next update.
+     **/
+    void updateUi( bool force = false );
+
     /**
      * Calculate the total progress and update the total progress bar if the
      * (integer) percent value is different from the old one.
@@ -373,6 +442,19 @@ protected:
     float               _pkgDownloadWeight;  // 0.0 .. 1.0
     float               _pkgActionWeight;    // 0.0 .. 1.0
 
+    float               _progressBase;         // see progressPercent()
+    float               _weightedProgressBase;
+
+    // Measured in previous commits; 0.0 if unknown
+
+    double              _downloadBytesPerSec;
+    double              _actionBytesPerSec;
+    double              _millisecPerPkg;
+    qint64              _predictedMillisec;
+    QElapsedTimer       _commitTimer;
+
+    QElapsedTimer       _uiUpdateTimer;
+
     QPixmap             _downloadOngoingIcon;
     QPixmap             _downloadDoneIcon;
 
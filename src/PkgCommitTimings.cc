@@ -0,0 +1,287 @@
+/*  ---------------------------------------------------------
+               __  __            _
+              |  \/  |_   _ _ __| |_   _ _ __
+              | |\/| | | | | '__| | | | | '_ \
+              | |  | | |_| | |  | | |_| | | | |
+              |_|  |_|\__, |_|  |_|\__, |_| |_|
+                      |___/        |___/
+    ---------------------------------------------------------
+
+    Project:  Myrlyn Package Manager GUI
+    Copyright (c) Stefan Hundhammer <Stefan.Hundhammer@gmx.de>
+    License:  GPL V2 - See file LICENSE for details.
+
+ */
+
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+
+#include "Exception.h"
+#include "Logger.h"
+#include "YQi18n.h"
+#include "utf8.h"
+#include "PkgCommitTimings.h"
+
+
+#define REPORT_FILE_NAME        "commit-timings.json"
+
+
+PkgCommitTimings * PkgCommitTimings::_instance = 0;
+
+
+PkgCommitTimings::PkgCommitTimings()
+    : _totalMillisec( 0 )
+    , _guiMillisec( 0 )
+{
+
+}
+
+
+PkgCommitTimings::~PkgCommitTimings()
+{
+    _instance = 0;
+}
+
+
+PkgCommitTimings *
+PkgCommitTimings::instance()
+{
+    if ( ! _instance )
+    {
+        _instance = new PkgCommitTimings();
+        CHECK_NEW( _instance );
+    }
+
+    return _instance;
+}
+
+
+void PkgCommitTimings::start()
+{
+    _pkgs.clear();
+    _pkgIndex.clear();
+    _totalMillisec = 0;
+    _guiMillisec   = 0;
+    _startTime     = QDateTime::currentDateTime();
+    _clock.start();
+}
+
+
+void PkgCommitTimings::finish()
+{
+    if ( ! _clock.isValid() )
+        return;
+
+    _totalMillisec = _clock.elapsed();
+    _clock.invalidate();
+}
+
+
+void PkgCommitTimings::record( ZyppRes zyppRes, Event event )
+{
+    if ( ! _clock.isValid() || ! zyppRes )
+        return;
+
+    int id    = zyppRes->satSolvable().id();
+    int index = _pkgIndex.value( id, -1 );
+
+    if ( index < 0 )
+    {
+        PkgTimes pkgTimes;
+
+        pkgTimes.name         = fromUTF8( zyppRes->name() );
+        pkgTimes.version      = fromUTF8( zyppRes->edition().asString() );
+        pkgTimes.arch         = fromUTF8( zyppRes->arch().asString() );
+        pkgTimes.downloadSize = zyppRes->downloadSize();
+        pkgTimes.installSize  = zyppRes->installSize();
+
+        for ( int i = 0; i < EventCount; ++i )
+            pkgTimes.time[ i ] = -1;
+
+        index = _pkgs.size();
+        _pkgs << pkgTimes;
+        _pkgIndex.insert( id, index );
+    }
+
+    _pkgs[ index ].time[ event ] = _clock.elapsed();
+}
+
+
+void PkgCommitTimings::addGuiTime( qint64 millisec )
+{
+    if ( _clock.isValid() )
+        _guiMillisec += millisec;
+}
+
+
+PkgCommitTimings::PhaseTimes
+PkgCommitTimings::phaseTimes( Event startEvent, Event endEvent ) const
+{
+    PhaseTimes phase;
+
+    for ( const PkgTimes & pkg: _pkgs )
+    {
+        if ( pkg.time[ startEvent ] >= 0 && pkg.time[ endEvent ] >= pkg.time[ startEvent ] )
+        {
+            ++phase.count;
+            phase.millisec += pkg.time[ endEvent ] - pkg.time[ startEvent ];
+
+            if ( startEvent == DownloadStart )
+                phase.bytes += pkg.downloadSize;
+            else
+                phase.bytes += pkg.installSize;
+        }
+    }
+
+    return phase;
+}
+
+
+QString PkgCommitTimings::eventName( Event event )
+{
+    switch ( event )
+    {
+        case DownloadStart: return "downloadStart";
+        case DownloadEnd:   return "downloadEnd";
+        case CacheHit:      return "cacheHit";
+        case InstallStart:  return "installStart";
+        case InstallEnd:    return "installEnd";
+        case RemoveStart:   return "removeStart";
+        case RemoveEnd:     return "removeEnd";
+        case EventCount:    break;
+    }
+
+    return QString( "event%1" ).arg( (int) event );
+}
+
+
+bool PkgCommitTimings::writeReport( const QString & dir ) const
+{
+    QJsonArray pkgArray;
+
+    for ( const PkgTimes & pkg: _pkgs )
+    {
+        QJsonObject pkgObj;
+
+        pkgObj[ "name"         ] = pkg.name;
+        pkgObj[ "version"      ] = pkg.version;
+        pkgObj[ "arch"         ] = pkg.arch;
+        pkgObj[ "downloadSize" ] = (qint64) pkg.downloadSize;
+        pkgObj[ "installSize"  ] = (qint64) pkg.installSize;
+
+        for ( int i = 0; i < EventCount; ++i )
+        {
+            if ( pkg.time[ i ] >= 0 )
+                pkgObj[ eventName( (Event) i ) ] = pkg.time[ i ];
+        }
+
+        pkgArray.append( pkgObj );
+    }
+
+    PhaseTimes downloads = phaseTimes( DownloadStart, DownloadEnd  );
+    PhaseTimes installs  = phaseTimes( InstallStart,  InstallEnd   );
+    PhaseTimes removes   = phaseTimes( RemoveStart,   RemoveEnd    );
+    int        cacheHits = 0;
+
+    for ( const PkgTimes & pkg: _pkgs )
+    {
+        if ( pkg.time[ CacheHit ] >= 0 )
+            ++cacheHits;
+    }
+
+    QJsonObject phases;
+
+    phases[ "download" ] = QJsonObject( { { "count",    downloads.count    },
+                                          { "millisec", downloads.millisec },
+                                          { "bytes",    (qint64) downloads.bytes } } );
+    phases[ "cacheHit" ] = QJsonObject( { { "count",    cacheHits          } } );
+    phases[ "install"  ] = QJsonObject( { { "count",    installs.count     },
+                                          { "millisec", installs.millisec  },
+                                          { "bytes",    (qint64) installs.bytes } } );
+    phases[ "remove"   ] = QJsonObject( { { "count",    removes.count      },
+                                          { "millisec", removes.millisec   },
+                                          { "bytes",    (qint64) removes.bytes } } );
+
+    QJsonObject report;
+
+    report[ "startTime"     ] = _startTime.toString( Qt::ISODate );
+    report[ "totalMillisec" ] = _totalMillisec;
+    report[ "guiMillisec"   ] = _guiMillisec;
+    report[ "phases"        ] = phases;
+    report[ "packages"      ] = pkgArray;
+
+    QString filename = dir + "/" + REPORT_FILE_NAME;
+    QFile   file( filename );
+
+    if ( ! file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ||
+         file.write( QJsonDocument( report ).toJson() ) < 0 )
+    {
+        logError() << "Can't write commit timings to " << filename << endl;
+        return false;
+    }
+
+    logInfo() << "Wrote commit timings to " << filename << endl;
+
+    return true;
+}
+
+
+QString PkgCommitTimings::formatMillisec( qint64 millisec )
+{
+    qint64 sec = ( millisec + 500 ) / 1000;
+
+    if ( sec < 60 )
+        // Translators: Duration in seconds
+        return _( "%1 s" ).arg( sec );
+    else
+        // Translators: Duration in minutes and seconds
+        return _( "%1:%2 min" ).arg( sec / 60 ).arg( sec % 60, 2, 10, QChar( '0' ) );
+}
+
+
+QString PkgCommitTimings::summary() const
+{
+    PhaseTimes  downloads = phaseTimes( DownloadStart, DownloadEnd );
+    PhaseTimes  installs  = phaseTimes( InstallStart,  InstallEnd  );
+    PhaseTimes  removes   = phaseTimes( RemoveStart,   RemoveEnd   );
+    QStringList lines;
+
+    lines << _( "Total time: %1" ).arg( formatMillisec( _totalMillisec ) );
+
+    if ( downloads.count > 0 )
+    {
+        QString line = _( "Downloading %1 packages: %2" )
+            .arg( downloads.count )
+            .arg( formatMillisec( downloads.millisec ) );
+
+        if ( downloads.millisec > 0 )
+        {
+            ByteCount perSec( (ByteCount::SizeType) ( downloads.bytes * 1000.0 / downloads.millisec ) );
+            line += QString( " (%1/s)" ).arg( fromUTF8( perSec.asString() ) );
+        }
+
+        lines << line;
+    }
+
+    if ( installs.count > 0 )
+    {
+        lines << _( "Installing %1 packages: %2" )
+            .arg( installs.count )
+            .arg( formatMillisec( installs.millisec ) );
+    }
+
+    if ( removes.count > 0 )
+    {
+        lines << _( "Removing %1 packages: %2" )
+            .arg( removes.count )
+            .arg( formatMillisec( removes.millisec ) );
+    }
+
+    lines << _( "Updating the display: %1" ).arg( formatMillisec( _guiMillisec ) );
+
+    return lines.join( "\n" );
+}
@@ -0,0 +1,190 @@
+/*  ---------------------------------------------------------
+               __  __            _
+              |  \/  |_   _ _ __| |_   _ _ __
+              | |\/| | | | | '__| | | | | '_ \
+              | |  | | |_| | |  | | |_| | | | |
+              |_|  |_|\__, |_|  |_|\__, |_| |_|
+                      |___/        |___/
+    ---------------------------------------------------------
+
+    Project:  Myrlyn Package Manager GUI
+    Copyright (c) Stefan Hundhammer <Stefan.Hundhammer@gmx.de>
+    License:  GPL V2 - See file LICENSE for details.
+
+ */
+
+
+#ifndef PkgCommitTimings_h
+#define PkgCommitTimings_h
+
+
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <zypp-core/ByteCount.h>
+
+#include "YQZypp.h"     // ZyppRes
+
+
+using zypp::ByteCount;
+
+
+/**
+ * Singleton class that collects timestamps for each package during the
+ * package commit: When its download started and ended, when it was found in
+ * the local cache, when installing or removing it started and ended.
+ *
+ * The commit callbacks record those events as they arrive from libzypp; the
+ * commit page adds the time it spent updating the UI. After the commit, this
+ * writes a machine-readable report (JSON) to the log directory and provides a
+ * short summary for the summary page, so it is possible to see where the time
+ * actually went: Downloads, RPM transactions (including scriptlets), or the
+ * GUI itself.
+ **/
+class PkgCommitTimings
+{
+protected:
+
+    /**
+     * Constructor. Use the static instance() method instead.
+     **/
+    PkgCommitTimings();
+
+public:
+
+    /**
+     * Events of a package during the commit.
+     **/
+    enum Event
+    {
+        DownloadStart = 0,
+        DownloadEnd,
+        CacheHit,
+        InstallStart,
+        InstallEnd,
+        RemoveStart,
+        RemoveEnd,
+
+        EventCount      // Keep this last
+    };
+
+    /**
+     * Destructor.
+     **/
+    virtual ~PkgCommitTimings();
+
+    /**
+     * Return the instance of the singleton of this class.
+     * Create it if it doesn't exist yet.
+     **/
+    static PkgCommitTimings * instance();
+
+    /**
+     * Clear all previous data and start the clock for a new commit.
+     **/
+    void start();
+
+    /**
+     * Stop the clock at the end of the commit.
+     **/
+    void finish();
+
+    /**
+     * Return 'true' if there are no package timings, e.g. because there was
+     * no real commit.
+     **/
+    bool isEmpty() const { return _pkgs.isEmpty(); }
+
+    /**
+     * Record 'event' for 'zyppRes' with the current time.
+     * Do nothing if the clock is not running.
+     **/
+    void record( ZyppRes zyppRes, Event event );
+
+    /**
+     * Add 'millisec' to the time spent for updating the UI.
+     **/
+    void addGuiTime( qint64 millisec );
+
+    /**
+     * Write the report to 'dir' as "commit-timings.json".
+     * Return 'true' on success, 'false' on error.
+     **/
+    bool writeReport( const QString & dir ) const;
+
+    /**
+     * Return a short human-readable (translated) summary.
+     **/
+    QString summary() const;
+
+    /**
+     * Return the name of an event for the report.
+     **/
+    static QString eventName( Event event );
+
+    /**
+     * Aggregated timings of one phase of the commit. 'bytes' is the download
+     * size for downloads, the installed size for installing or removing.
+     **/
+    struct PhaseTimes
+    {
+        PhaseTimes(): count( 0 ), millisec( 0 ), bytes( 0 ) {}
+
+        int       count;
+        qint64    millisec;
+        ByteCount bytes;
+    };
+
+    /**
+     * Add up the times between 'startEvent' and 'endEvent' of all packages.
+     **/
+    PhaseTimes phaseTimes( Event startEvent, Event endEvent ) const;
+
+    /**
+     * Return the total duration of the last commit in millisec.
+     **/
+    qint64 totalMillisec() const { return _totalMillisec; }
+
+    /**
+     * Format a duration for the user.
+     **/
+    static QString formatMillisec( qint64 millisec );
+
+
+protected:
+
+    /**
+     * Timestamps of one package in millisec since the start of the commit;
+     * -1 for events that didn't happen.
+     **/
+    struct PkgTimes
+    {
+        QString   name;
+        QString   version;
+        QString   arch;
+        ByteCount downloadSize;
+        ByteCount installSize;
+        qint64    time[ EventCount ];
+    };
+
+
+    //
+    // Data members
+    //
+
+    static PkgCommitTimings * _instance;
+
+    QElapsedTimer       _clock;
+    QDateTime           _startTime;
+    qint64              _totalMillisec;
+    qint64              _guiMillisec;
+
+    QList<PkgTimes>     _pkgs;
+    QHash<int, int>     _pkgIndex;      // solvable ID -> index in _pkgs
+};
+
+
+#endif // PkgCommitTimings_h
@@ -0,0 +1,508 @@
+/*  ---------------------------------------------------------
+               __  __            _
+              |  \/  |_   _ _ __| |_   _ _ __
+              | |\/| | | | | '__| | | | | '_ \
+              | |  | | |_| | |  | | |_| | | | |
+              |_|  |_|\__, |_|  |_|\__, |_| |_|
+                      |___/        |___/
+    ---------------------------------------------------------
+
+    Project:  Myrlyn Package Manager GUI
+    Copyright (c) Stefan Hundhammer <Stefan.Hundhammer@gmx.de>
+    License:  GPL V2 - See file LICENSE for details.
+
+ */
+
+
+#include <algorithm>
+
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
+
+#include <zypp/ZConfig.h>
+#include <zypp/sat/SolvAttr.h>
+
+#include "Exception.h"
+#include "Logger.h"
+#include "SearchFilter.h"
+#include "utf8.h"
+#include "PkgSearchIndex.h"
+
+
+#define INDEX_FILE_NAME         "pkg-search-index"
+#define INDEX_MAGIC             0x4d795349      // "MySI"
+#define INDEX_FORMAT_VERSION    2
+
+#define BUILD_SLICE_MILLISEC    30
+
+
+PkgSearchIndex * PkgSearchIndex::_instance = 0;
+
+
+PkgSearchIndex::PkgSearchIndex()
+    : QObject()
+    , _valid( false )
+    , _building( false )
+    , _nextPkgNo( 0 )
+{
+    _sliceTimer = new QTimer( this );
+    CHECK_NEW( _sliceTimer );
+    _sliceTimer->setInterval( 0 );     // Whenever the event loop is idle
+
+    connect( _sliceTimer, SIGNAL( timeout()           ),
+             this,        SLOT  ( processBuildSlice() ) );
+}
+
+
+PkgSearchIndex::~PkgSearchIndex()
+{
+    _instance = 0;
+}
+
+
+PkgSearchIndex *
+PkgSearchIndex::instance()
+{
+    if ( ! _instance )
+    {
+        _instance = new PkgSearchIndex();
+        CHECK_NEW( _instance );
+    }
+
+    return _instance;
+}
+
+
+void PkgSearchIndex::clear()
+{
+    _sliceTimer->stop();
+    _valid     = false;
+    _building  = false;
+    _nextPkgNo = 0;
+    _pkgs.clear();
+    _postings.clear();
+    _lastPkgNo.clear();
+}
+
+
+void PkgSearchIndex::setCacheKey( const QString & cacheKey )
+{
+    clear();
+    _cacheKey = cacheKey;
+
+    if ( ! _cacheKey.isEmpty() )
+    {
+        _buildTime.start();
+        _sliceTimer->start();
+    }
+}
+
+
+void PkgSearchIndex::processBuildSlice()
+{
+    if ( ! _building )
+    {
+        if ( load( _cacheKey ) )
+        {
+            logInfo() << "Loaded the package search index for " << _pkgs.size() << " packages"
+                      << " in " << _buildTime.elapsed() << " millisec" << endl;
+
+            _sliceTimer->stop();
+            _valid = true;
+            return;
+        }
+
+        startBuild();
+        return;
+    }
+
+    QElapsedTimer sliceTimer;
+    sliceTimer.start();
+
+    while ( _nextPkgNo < (quint32) _pkgs.size() &&
+            ! sliceTimer.hasExpired( BUILD_SLICE_MILLISEC ) )
+    {
+        indexPkg( _nextPkgNo++ );
+    }
+
+    if ( _nextPkgNo < (quint32) _pkgs.size() )
+        return;
+
+    _sliceTimer->stop();
+    _building = false;
+    _lastPkgNo.clear();
+
+    logInfo() << "Built the package search index for " << _pkgs.size() << " packages"
+              << " after " << _buildTime.elapsed() << " millisec" << endl;
+
+    save( _cacheKey );
+    _valid = true;
+}
+
+
+void PkgSearchIndex::startBuild()
+{
+    // A snapshot: The pool might change while this is being built
+
+    for ( ZyppPoolIterator it = zyppPkgBegin(); it != zyppPkgEnd(); ++it )
+        _pkgs << *it;
+
+    _nextPkgNo = 0;
+    _building  = true;
+
+    logDebug() << "Building the package search index for " << _pkgs.size() << " packages" << endl;
+}
+
+
+void PkgSearchIndex::indexPkg( quint32 pkgNo )
+{
+    ZyppSel          selectable = _pkgs.at( pkgNo );
+    QVector<quint32> trigrams;
+
+    for ( zypp::ui::Selectable::installed_iterator inst_it = selectable->installedBegin();
+          inst_it != selectable->installedEnd();
+          ++inst_it )
+    {
+        addTrigrams( inst_it->resolvable(), trigrams );
+    }
+
+    for ( zypp::ui::Selectable::available_iterator avail_it = selectable->availableBegin();
+          avail_it != selectable->availableEnd();
+          ++avail_it )
+    {
+        addTrigrams( avail_it->resolvable(), trigrams );
+    }
+
+    // Most versions of a package have the same texts
+
+    std::sort( trigrams.begin(), trigrams.end() );
+    trigrams.erase( std::unique( trigrams.begin(), trigrams.end() ), trigrams.end() );
+
+    for ( quint32 trigram: trigrams )
+    {
+        // Package numbers are ascending, so only store the difference
+        appendVarInt( _postings[ trigram ], pkgNo - _lastPkgNo.value( trigram, 0 ) );
+        _lastPkgNo[ trigram ] = pkgNo;
+    }
+}
+
+
+void PkgSearchIndex::addTrigrams( ZyppObj zyppObj, QVector<quint32> & trigrams )
+{
+    if ( ! zyppObj )
+        return;
+
+    addTrigrams( fromUTF8( name       ( zyppObj ) ).toLower().toUtf8(), trigrams );
+    addTrigrams( fromUTF8( summary    ( zyppObj ) ).toLower().toUtf8(), trigrams );
+    addTrigrams( fromUTF8( description( zyppObj ) ).toLower().toUtf8(), trigrams );
+}
+
+
+std::string PkgSearchIndex::name( ZyppObj zyppObj )
+{
+    return zyppObj->name();
+}
+
+
+std::string PkgSearchIndex::summary( ZyppObj zyppObj )
+{
+    // Not zyppObj->summary(): That is translated to the text locale.
+
+    return zyppObj->satSolvable().lookupStrAttribute( zypp::sat::SolvAttr::summary );
+}
+
+
+std::string PkgSearchIndex::description( ZyppObj zyppObj )
+{
+    return zyppObj->satSolvable().lookupStrAttribute( zypp::sat::SolvAttr::description );
+}
+
+
+void PkgSearchIndex::addTrigrams( const QByteArray & utf8, QVector<quint32> & trigrams )
+{
+    const unsigned char * bytes = (const unsigned char *) utf8.constData();
+
+    for ( int i = 0; i + 2 < utf8.size(); ++i )
+        trigrams << ( bytes[ i ] << 16 | bytes[ i+1 ] << 8 | bytes[ i+2 ] );
+}
+
+
+void PkgSearchIndex::appendVarInt( QByteArray & postings, quint32 value )
+{
+    while ( value >= 0x80 )
+    {
+        postings.append( (char) ( ( value & 0x7f ) | 0x80 ) );
+        value >>= 7;
+    }
+
+    postings.append( (char) value );
+}
+
+
+PkgSearchIndex::PostingList
+PkgSearchIndex::decodePostings( const QByteArray & postings )
+{
+    PostingList pkgNumbers;
+    quint32     pkgNo = 0;
+    quint32     value = 0;
+    int         shift = 0;
+
+    pkgNumbers.reserve( postings.size() );
+
+    for ( char c: postings )
+    {
+        value |= ( (quint32) c & 0x7f ) << shift;
+
+        if ( c & 0x80 )
+        {
+            shift += 7;
+        }
+        else
+        {
+            pkgNo += value;
+            pkgNumbers << pkgNo;
+            value = 0;
+            shift = 0;
+        }
+    }
+
+    return pkgNumbers;
+}
+
+
+QList<QByteArray>
+PkgSearchIndex::fixedParts( const SearchFilter & searchFilter )
+{
+    QList<QByteArray> parts;
+    QString pattern = searchFilter.pattern().toLower();
+
+    switch ( searchFilter.filterMode() )
+    {
+        case SearchFilter::Contains:
+            parts << pattern.toUtf8();
+            break;
+
+        case SearchFilter::StartsWith:
+            // zypp matches this as a regexp "^pattern", so any regexp special
+            // character would make this something else than a fixed string
+
+            if ( ! pattern.contains( QRegularExpression( "[\\\\.\\[\\]()*+?{}|^$]" ) ) )
+                parts << pattern.toUtf8();
+            break;
+
+        case SearchFilter::Wildcard:
+            if ( pattern.contains( '[' ) || pattern.contains( '\\' ) )
+                break;
+
+            for ( const QString & part: pattern.split( QRegularExpression( "[*?]" ),
+                                                       Qt::SkipEmptyParts ) )
+            {
+                parts << part.toUtf8();
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return parts;
+}
+
+
+bool PkgSearchIndex::canNarrow( const SearchFilter & searchFilter ) const
+{
+    for ( const QByteArray & part: fixedParts( searchFilter ) )
+    {
+        if ( part.size() >= 3 )
+            return true;
+    }
+
+    return false;
+}
+
+
+QList<ZyppSel>
+PkgSearchIndex::candidates( const SearchFilter & searchFilter ) const
+{
+    QList<ZyppSel>   result;
+    QVector<quint32> trigrams;
+
+    for ( const QByteArray & part: fixedParts( searchFilter ) )
+        addTrigrams( part, trigrams );
+
+    if ( trigrams.isEmpty() )
+    {
+        // Nothing to narrow down: Every package is a candidate
+
+        for ( const ZyppSel & selectable: _pkgs )
+            result << selectable;
+
+        return result;
+    }
+
+    std::sort( trigrams.begin(), trigrams.end() );
+    trigrams.erase( std::unique( trigrams.begin(), trigrams.end() ), trigrams.end() );
+
+    // Start with the shortest posting list to keep the intersections small
+
+    std::sort( trigrams.begin(), trigrams.end(),
+               [this]( quint32 a, quint32 b )
+               {
+                   return _postings.value( a ).size() < _postings.value( b ).size();
+               } );
+
+    PostingList pkgNumbers = decodePostings( _postings.value( trigrams.first() ) );
+
+    for ( int i = 1; i < trigrams.size() && ! pkgNumbers.isEmpty(); ++i )
+    {
+        PostingList other = decodePostings( _postings.value( trigrams.at( i ) ) );
+        PostingList intersection;
+
+        std::set_intersection( pkgNumbers.cbegin(), pkgNumbers.cend(),
+                               other.cbegin(),      other.cend(),
+                               std::back_inserter( intersection ) );
+        pkgNumbers.swap( intersection );
+    }
+
+    for ( quint32 pkgNo: pkgNumbers )
+        result << _pkgs.at( pkgNo );
+
+    return result;
+}
+
+
+QStringList PkgSearchIndex::cacheDirs()
+{
+    QStringList dirs;
+
+    // Next to the zypp repo cache (typically /var/cache/zypp); this is only
+    // writable for root.
+    dirs << fromUTF8( zypp::ZConfig::instance().repoCachePath().asString() ) + "/myrlyn";
+
+    // The user's own cache directory (typically ~/.cache)
+    QString userCacheDir = QStandardPaths::writableLocation( QStandardPaths::GenericCacheLocation );
+
+    if ( ! userCacheDir.isEmpty() )
+        dirs << userCacheDir + "/myrlyn";
+
+    return dirs;
+}
+
+
+bool PkgSearchIndex::load( const QString & cacheKey )
+{
+    for ( const QString & dir: cacheDirs() )
+    {
+        QFile file( dir + "/" + INDEX_FILE_NAME );
+
+        if ( ! file.open( QIODevice::ReadOnly ) )
+            continue;
+
+        QDataStream stream( &file );
+        stream.setVersion( QDataStream::Qt_6_0 );
+
+        quint32 magic   = 0;
+        quint32 version = 0;
+        QString savedKey;
+
+        stream >> magic >> version;
+
+        if ( magic != INDEX_MAGIC || version != INDEX_FORMAT_VERSION )
+        {
+            logInfo() << "Ignoring incompatible search index " << file.fileName() << endl;
+            continue;
+        }
+
+        stream >> savedKey;
+
+        if ( savedKey != cacheKey )
+        {
+            logInfo() << "Search index " << file.fileName() << " is outdated" << endl;
+            continue;
+        }
+
+        QStringList pkgNames;
+        stream >> pkgNames >> _postings;
+
+        if ( stream.status() != QDataStream::Ok )
+        {
+            logWarning() << "Error reading search index " << file.fileName() << endl;
+            _postings.clear();
+            continue;
+        }
+
+        _pkgs.reserve( pkgNames.size() );
+
+        for ( const QString & pkgName: pkgNames )
+        {
+            ZyppSel selectable = zypp::ui::Selectable::get( zypp::ResKind::package,
+                                                            toUTF8( pkgName ) );
+            if ( ! selectable )
+            {
+                logWarning() << "Package " << pkgName << " from search index "
+                             << file.fileName() << " is not in the pool" << endl;
+                break;
+            }
+
+            _pkgs << selectable;
+        }
+
+        if ( _pkgs.size() == pkgNames.size() )
+        {
+            logDebug() << "Using search index " << file.fileName() << endl;
+            return true;
+        }
+
+        _pkgs.clear();
+        _postings.clear();
+    }
+
+    return false;
+}
+
+
+bool PkgSearchIndex::save( const QString & cacheKey ) const
+{
+    QStringList pkgNames;
+    pkgNames.reserve( _pkgs.size() );
+
+    for ( const ZyppSel & selectable: _pkgs )
+        pkgNames << fromUTF8( selectable->name() );
+
+    for ( const QString & dir: cacheDirs() )
+    {
+        if ( ! QDir().mkpath( dir ) )
+            continue;
+
+        // Write to a temporary file and rename it only when complete
+        QSaveFile file( dir + "/" + INDEX_FILE_NAME );
+
+        if ( ! file.open( QIODevice::WriteOnly ) )
+            continue;
+
+        QDataStream stream( &file );
+        stream.setVersion( QDataStream::Qt_6_0 );
+
+        stream << (quint32) INDEX_MAGIC
+               << (quint32) INDEX_FORMAT_VERSION
+               << cacheKey
+               << pkgNames
+               << _postings;
+
+        if ( stream.status() == QDataStream::Ok && file.commit() )
+        {
+            logInfo() << "Saved search index to " << file.fileName() << endl;
+            return true;
+        }
+
+        logWarning() << "Error writing search index " << file.fileName() << endl;
+    }
+
+    return false;
+}
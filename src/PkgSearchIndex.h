@@ -0,0 +1,216 @@
+/*  ---------------------------------------------------------
+               __  __            _
+              |  \/  |_   _ _ __| |_   _ _ __
+              | |\/| | | | | '__| | | | | '_ \
+              | |  | | |_| | |  | | |_| | | | |
+              |_|  |_|\__, |_|  |_|\__, |_| |_|
+                      |___/        |___/
+    ---------------------------------------------------------
+
+    Project:  Myrlyn Package Manager GUI
+    Copyright (c) Stefan Hundhammer <Stefan.Hundhammer@gmx.de>
+    License:  GPL V2 - See file LICENSE for details.
+
+ */
+
+
+#ifndef PkgSearchIndex_h
+#define PkgSearchIndex_h
+
+#include <string>
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "YQZypp.h"
+
+
+class QTimer;
+class SearchFilter;
+
+
+/**
+ * Singleton class for a trigram index over the name, summary and description
+ * of all packages. This is used to narrow down the candidates for a package
+ * search very quickly; the candidates still need to be checked against the
+ * real search pattern.
+ *
+ * Every package is indexed with the (lowercase) 3-byte sequences of those
+ * texts of all its versions, so a package can only match a search pattern if
+ * it has all the trigrams of the fixed parts of that pattern. Like a
+ * zypp::PoolQuery for the summary and description attributes, this uses the
+ * untranslated texts from the repo metadata, not the translated ones that
+ * the package list shows.
+ *
+ * Building the index for a full distribution takes a few seconds, so it is
+ * built in small time slices whenever the event loop is idle, starting when
+ * the repos are loaded. Until it is ready, searches simply don't use it. It
+ * is saved to disk next to the zypp repo cache (or in the user's cache
+ * directory if that is not writable) together with a key made from the
+ * repos' metadata checksums, and it is only rebuilt when that key changes.
+ **/
+class PkgSearchIndex: public QObject
+{
+    Q_OBJECT
+
+protected:
+
+    /**
+     * Constructor. Use the static instance() method instead.
+     **/
+    PkgSearchIndex();
+
+public:
+
+    /**
+     * Destructor.
+     **/
+    virtual ~PkgSearchIndex();
+
+    /**
+     * Return the instance of the singleton of this class.
+     * Create it if it doesn't exist yet.
+     **/
+    static PkgSearchIndex * instance();
+
+    /**
+     * Set the cache key for the packages that are currently in the zypp pool
+     * and forget the old index. Then start loading the new one from disk if
+     * it was saved with the same cache key, or building it in the background
+     * and saving it.
+     *
+     * 'cacheKey' should change whenever any repo's metadata changes.
+     **/
+    void setCacheKey( const QString & cacheKey );
+
+    /**
+     * Return 'true' if the index is ready to be used.
+     **/
+    bool isValid() const { return _valid; }
+
+    /**
+     * Return 'true' if the index can narrow down the candidates for
+     * 'searchFilter', i.e. if it is a Contains, StartsWith or Wildcard search
+     * with at least one fixed part of 3 or more bytes. This does not need
+     * the index to be ready yet.
+     **/
+    bool canNarrow( const SearchFilter & searchFilter ) const;
+
+    /**
+     * Return the packages that might match 'searchFilter' in their name,
+     * summary or description. Use canNarrow() and isValid() first.
+     **/
+    QList<ZyppSel> candidates( const SearchFilter & searchFilter ) const;
+
+    /**
+     * Return the texts of 'zyppObj' that the index covers (and that a
+     * zypp::PoolQuery for those attributes would match): The name and the
+     * untranslated summary and description.
+     **/
+    static std::string name       ( ZyppObj zyppObj );
+    static std::string summary    ( ZyppObj zyppObj );
+    static std::string description( ZyppObj zyppObj );
+
+    /**
+     * Forget the index, e.g. because the repos changed. This also stops
+     * building it.
+     **/
+    void clear();
+
+
+protected slots:
+
+    /**
+     * Load the index for the current cache key, or index the next few
+     * packages for a few milliseconds. Finish the index and save it when
+     * all packages are indexed.
+     **/
+    void processBuildSlice();
+
+
+protected:
+
+    typedef QVector<quint32> PostingList;
+
+    /**
+     * Start building the index: Take a snapshot of the packages in the zypp
+     * pool. They are indexed one by one with indexPkg().
+     **/
+    void startBuild();
+
+    /**
+     * Add the package with number 'pkgNo' to the index.
+     **/
+    void indexPkg( quint32 pkgNo );
+
+    /**
+     * Load the index from disk. Return 'true' on success, 'false' if there is
+     * no saved index or if it was saved with a different cache key.
+     **/
+    bool load( const QString & cacheKey );
+
+    /**
+     * Save the index to disk. Return 'true' on success, 'false' on error.
+     **/
+    bool save( const QString & cacheKey ) const;
+
+    /**
+     * Return the directories where the index may be saved, in order of
+     * preference.
+     **/
+    static QStringList cacheDirs();
+
+    /**
+     * Return the fixed parts of the pattern of 'searchFilter' that every
+     * match must contain (lowercase, UTF-8), or an empty list if the filter
+     * mode is not supported.
+     **/
+    static QList<QByteArray> fixedParts( const SearchFilter & searchFilter );
+
+    /**
+     * Add the trigrams of the name, summary and description of 'zyppObj' to
+     * 'trigrams'.
+     **/
+    static void addTrigrams( ZyppObj zyppObj, QVector<quint32> & trigrams );
+
+    /**
+     * Add the trigrams of 'utf8' to 'trigrams'.
+     **/
+    static void addTrigrams( const QByteArray & utf8, QVector<quint32> & trigrams );
+
+    /**
+     * Posting lists (the package numbers for one trigram) are stored as the
+     * differences to the previous package number as variable-length
+     * integers. This keeps the index for a full distribution reasonably
+     * small.
+     **/
+    static void        appendVarInt  ( QByteArray & postings, quint32 value );
+    static PostingList decodePostings( const QByteArray & postings );
+
+
+    //
+    // Data members
+    //
+
+    static PkgSearchIndex *     _instance;
+
+    bool                        _valid;
+    bool                        _building;
+    QString                     _cacheKey;
+    QVector<ZyppSel>            _pkgs;      // indexed by package number
+    QHash<quint32, QByteArray>  _postings;  // trigram -> encoded package numbers
+
+    QTimer *                    _sliceTimer;
+    QElapsedTimer               _buildTime;
+    quint32                     _nextPkgNo;
+    QHash<quint32, quint32>     _lastPkgNo; // trigram -> last package number in its postings
+};
+
+
+#endif // PkgSearchIndex_h
@@ -14,6 +14,8 @@
  */
 
 
+#include <QIcon>
+
 #include "Logger.h"
 #include "Exception.h"
 #include "PkgTaskListWidget.h"
@@ -29,35 +31,56 @@ void PkgTaskListWidget::addTaskItems( const PkgTaskList & taskList )
 PkgTaskListWidgetItem *
 PkgTaskListWidget::addTaskItem( PkgTask * task )
 {
-    PkgTaskListWidgetItem * item = new PkgTaskListWidgetItem( task, this );
+    PkgTaskListWidgetItem * item = new PkgTaskListWidgetItem( task );
     CHECK_NEW( item );
 
-    if ( _autoScrollToLast )
-        scrollToItem( item, QAbstractItemView::PositionAtBottom );
+    insertTaskItem( item );
 
     return item;
 }
 
 
+void PkgTaskListWidget::insertTaskItem( PkgTaskListWidgetItem * item )
+{
+    item->setSerial( nextSerial() );
+    addItem( item );
+    _taskItems.insert( item->task(), item );
+
+    if ( _autoScrollToLast )
+        scrollToItem( item, QAbstractItemView::PositionAtBottom );
+}
+
+
 PkgTaskListWidgetItem *
-PkgTaskListWidget::findTaskItem( PkgTask * task ) const
+PkgTaskListWidget::moveTaskItem( PkgTask *           task,
+                                 PkgTaskListWidget * targetList )
 {
-    for ( int row=0; row < count(); ++row )
-    {
-        PkgTaskListWidgetItem * it =
-            dynamic_cast<PkgTaskListWidgetItem *>( item( row ) );
+    PkgTaskListWidgetItem * item = _taskItems.take( task );
 
-        if ( it && it->task() == task )
-            return it;
-    }
+    if ( ! item )
+        return targetList->addTaskItem( task );
+
+    // row() and takeItem() are linear in the number of rows; the map only
+    // saves the search with a dynamic_cast for each row.
+
+    takeItem( row( item ) );
+    item->setIcon( QIcon() );
+    targetList->insertTaskItem( item );
 
-    return 0;
+    return item;
+}
+
+
+void PkgTaskListWidget::clear()
+{
+    _taskItems.clear();
+    QListWidget::clear();
 }
 
 
 void PkgTaskListWidget::removeTaskItem( PkgTask * task )
 {
-    PkgTaskListWidgetItem * item = findTaskItem( task );
+    PkgTaskListWidgetItem * item = _taskItems.take( task );
 
     if ( item )
     {
@@ -75,12 +98,10 @@ void PkgTaskListWidget::removeTaskItem( PkgTask * task )
 
 PkgTaskListWidgetItem::PkgTaskListWidgetItem( PkgTask *           task,
                                               PkgTaskListWidget * parent )
-    : QListWidgetItem( parent )
+    : QListWidgetItem()
     , _task( task )
     , _serial( 0 )
 {
-    if ( parent )
-        _serial = parent->nextSerial();
 
     QString txt;
 
@@ -90,6 +111,9 @@ PkgTaskListWidgetItem::PkgTaskListWidgetItem( PkgTask *           task,
     txt += _task->name();
     setText( txt );
 
+    if ( parent )
+        parent->insertTaskItem( this );
+
 #if 0
     if ( parent )
     {
@@ -18,6 +18,7 @@
 #define PkgTaskListWidget_h
 
 
+#include <QHash>
 #include <QListWidget>
 #include "PkgTasks.h"
 
@@ -26,11 +27,20 @@ class PkgTaskListWidgetItem;
 
 /**
  * A QListWidget specialized for PkgTasks.
+ *
+ * This keeps a map from each task to its item so finding the item for a task
+ * doesn't need to compare every item with a dynamic_cast. Taking an item out
+ * of the QListWidget (when removing or moving it) is still linear in the
+ * number of rows, but that is cheap compared to deleting and recreating the
+ * item. Use the task item methods of this class, not the QListWidget
+ * methods, to add or remove task items to keep that map up to date.
  **/
 class PkgTaskListWidget: public QListWidget
 {
     Q_OBJECT
 
+    friend class PkgTaskListWidgetItem;
+
 public:
 
     PkgTaskListWidget( QWidget * parent )
@@ -57,13 +67,30 @@ public:
      **/
     void removeTaskItem( PkgTask * task );
 
+    /**
+     * Move the item for a task to another list widget and return it.
+     *
+     * This reuses the item; only its icon is reset. If there is no item for
+     * that task in this list widget, this adds a new one to 'targetList'.
+     **/
+    PkgTaskListWidgetItem * moveTaskItem( PkgTask *           task,
+                                          PkgTaskListWidget * targetList );
+
     /**
      * Find the list widget item for a task and return it.
      * Return 0 if not found.
      *
      * Ownership of the item remains with the list widget.
      **/
-    PkgTaskListWidgetItem * findTaskItem( PkgTask * task ) const;
+    PkgTaskListWidgetItem * findTaskItem( PkgTask * task ) const
+        { return _taskItems.value( task, 0 ); }
+
+    /**
+     * Remove and delete all items.
+     *
+     * This hides the non-virtual QListWidget::clear().
+     **/
+    void clear();
 
     /**
      * Return 'true' if the sort order should always be the item insertion
@@ -97,9 +124,17 @@ public:
 
 protected:
 
+    /**
+     * Insert an existing item for a task into this list widget.
+     **/
+    void insertTaskItem( PkgTaskListWidgetItem * item );
+
+
     int  _nextSerial;
     bool _sortByInsertionSequence;
     bool _autoScrollToLast;
+
+    QHash<PkgTask *, PkgTaskListWidgetItem *> _taskItems;
 };
 
 
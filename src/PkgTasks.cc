@@ -62,6 +62,64 @@ bool PkgTask::matches( const PkgTask & other ) const
 }
 
 
+void PkgTask::setDownloadSize( ByteCount value )
+{
+    qint64 oldDownloaded = downloadedCentiBytes();
+    _downloadSize = value;
+
+    if ( _list )
+        _list->updateSums( downloadedCentiBytes() - oldDownloaded, 0 );
+}
+
+
+void PkgTask::setInstalledSize( ByteCount value )
+{
+    qint64 oldCompleted = completedCentiBytes();
+    _installedSize = value;
+
+    if ( _list )
+        _list->updateSums( 0, completedCentiBytes() - oldCompleted );
+}
+
+
+void PkgTask::setDownloadedPercent( int value )
+{
+    qint64 oldDownloaded = downloadedCentiBytes();
+    _downloadedPercent = value;
+
+    if ( _list )
+        _list->updateSums( downloadedCentiBytes() - oldDownloaded, 0 );
+}
+
+
+void PkgTask::setCompletedPercent( int value )
+{
+    qint64 oldCompleted = completedCentiBytes();
+    _completedPercent = value;
+
+    if ( _list )
+        _list->updateSums( 0, completedCentiBytes() - oldCompleted );
+}
+
+
+qint64 PkgTask::downloadedCentiBytes() const
+{
+    if ( ( _action & PkgAdd ) && _downloadSize > 0 && _downloadedPercent > 0 )
+        return (qint64) _downloadSize * _downloadedPercent;
+    else
+        return 0;
+}
+
+
+qint64 PkgTask::completedCentiBytes() const
+{
+    if ( _installedSize > 0 && _completedPercent > 0 )
+        return (qint64) _installedSize * _completedPercent;
+    else
+        return 0;
+}
+
+
 QString PkgTask::actionToString( PkgTaskAction action )
 {
     if ( action & PkgInstall   )  return "PkgInstall";
@@ -111,51 +169,162 @@ LogStream & operator<<( LogStream & str, PkgTask * task )
 PkgTaskList::PkgTaskList( const QString & listName )
         : QList<PkgTask *>()
         , _name( listName )
+        , _downloadedCentiBytes( 0 )
+        , _completedCentiBytes( 0 )
 {
 }
 
 
-PkgTaskList::~PkgTaskList()
+PkgTaskList::PkgTaskList( const PkgTaskList & other )
+        : QList<PkgTask *>( other )
+        , _name( other._name )
+        , _nameIndex( other._nameIndex )
+        , _downloadedCentiBytes( other._downloadedCentiBytes )
+        , _completedCentiBytes( other._completedCentiBytes )
 {
+    // The tasks still belong to 'other'
 }
 
 
-PkgTask *
-PkgTaskList::find( const QString &  name,
-                   PkgTaskAction    action,
-                   PkgTaskRequester requester ) const
+PkgTaskList::PkgTaskList( PkgTaskList && other )
+        : QList<PkgTask *>( std::move( other ) )
+        , _name( other._name )
+        , _nameIndex( std::move( other._nameIndex ) )
+        , _downloadedCentiBytes( other._downloadedCentiBytes )
+        , _completedCentiBytes( other._completedCentiBytes )
 {
     for ( PkgTask * task: *this )
     {
-        if ( task && task->matches( name, action, requester ) )
-            return task;
+        if ( task && task->_list == &other )
+            task->_list = this;
     }
 
-    return 0;
+    other.QList<PkgTask *>::clear();
+    other._nameIndex.clear();
+    other._downloadedCentiBytes = 0;
+    other._completedCentiBytes  = 0;
 }
 
 
-PkgTask *
-PkgTaskList::find( const PkgTask & filter ) const
+PkgTaskList::~PkgTaskList()
 {
+    // Don't let the tasks update the sums of a list that no longer exists.
+    // This is safe for lists that are nuked: Those are empty by now.
+
     for ( PkgTask * task: *this )
     {
-        if ( task && task->matches( filter ) )
-            return task;
+        if ( task && task->_list == this )
+            task->_list = 0;
     }
+}
 
-    return 0;
+
+void PkgTaskList::add( PkgTask * task )
+{
+    // A task belongs to only one list at a time
+
+    if ( task && task->_list && task->_list != this )
+        task->_list->take( task );
+
+    append( task );
+
+    if ( task )
+    {
+        if ( ! _nameIndex.contains( task->name() ) )
+            _nameIndex.insert( task->name(), task );
+
+        task->_list = this;
+        updateSums( task->downloadedCentiBytes(), task->completedCentiBytes() );
+    }
+}
+
+
+bool PkgTaskList::take( PkgTask * task )
+{
+    int index = indexOf( task );
+
+    if ( index < 0 )
+        return false;
+
+    removeAt( index );
+
+    if ( task )
+    {
+        // The task was counted in the sums when it was added (or when this
+        // list was copied), no matter if it still belongs to this list.
+
+        updateSums( -task->downloadedCentiBytes(), -task->completedCentiBytes() );
+
+        if ( task->_list == this )
+            task->_list = 0;
+    }
+
+    if ( task && _nameIndex.value( task->name() ) == task )
+    {
+        _nameIndex.remove( task->name() );
+
+        // In the unlikely case of another task with the same name, that one
+        // is the first one now.
+
+        for ( PkgTask * other: *this )
+        {
+            if ( other && other->name() == task->name() )
+            {
+                _nameIndex.insert( other->name(), other );
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+void PkgTaskList::clear()
+{
+    for ( PkgTask * task: *this )
+    {
+        if ( task && task->_list == this )
+            task->_list = 0;
+    }
+
+    QList<PkgTask *>::clear();
+    _nameIndex.clear();
+    _downloadedCentiBytes = 0;
+    _completedCentiBytes  = 0;
+}
+
+
+void PkgTaskList::deleteAll()
+{
+    qDeleteAll( *this );
+
+    QList<PkgTask *>::clear();
+    _nameIndex.clear();
+    _downloadedCentiBytes = 0;
+    _completedCentiBytes  = 0;
 }
 
 
 PkgTask *
-PkgTaskList::find( ZyppRes zyppRes ) const
+PkgTaskList::find( const QString &  name,
+                   PkgTaskAction    action,
+                   PkgTaskRequester requester ) const
 {
-    QString resName = fromUTF8( zyppRes->name() );
+    if ( ! name.isEmpty() )
+    {
+        PkgTask * task = _nameIndex.value( name, 0 );
+
+        if ( ! task || task->matches( name, action, requester ) )
+            return task;
+
+        // Otherwise there might be another task with the same name further
+        // down the list: Fall back to the linear search.
+    }
 
     for ( PkgTask * task: *this )
     {
-        if ( task && task->name() == resName )
+        if ( task && task->matches( name, action, requester ) )
             return task;
     }
 
@@ -163,6 +332,20 @@ PkgTaskList::find( ZyppRes zyppRes ) const
 }
 
 
+PkgTask *
+PkgTaskList::find( const PkgTask & filter ) const
+{
+    return find( filter.name(), filter.action(), filter.requester() );
+}
+
+
+PkgTask *
+PkgTaskList::find( ZyppRes zyppRes ) const
+{
+    return _nameIndex.value( fromUTF8( zyppRes->name() ), 0 );
+}
+
+
 PkgTaskList
 PkgTaskList::filtered( PkgTaskAction    filterAction,
                        PkgTaskRequester filterRequester )
@@ -174,7 +357,7 @@ PkgTaskList::filtered( PkgTaskAction    filterAction,
         if ( ( task->action()    & filterAction    ) &&
              ( task->requester() & filterRequester )    )
         {
-            result.append( new PkgTask( *task ) );
+            result.add( new PkgTask( *task ) );
         }
     }
 
@@ -185,34 +368,14 @@ PkgTaskList::filtered( PkgTaskAction    filterAction,
 ByteCount
 PkgTaskList::downloadSizeSum() const
 {
-    ByteCount sum(0);
-
-    for ( const PkgTask * task: *this )
-    {
-        if ( ( task->action() & PkgAdd )    &&
-             task->downloadSize()      > 0  &&
-             task->downloadedPercent() > 0 )
-        {
-            sum += task->downloadSize() * ( task->downloadedPercent() / 100.0 );
-        }
-    }
-
-    return sum;
+    return ByteCount( _downloadedCentiBytes / 100 );
 }
 
 
 ByteCount
 PkgTaskList::installedSizeSum() const
 {
-    ByteCount sum(0);
-
-    for ( const PkgTask * task: *this )
-    {
-        if ( task->installedSize() > 0 && task->completedPercent() > 0 )
-            sum += task->installedSize() * ( task->completedPercent() / 100.0 );
-    }
-
-    return sum;
+    return ByteCount( _completedCentiBytes / 100 );
 }
 
 
@@ -230,7 +393,7 @@ void PkgTaskList::sort()
     // We need a functor here; an PkgTask::operator<( PkgTask * other ) is
     // ignored, std::sort() just compares the pointer values (!) in that case.
 
-    std::sort( begin(), end(), compareFunctor );
+    std::sort( QList<PkgTask *>::begin(), QList<PkgTask *>::end(), compareFunctor );
 }
 
 
@@ -274,8 +437,7 @@ void PkgTasks::nuke( PkgTaskList & list )
                    << "\"  size:" << list.size()
                    << endl;
 
-        qDeleteAll( list );
-        list.clear();
+        list.deleteAll();
     }
 }
 
@@ -284,15 +446,13 @@ void PkgTasks::moveTask( PkgTask *      task,
                          PkgTaskList &  fromList,
                          PkgTaskList &  toList )
 {
-    int index = fromList.indexOf( task );
-
-    if ( index < 0 )
+    if ( ! fromList.take( task ) )
     {
         logError() << "Task " << task->name() << " not found in this list" << endl;
         return;
     }
 
-    toList.append( fromList.takeAt( index ) );
+    toList.add( task );
 }
 
 
@@ -361,7 +521,7 @@ void PkgTasks::initFromZypp()
             }
 
             logInfo() << "New task " << task << endl;
-            _todo.append( task );
+            _todo.add( task );
         }
     }
 }
@@ -19,6 +19,7 @@
 
 
 #include <QString>
+#include <QHash>
 #include <QList>
 #include <QMutex>
 
@@ -30,6 +31,8 @@
 
 using zypp::ByteCount;
 
+class PkgTaskList;
+
 /**
  * Types of actions for a package task.
  *
@@ -99,8 +102,29 @@ public:
         , _installedSize( -1.0 )
         , _downloadedPercent( -1 )
         , _completedPercent( -1 )
+        , _list( 0 )
+        {}
+
+    /**
+     * Copy constructor. The copy is not in any list yet.
+     **/
+    PkgTask( const PkgTask & other )
+        : _name( other._name )
+        , _action( other._action )
+        , _requester( other._requester )
+        , _downloadSize ( other._downloadSize )
+        , _installedSize( other._installedSize )
+        , _downloadedPercent( other._downloadedPercent )
+        , _completedPercent( other._completedPercent )
+        , _list( 0 )
         {}
 
+    /**
+     * No assignment: It would copy the list that owns 'other', and this
+     * task would update the running sums of a list that it is not in.
+     **/
+    PkgTask & operator=( const PkgTask & other ) = delete;
+
     /**
      * Return the package name.
      **/
@@ -141,7 +165,7 @@ public:
     /**
      * Set the download size in bytes.
      **/
-    void setDownloadSize( ByteCount value ) { _downloadSize = value; }
+    void setDownloadSize( ByteCount value );
 
     /**
      * Return the installed size in bytes or -1.0 (< 0.0) if unknown.
@@ -151,7 +175,7 @@ public:
     /**
      * Set the installed size in bytes.
      **/
-    void setInstalledSize( ByteCount value ) { _installedSize = value; }
+    void setInstalledSize( ByteCount value );
 
     /**
      * Return the downloaded percent (0..100) or -1 if unknown.
@@ -162,7 +186,7 @@ public:
     /**
      * Set the downloaded percent (0..100).
      **/
-    void setDownloadedPercent( int value ) { _downloadedPercent = value; }
+    void setDownloadedPercent( int value );
 
     /**
      * Return percent (0..100) to which this task is completed or -1 if
@@ -173,7 +197,19 @@ public:
     /**
      * Set the completed percent (0..100).
      **/
-    void setCompletedPercent( int value ) { _completedPercent = value; }
+    void setCompletedPercent( int value );
+
+    /**
+     * Return the downloaded part of the download size in 1/100 bytes,
+     * i.e. download size * downloaded percent, or 0 if not applicable.
+     **/
+    qint64 downloadedCentiBytes() const;
+
+    /**
+     * Return the completed part of the installed size in 1/100 bytes,
+     * i.e. installed size * completed percent, or 0 if unknown.
+     **/
+    qint64 completedCentiBytes() const;
 
     /**
      * Return 'true' if this action matches the specified name, action and
@@ -205,6 +241,8 @@ public:
 
 protected:
 
+    friend class PkgTaskList;
+
     QString          _name;
     PkgTaskAction    _action;
     PkgTaskRequester _requester;
@@ -213,26 +251,93 @@ protected:
     ByteCount        _installedSize;
     int              _downloadedPercent;  // 0..100 or -1 for unknown
     int              _completedPercent;   // 0..100 or -1 for unknown
+
+    PkgTaskList *    _list;               // The list that keeps sums for this
 };
 
 
 /**
  * A list of package tasks.
+ *
+ * The list keeps an index by package name so the lookups for the zypp
+ * callbacks during the package commit don't have to scan the whole list.
+ * It also keeps running totals of the download and installed sizes of its
+ * tasks (weighted by their progress) that are updated whenever a task is added
+ * or removed or the task's sizes or progress change.
+ *
+ * To keep the index and the sums up to date, the list can only be modified
+ * with add(), take(), clear(), deleteAll() and sort(); the QList base class is
+ * not public. Iterating over the list and the read-only QList methods are
+ * available.
+ *
+ * Each task belongs to exactly one list at any time: the one it was last
+ * added to. Only that list follows changes of the task's sizes and progress
+ * in its sums. Adding a task to a list removes it from its previous list.
  **/
-class PkgTaskList: public QList<PkgTask *>
+class PkgTaskList: protected QList<PkgTask *>
 {
 public:
 
+    typedef QList<PkgTask *>::const_iterator const_iterator;
+
+    using QList<PkgTask *>::at;
+    using QList<PkgTask *>::contains;
+    using QList<PkgTask *>::count;
+    using QList<PkgTask *>::indexOf;
+    using QList<PkgTask *>::isEmpty;
+    using QList<PkgTask *>::size;
+
+    const_iterator begin() const { return QList<PkgTask *>::cbegin(); }
+    const_iterator end()   const { return QList<PkgTask *>::cend();   }
+
+    PkgTask * first() const { return QList<PkgTask *>::constFirst(); }
+    PkgTask * last()  const { return QList<PkgTask *>::constLast();  }
+
     /**
      * Constructor.
      **/
     PkgTaskList( const QString & listName );
 
+    /**
+     * Copy constructor. The copy is a snapshot: It contains the same tasks,
+     * but they still belong to 'other', so the sums of the copy don't follow
+     * later changes of the tasks.
+     **/
+    PkgTaskList( const PkgTaskList & other );
+
+    /**
+     * Move constructor. The tasks of 'other' now belong to this list.
+     **/
+    PkgTaskList( PkgTaskList && other );
+
     /**
      * Destructor.
      **/
     virtual ~PkgTaskList();
 
+    /**
+     * Append a task to the list and add it to the name index.
+     * If the task belongs to another list, it is taken from that list first.
+     **/
+    void add( PkgTask * task );
+
+    /**
+     * Remove a task from the list and from the name index.
+     * Return 'true' if it was in the list, 'false' if not.
+     **/
+    bool take( PkgTask * task );
+
+    /**
+     * Remove all tasks from the list and clear the name index.
+     * This does not delete the tasks.
+     **/
+    void clear();
+
+    /**
+     * Delete all tasks in the list and clear the list.
+     **/
+    void deleteAll();
+
     /**
      * Find the first action that matches the specified name, action and
      * requester. If 'name' is empty, only action and requester are checked.
@@ -270,15 +375,15 @@ public:
                           PkgTaskRequester requester = PkgReqAll );
 
     /**
-     * Calculate and return the sum of all download sizes for PkgAdd tasks
+     * Return the sum of all download sizes for PkgAdd tasks
      * (PkgInstall | PkgUpdate), taking 'downloadedPercent()' of each task into
      * account.
      **/
     ByteCount downloadSizeSum() const;
 
     /**
-     * Calculate and return the sum of all installed sizes for all tasks in
-     * this list, taking 'completedPercent()' of each task into account.
+     * Return the sum of all installed sizes for all tasks in this list,
+     * taking 'completedPercent()' of each task into account.
      **/
     ByteCount installedSizeSum() const;
 
@@ -295,7 +400,25 @@ public:
 
 protected:
 
+    PkgTaskList & operator=( const PkgTaskList & other ) = delete;
+
+    friend class PkgTask;
+
+    /**
+     * Update the sums with the changes of a task in this list.
+     **/
+    void updateSums( qint64 downloadedDelta, qint64 completedDelta )
+    {
+        _downloadedCentiBytes += downloadedDelta;
+        _completedCentiBytes  += completedDelta;
+    }
+
+
     QString _name;
+
+    QHash<QString, PkgTask *> _nameIndex;
+    qint64                    _downloadedCentiBytes;
+    qint64                    _completedCentiBytes;
 };
 
 
@@ -305,7 +428,7 @@ protected:
  *
  * This is just a very thin layer around the package task lists; the getters
  * for the lists all return a non-const reference so the application can use
- * package list (and QList) functions directly.
+ * the package list functions directly.
  *
  * Some convenience methods are provided.
  **/
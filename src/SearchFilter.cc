@@ -7,6 +7,8 @@
  *              Donated by the QDirStat project
  */
 
+#include <string.h>     // memcmp()
+
 #include "Logger.h"
 #include "utf8.h"
 #include "SearchFilter.h"
@@ -30,6 +32,66 @@ SearchFilter::SearchFilter( const QString & pattern,
         _regexp.setPattern( QRegularExpression::wildcardToRegularExpression( _regexp.pattern() ) );
 
     _regexp.setPatternOptions( QRegularExpression::CaseInsensitiveOption );
+    compile();
+}
+
+
+void SearchFilter::compile()
+{
+    _caseSensitivity = ( _regexp.patternOptions() & QRegularExpression::CaseInsensitiveOption ) ?
+        Qt::CaseInsensitive : Qt::CaseSensitive;
+
+    _foldCase     = _caseSensitivity == Qt::CaseInsensitive;
+    _asciiPattern = false;
+    _asciiBytes.clear();
+
+    switch ( _filterMode )
+    {
+        case Contains:
+        case StartsWith:
+        case ExactMatch:
+            {
+                std::string utf8 = toUTF8( _pattern );
+
+                if ( isAscii( utf8.data(), utf8.size() ) )
+                {
+                    _asciiPattern = true;
+                    _asciiBytes   = utf8;
+
+                    for ( char & c: _asciiBytes )
+                        c = fold( c );
+                }
+            }
+            break;
+
+        case Wildcard:
+        case RegExp:
+            // Compile the regexp (with the JIT if available) right now, not
+            // with the first match
+            _regexp.optimize();
+            break;
+
+        default:
+            break;
+    }
+
+    if ( _filterMode == Contains && _asciiPattern )
+    {
+        // Boyer-Moore-Horspool shift table: How far the pattern can be moved
+        // on for the (folded) text character at its last position.
+        //
+        // The shift is limited to 255 which is still correct (just slower)
+        // for even longer patterns.
+
+        size_t len = _asciiBytes.size();
+        memset( _skip, len < 255 ? len : 255, sizeof( _skip ) );
+
+        for ( size_t i = 0; i + 1 < len; ++i )
+        {
+            size_t shift = len - 1 - i;
+            _skip[ (unsigned char) _asciiBytes[ i ] ] = shift < 255 ? shift : 255;
+        }
+    }
 }
 
 
@@ -93,16 +155,11 @@ SearchFilter::guessFilterMode( const QString & pattern )
 
 bool SearchFilter::matches( const QString & str ) const
 {
-    Qt::CaseSensitivity caseSensitivity = Qt::CaseInsensitive;
-
-    if ( ( _regexp.patternOptions() & QRegularExpression::CaseInsensitiveOption ) == 0 )
-      caseSensitivity = Qt::CaseSensitive;
-
     switch ( _filterMode )
     {
-        case Contains:   return str.contains  ( _pattern, caseSensitivity );
-        case StartsWith: return str.startsWith( _pattern, caseSensitivity );
-        case ExactMatch: return QString::compare( str, _pattern, caseSensitivity ) == 0;
+        case Contains:   return str.contains  ( _pattern, _caseSensitivity );
+        case StartsWith: return str.startsWith( _pattern, _caseSensitivity );
+        case ExactMatch: return QString::compare( str, _pattern, _caseSensitivity ) == 0;
         case Wildcard:   return _regexp.match( str ).hasMatch();
         case RegExp:     return str.contains( _regexp );
         case SelectAll:  return true;
@@ -118,7 +175,94 @@ bool SearchFilter::matches( const QString & str ) const
 
 bool SearchFilter::matches( const std::string & str ) const
 {
-    return matches( fromUTF8( str ) );
+    return matches( str.data(), str.size() );
+}
+
+
+bool SearchFilter::matches( const char * str, size_t len ) const
+{
+    if ( _filterMode == SelectAll )
+        return true;
+
+    // Comparing UTF-8 bytes with a plain ASCII pattern is always exact if the
+    // match is case sensitive. Otherwise non-ASCII characters need Unicode
+    // case folding, so leave those to QString.
+
+    if ( _asciiPattern && ( ! _foldCase || isAscii( str, len ) ) )
+        return matchesAscii( str, len );
+
+    return matches( QString::fromUtf8( str, len ) );
+}
+
+
+bool SearchFilter::matchesAscii( const char * str, size_t len ) const
+{
+    const unsigned char * text = (const unsigned char *) str;
+    size_t patternLen = _asciiBytes.size();
+
+    switch ( _filterMode )
+    {
+        case Contains:   return containsAscii( text, len );
+        case StartsWith: return len >= patternLen && equalsAscii( text, patternLen );
+        case ExactMatch: return len == patternLen && equalsAscii( text, patternLen );
+        default:         break;
+    }
+
+    return matches( QString::fromUtf8( str, len ) );
+}
+
+
+bool SearchFilter::containsAscii( const unsigned char * text, size_t len ) const
+{
+    size_t patternLen = _asciiBytes.size();
+
+    if ( patternLen == 0 )
+        return true;
+
+    if ( len < patternLen )
+        return false;
+
+    const unsigned char lastPatternChar = _asciiBytes[ patternLen - 1 ];
+    size_t pos = 0;
+
+    while ( pos <= len - patternLen )
+    {
+        unsigned char last = fold( text[ pos + patternLen - 1 ] );
+
+        if ( last == lastPatternChar && equalsAscii( text + pos, patternLen - 1 ) )
+            return true;
+
+        pos += _skip[ last ];
+    }
+
+    return false;
+}
+
+
+bool SearchFilter::equalsAscii( const unsigned char * str, size_t len ) const
+{
+    if ( ! _foldCase )
+        return memcmp( str, _asciiBytes.data(), len ) == 0;
+
+    for ( size_t i = 0; i < len; ++i )
+    {
+        if ( fold( str[ i ] ) != (unsigned char) _asciiBytes[ i ] )
+            return false;
+    }
+
+    return true;
+}
+
+
+bool SearchFilter::isAscii( const char * str, size_t len )
+{
+    for ( size_t i = 0; i < len; ++i )
+    {
+        if ( str[ i ] & 0x80 )
+            return false;
+    }
+
+    return true;
 }
 
 
@@ -129,6 +273,8 @@ void SearchFilter::setCaseSensitive( bool sensitive )
       _regexp.setPatternOptions( QRegularExpression::NoPatternOption );
     else
       _regexp.setPatternOptions( QRegularExpression::CaseInsensitiveOption );
+
+    compile();
 }
 
 
@@ -21,6 +21,13 @@
 
 /**
  * Base class for search filters like PkgFilter or FileSearchFilter.
+ *
+ * Everything that the matching needs is precomputed when the filter is
+ * created since matches() may be called very often: For fixed strings that
+ * are plain 7-bit ASCII, std::string candidates are compared directly on
+ * their UTF-8 bytes without any conversion to QString (using a
+ * Boyer-Moore-Horspool search for "Contains"); regular expressions are
+ * compiled immediately.
  **/
 class SearchFilter
 {
@@ -59,6 +66,7 @@ public:
      **/
     bool matches( const QString &     str ) const;
     bool matches( const std::string & str ) const;
+    bool matches( const char * str, size_t len ) const;
 
     /**
      * Return the pattern.
@@ -80,7 +88,7 @@ public:
      * Return 'true' if the matching is case sensitive, 'false if not.
      **/
     bool isCaseSensitive() const
-        { return ( _regexp.patternOptions() & QRegularExpression::CaseInsensitiveOption) == 0; }
+        { return _caseSensitivity == Qt::CaseSensitive; }
 
     /**
      * Set the match to case sensitive ('true') or case insensitive
@@ -109,6 +117,41 @@ protected:
      **/
     void guessFilterMode();
 
+    /**
+     * Precompute everything that matches() needs for the current pattern,
+     * filter mode and case sensitivity.
+     **/
+    void compile();
+
+    /**
+     * Check if 'str' matches the ASCII fixed string pattern. If the match is
+     * case insensitive, 'str' has to be plain ASCII, too.
+     **/
+    bool matchesAscii( const char * str, size_t len ) const;
+
+    /**
+     * Return 'true' if 'str' contains the ASCII fixed string pattern.
+     **/
+    bool containsAscii( const unsigned char * str, size_t len ) const;
+
+    /**
+     * Return 'true' if the first 'len' bytes of 'str' are equal to the
+     * ASCII fixed string pattern, taking the case sensitivity into account.
+     **/
+    bool equalsAscii( const unsigned char * str, size_t len ) const;
+
+    /**
+     * Return 'true' if 'str' consists only of 7-bit ASCII characters.
+     **/
+    static bool isAscii( const char * str, size_t len );
+
+    /**
+     * Return the lowercase version of ASCII character 'c' if the match is
+     * case insensitive, 'c' itself otherwise.
+     **/
+    unsigned char fold( unsigned char c ) const
+        { return ( _foldCase && c >= 'A' && c <= 'Z' ) ? c + ( 'a' - 'A' ) : c; }
+
 
     // Data members
 
@@ -117,6 +160,14 @@ protected:
     FilterMode         _filterMode;
     FilterMode         _defaultFilterMode;
 
+    // Compiled matcher
+
+    Qt::CaseSensitivity _caseSensitivity;
+    bool                _foldCase;
+    bool                _asciiPattern;      // Fixed string, plain ASCII
+    std::string         _asciiBytes;        // lowercase if _foldCase
+    unsigned char       _skip[ 256 ];       // Boyer-Moore-Horspool shift table
+
 };  // class SearchFilter
 
 
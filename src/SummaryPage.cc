@@ -23,6 +23,7 @@
 #include "Logger.h"
 #include "MainWindow.h"
 #include "MyrlynApp.h"
+#include "PkgCommitTimings.h"
 #include "PkgTasks.h"
 #include "MyrlynApp.h"
 #include "YQi18n.h"
@@ -265,6 +266,9 @@ void SummaryPage::updateSummary()
         text = longSummary( byUserMax, byDepMax );
     }
 
+    if ( ! PkgCommitTimings::instance()->isEmpty() )
+        text += "\n\n" + PkgCommitTimings::instance()->summary();
+
     _ui->contentTextEdit->setText( text );
 }
 
@@ -273,8 +277,10 @@ void SummaryPage::fakeDoneList()
 {
     // --fake-summary:  Move all remaining tasks from "todo" to "done".
 
-    pkgTasks()->done() << pkgTasks()->todo();
-    pkgTasks()->todo().clear();
+    PkgTaskList & todo = pkgTasks()->todo();
+
+    while ( ! todo.isEmpty() )
+        PkgTasks::moveTask( todo.first(), todo, pkgTasks()->done() );
 }
 
 
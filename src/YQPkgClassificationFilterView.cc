@@ -128,6 +128,7 @@ YQPkgClassificationFilterView::filter()
 #endif
 
     emit filterStart();
+    _matches.clear();
 
     if ( selectedPkgClass() != YQPkgClassNone )
     {
@@ -168,6 +169,10 @@ YQPkgClassificationFilterView::filter()
 	}
     }
 
+    if ( ! _matches.isEmpty() )
+        emit filterMatches( _matches );
+
+    _matches.clear();
     emit filterFinished();
 }
 
@@ -213,7 +218,7 @@ YQPkgClassificationFilterView::check( ZyppSel selectable, ZyppPkg pkg )
     bool match = checkMatch( selectable, pkg );
 
     if ( match )
-	emit filterMatch( selectable, pkg );
+	_matches << ZyppPkgMatch( selectable, pkg );
 
     return match;
 }
@@ -57,8 +57,8 @@ public:
     virtual ~YQPkgClassificationFilterView();
 
     /**
-     * Check if 'pkg' matches the selected package class and send a filterMatch
-     * signal if it does.
+     * Check if 'pkg' matches the selected package class and add it to the
+     * matches of the current filter run if it does.
      *
      * Returns 'true' if there is a match, 'false' otherwise.
      **/
@@ -92,7 +92,7 @@ public slots:
      * Filter according to the view's rules and current selection.
      * Emits those signals:
      *	  filterStart()
-     *	  filterMatch() for each pkg that matches the filter
+     *	  filterMatches() for the pkgs that match the filter
      *	  filterFinished()
      **/
     void filter();
@@ -107,9 +107,11 @@ signals:
     void filterStart();
 
     /**
-     * Emitted during filtering for each pkg that matches the filter.
+     * Emitted during filtering for the pkgs that match the filter.
+     * This may be emitted several times during one filter run, each time
+     * with a batch of matches.
      **/
-    void filterMatch( ZyppSel selectable, ZyppPkg pkg );
+    void filterMatches( const ZyppPkgMatchList & matches );
 
     /**
      * Emitted when filtering is finished.
@@ -126,6 +128,10 @@ protected:
 
     void fillPkgClasses();
 
+
+    // Data members
+
+    ZyppPkgMatchList _matches;
 };
 
 
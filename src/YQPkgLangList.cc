@@ -113,6 +113,7 @@ YQPkgLangList::filter()
 #endif
 
     emit filterStart();
+    ZyppPkgMatchList matches;
 
     if ( selection() )
     {
@@ -125,10 +126,14 @@ YQPkgLangList::filter()
 
             if ( zyppPkg )
             {
-                emit filterMatch( *it, zyppPkg );
+                matches << ZyppPkgMatch( *it, zyppPkg );
             }
         }
     }
+
+    if ( ! matches.isEmpty() )
+        emit filterMatches( matches );
+
     emit filterFinished();
 }
 
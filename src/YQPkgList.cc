@@ -18,6 +18,7 @@
 #include <QFontMetrics>
 #include <QHeaderView>
 #include <QMenu>
+#include <QTimer>
 
 #include "Logger.h"
 #include "QY2CursorHelper.h"
@@ -33,9 +34,13 @@
 #define STATUS_COL_WIDTH        28
 #define MAGIC_MISSING_WIDTH     15
 
+#define COL_WIDTH_SAMPLE_SIZE   500
+
 
 YQPkgList::YQPkgList( QWidget * parent )
     : YQPkgObjList( parent )
+    , _firstUnmeasuredRow( 0 )
+    , _colWidthsUpdatePending( false )
 {
     resetBestColWidths();
 
@@ -91,6 +96,15 @@ YQPkgList::~YQPkgList()
 }
 
 
+void YQPkgList::addPkgItems( const ZyppPkgMatchList & matches )
+{
+    for ( const ZyppPkgMatch & match: matches )
+        createPkgItem( match.first, match.second, false );
+
+    updateColumnWidths();
+}
+
+
 void YQPkgList::addPkgItem( ZyppSel selectable,
                             ZyppPkg zyppPkg )
 {
@@ -110,23 +124,57 @@ YQPkgList::addPkgItem( ZyppSel  selectable,
                        ZyppPkg  zyppPkg,
                        bool     dimmed )
 {
-    scrollToTop();
-    scheduleDelayedItemsLayout();
+    if ( createPkgItem( selectable, zyppPkg, dimmed ) )
+        scheduleColumnWidthsUpdate();
+}
 
+
+YQPkgListItem *
+YQPkgList::createPkgItem( ZyppSel  selectable,
+                          ZyppPkg  zyppPkg,
+                          bool     dimmed )
+{
     if ( ! selectable )
     {
         logError() << "NULL zypp::ui::Selectable!" << endl;
-        return;
+        return 0;
     }
 
     YQPkgListItem * item = new YQPkgListItem( this, selectable, zyppPkg );
     Q_CHECK_PTR( item );
 
-    updateBestColWidths( selectable, zyppPkg );
-    optimizeColumnWidths();
-
     item->setDimmed( dimmed );
     applyExcludeRules( item );
+
+    return item;
+}
+
+
+void
+YQPkgList::scheduleColumnWidthsUpdate()
+{
+    if ( _colWidthsUpdatePending )
+        return;
+
+    _colWidthsUpdatePending = true;
+    QTimer::singleShot( 0, this, SLOT( updateColumnWidths() ) );
+}
+
+
+void
+YQPkgList::updateColumnWidths()
+{
+    _colWidthsUpdatePending = false;
+
+    int rowCount = topLevelItemCount();
+
+    if ( _firstUnmeasuredRow >= rowCount )
+        return;
+
+    updateBestColWidths( _firstUnmeasuredRow, rowCount );
+    _firstUnmeasuredRow = rowCount;
+
+    optimizeColumnWidths();
 }
 
 
@@ -165,88 +213,48 @@ YQPkgList::resetBestColWidths()
 
 
 void
-YQPkgList::updateBestColWidths( ZyppSel selectable,
-                                ZyppPkg zyppPkg )
+YQPkgList::updateBestColWidths( int fromRow, int toRow )
 {
-    QFontMetrics  fontMetrics( font() );
-    QString       colText;
-    int           colWidth  = 0;
-    const ZyppObj candidate = selectable->candidateObj();
-    const ZyppObj installed = selectable->installedObj();
-
-    // Status icon
-
-    _bestStatusColWidth = STATUS_COL_WIDTH;
-
-
-    // Name
-
-    colText  = fromUTF8( zyppPkg->name().c_str() );
-    colWidth = fontMetrics.boundingRect( colText ).width() + ( STATUS_ICON_SIZE / 2 );
-
-    if ( colWidth > _bestNameColWidth )
-        _bestNameColWidth = colWidth;
-
-
-    // Summary
+    QFontMetrics fontMetrics( font() );
+    const int    margin     = STATUS_ICON_SIZE / 2;
+    const bool   combinedVersionCol = ( instVersionCol() == versionCol() );
 
-    colText  = fromUTF8( zyppPkg->summary().c_str() );
-    colWidth = fontMetrics.boundingRect( colText ).width() + ( STATUS_ICON_SIZE / 2 );
+    // With many thousands of items, only measure a sample that is evenly
+    // distributed over the range. Since the list is not sorted yet at this
+    // point, this is a fairly random sample.
 
-    if ( colWidth > _bestSummaryColWidth )
-        _bestSummaryColWidth = colWidth;
+    int step = qMax( 1, ( toRow - fromRow ) / COL_WIDTH_SAMPLE_SIZE );
 
+    // Status icon
 
-    // Version(s)
+    _bestStatusColWidth = STATUS_COL_WIDTH;
 
-    if ( instVersionCol() == versionCol() )     // combined column for both versions
+    for ( int row = fromRow; row < toRow; row += step )
     {
-        if (installed)
-            colText = fromUTF8( installed->edition().c_str() );
-        else
-            colText.clear();
+        QTreeWidgetItem * item = topLevelItem( row );
 
-        if ( candidate && ( ! installed || ( candidate->edition() != installed->edition() ) ) )
-        {
-            if (installed)
-                colText += " ";
-            colText += "(" + fromUTF8( candidate->edition().c_str() ) + ")";
-        }
+        if ( ! item )
+            continue;
 
-        colWidth = fontMetrics.boundingRect( colText ).width() + ( STATUS_ICON_SIZE / 2 );
+        int colWidth = fontMetrics.boundingRect( item->text( nameCol() ) ).width() + margin;
+        _bestNameColWidth = qMax( _bestNameColWidth, colWidth );
 
-        if (colWidth > _bestVersionColWidth)
-            _bestVersionColWidth = colWidth;
-    }
-    else // separate columns for both versions
-    {
-        if ( candidate )
-        {
-            colText = fromUTF8( candidate->edition().c_str() );
-            colWidth = fontMetrics.boundingRect( colText ).width() + ( STATUS_ICON_SIZE / 2 );
+        colWidth = fontMetrics.boundingRect( item->text( summaryCol() ) ).width() + margin;
+        _bestSummaryColWidth = qMax( _bestSummaryColWidth, colWidth );
 
-            if (colWidth > _bestVersionColWidth)
-                _bestVersionColWidth = colWidth;
-        }
+        colWidth = fontMetrics.boundingRect( item->text( versionCol() ) ).width() + margin;
+        _bestVersionColWidth = qMax( _bestVersionColWidth, colWidth );
 
-        if ( installed )
+        if ( ! combinedVersionCol )
         {
-            colText = fromUTF8( installed->edition().c_str() );
-            colWidth = fontMetrics.boundingRect( colText ).width() + ( STATUS_ICON_SIZE / 2 );
-
-            if (colWidth > _bestInstVersionColWidth)
-                _bestInstVersionColWidth = colWidth;
+            colWidth = fontMetrics.boundingRect( item->text( instVersionCol() ) ).width() + margin;
+            _bestInstVersionColWidth = qMax( _bestInstVersionColWidth, colWidth );
         }
-    }
 
+        colWidth = fontMetrics.boundingRect( item->text( sizeCol() ) ).width() + margin;
+        _bestSizeColWidth = qMax( _bestSizeColWidth, colWidth );
+    }
 
-    // Size
-
-    colText  = fromUTF8( zyppPkg->installSize().asString().c_str() );
-    colWidth = fontMetrics.boundingRect( colText ).width() + ( STATUS_ICON_SIZE / 2 );
-
-    if ( colWidth > _bestSizeColWidth )
-        _bestSizeColWidth = colWidth;
 
     //
     // Regardless of all the above voodoo, set some reasonable min and max widths.
@@ -255,7 +263,7 @@ YQPkgList::updateBestColWidths( ZyppSel selectable,
     _bestNameColWidth    = qBound( 120, _bestNameColWidth,    280 );
     _bestSummaryColWidth = qBound( 350, _bestSummaryColWidth, 500 );
 
-    if ( instVersionCol() == versionCol() )     // combined column for both versions
+    if ( combinedVersionCol )
     {
         _bestVersionColWidth = qBound( 120, _bestVersionColWidth, 280 );
     }
@@ -352,6 +360,7 @@ YQPkgList::clear()
 {
     YQPkgObjList::clear();
     resetBestColWidths();
+    _firstUnmeasuredRow = 0;
     optimizeColumnWidths();
 }
 
@@ -29,6 +29,7 @@
 
 class QObject;
 class QWidget;
+class YQPkgListItem;
 
 
 /**
@@ -88,10 +89,22 @@ public:
 
 public slots:
 
+    /**
+     * Add a batch of pkgs to the list. Connect a filter's filterMatches()
+     * signal to this slot. Remember to connect filterStart() to clear()
+     * (inherited from QListView).
+     *
+     * The column widths are optimized only once for the complete batch.
+     **/
+    void addPkgItems( const ZyppPkgMatchList & matches );
+
     /**
      * Add a pkg to the list. Connect a filter's filterMatch() signal to this
      * slot. Remember to connect filterStart() to clear() (inherited from
      * QListView).
+     *
+     * Prefer addPkgItems() for many pkgs. If this is used, the column widths
+     * are optimized only once when control returns to the event loop.
      **/
     void addPkgItem( ZyppSel selectable,
                      ZyppPkg zyppPkg );
@@ -128,6 +141,12 @@ public slots:
      **/
     void resort();
 
+    /**
+     * Update the optimal column widths for the items that were added since
+     * the last call and apply them to the columns.
+     **/
+    void updateColumnWidths();
+
 
 protected slots:
 
@@ -163,13 +182,26 @@ protected:
     void resetBestColWidths();
 
     /**
-     * Set and save optimal column widths depending on content only.
-     *
-     * There is currently no way to get the optimal widths without setting
-     * them, so we have to do it.
+     * Create a list item for a pkg, but don't do anything about the column
+     * widths. Return the new item or 0 if there is no selectable.
+     **/
+    YQPkgListItem * createPkgItem( ZyppSel selectable,
+                                   ZyppPkg zyppPkg,
+                                   bool    dimmed );
+
+    /**
+     * Update the optimal column widths depending on content only: Measure
+     * the texts of a sample of the toplevel items in the range from 'fromRow'
+     * to (excluding) 'toRow'. With many thousands of items, measuring each
+     * one of them would be much too expensive.
      **/
-    void updateBestColWidths( ZyppSel selectable,
-                              ZyppPkg zyppPkg );
+    void updateBestColWidths( int fromRow, int toRow );
+
+    /**
+     * Schedule updateColumnWidths() for when control returns to the event
+     * loop unless that is already pending.
+     **/
+    void scheduleColumnWidthsUpdate();
 
     /**
      * Optimizes the column widths depending on content and the available
@@ -194,6 +226,9 @@ protected:
     int _bestVersionColWidth;
     int _bestInstVersionColWidth;
     int _bestSizeColWidth;
+
+    int  _firstUnmeasuredRow;
+    bool _colWidthsUpdatePending;
 };
 
 
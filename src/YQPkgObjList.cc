@@ -25,6 +25,7 @@
 
 #include <zypp/ZYppFactory.h>
 
+#include "Exception.h"
 #include "LicenseCache.h"
 #include "Logger.h"
 #include "QY2CursorHelper.h"
@@ -843,6 +844,9 @@ YQPkgObjListItem::YQPkgObjListItem( YQPkgObjList * pkgObjList,
     , _pkgObjList( pkgObjList )
     , _selectable( selectable )
     , _zyppObj( zyppObj )
+    , _cellCache( 0 )
+    , _sortKey( 0 )
+    , _explicitTextCols( 0 )
     , _editable( true )
     , _excluded( false )
 {
@@ -858,6 +862,9 @@ YQPkgObjListItem::YQPkgObjListItem( YQPkgObjList *    pkgObjList,
     , _pkgObjList( pkgObjList )
     , _selectable( selectable )
     , _zyppObj( zyppObj )
+    , _cellCache( 0 )
+    , _sortKey( 0 )
+    , _explicitTextCols( 0 )
     , _editable( true )
     , _excluded( false )
 {
@@ -870,7 +877,13 @@ YQPkgObjListItem::YQPkgObjListItem( YQPkgObjList * pkgObjList )
     , _pkgObjList( pkgObjList )
     , _selectable( 0 )
     , _zyppObj( 0 )
+    , _cellCache( 0 )
+    , _sortKey( 0 )
+    , _explicitTextCols( 0 )
     , _editable( true )
+    , _candidateIsNewer( false )
+    , _installedIsNewer( false )
+    , _candidateVersionChanged( false )
     , _excluded( false )
 {
 }
@@ -878,7 +891,8 @@ YQPkgObjListItem::YQPkgObjListItem( YQPkgObjList * pkgObjList )
 
 YQPkgObjListItem::~YQPkgObjListItem()
 {
-    // NOP
+    delete _cellCache;
+    delete _sortKey;
 }
 
 
@@ -888,8 +902,12 @@ YQPkgObjListItem::init()
     if ( _zyppObj == 0 && _selectable )
         _zyppObj = _selectable->theObj();
 
-    _candidateIsNewer   = false;
-    _installedIsNewer   = false;
+    _candidateIsNewer        = false;
+    _installedIsNewer        = false;
+    _candidateVersionChanged = false;
+
+    if ( ! _selectable )
+        return;
 
     const ZyppObj candidate = selectable()->candidateObj();
     const ZyppObj installed = selectable()->installedObj();
@@ -905,117 +923,232 @@ YQPkgObjListItem::init()
     if ( installed && ! candidate )
         _installedIsNewer = true;
 
-    const bool candidateVersionChanged =
+    _candidateVersionChanged =
         candidate && installed && _candidateIsNewer &&
         ( candidate->edition().epoch()   != installed->edition().epoch() ||
           candidate->edition().version() != installed->edition().version() );
+}
 
-    if ( versionCol() >= 0 )
-    {
-        QFont versionFont = font( versionCol() );
-        versionFont.setBold( candidateVersionChanged );
-        setFont( versionCol(), versionFont );
-    }
 
-    if ( instVersionCol() >= 0 && instVersionCol() != versionCol() )
+QVariant
+YQPkgObjListItem::data( int column, int role ) const
+{
+    if ( column < 0 || column >= 32 || ! _selectable || ! _zyppObj )
+        return QY2ListViewItem::data( column, role );
+
+    if ( role == Qt::DisplayRole )
     {
-        QFont instVersionFont = font( instVersionCol() );
-        instVersionFont.setBold( candidateVersionChanged );
-        setFont( instVersionCol(), instVersionFont );
+        if ( _explicitTextCols & ( 1U << column ) )
+            return QY2ListViewItem::data( column, role );
+
+        if ( column == nameCol()        ) return cellCache()->name;
+        if ( column == summaryCol()     ) return cellCache()->summary;
+        if ( column == sizeCol()        ) return cellCache()->size;
+        if ( column == versionCol()     ) return cellCache()->version;
+        if ( column == instVersionCol() ) return cellCache()->instVersion;
+
+        return QY2ListViewItem::data( column, role );
     }
 
-    if ( nameCol()    >= 0 )  setText( nameCol(),     zyppObj()->name()    );
-    if ( summaryCol() >= 0 )  setText( summaryCol(),  zyppObj()->summary() );
+    // Anything that was set explicitly takes precedence
 
-    if ( sizeCol()    >= 0 )
-    {
-        zypp::ByteCount size = zyppObj()->installSize();
+    QVariant value = QY2ListViewItem::data( column, role );
 
-        if ( size > 0L )
-            setText( sizeCol(), size.asString() );
-    }
+    if ( value.isValid() )
+        return value;
 
-    if ( versionCol() == instVersionCol() ) // Display both versions in the same column: 1.2.3 (1.2.4)
+    switch ( role )
     {
-        if ( versionCol() >= 0 )
-        {
-            if ( installed )
+        case Qt::DecorationRole:
+
+            if ( column == statusCol() )
             {
-                if ( zyppObj() != installed  &&
-                     zyppObj() != candidate )
-                {
-                    setText( versionCol(), zyppObj()->edition());
-                }
-                else
+                CellCache * cache = cellCache();
+
+                if ( ! cache->statusIconValid )
                 {
-                    if ( candidate && installed->edition() != candidate->edition() )
-                    {
-                        setText( versionCol(),
-                                 QString( "%1 (%2)" )
-                                 .arg( installed->edition().c_str() )
-                                 .arg( candidate->edition().c_str() ) );
-                    }
-                    else // no candidate or both versions are the same anyway
-                    {
-                        setText( versionCol(), installed->edition() );
-                    }
+                    bool enabled = editable() && _pkgObjList->editable();
+
+                    cache->statusIcon      = _pkgObjList->statusIcon( status(), enabled, bySelection() );
+                    cache->statusIconValid = true;
                 }
+
+                return cache->statusIcon;
             }
-            else
+
+            break;
+
+
+        case Qt::ForegroundRole:
+
+            if ( column == versionCol() || column == instVersionCol() )
+                return cellCache()->versionColor;
+
+            break;
+
+
+        case Qt::FontRole:
+
+            if ( _candidateVersionChanged && treeWidget() &&
+                 ( column == versionCol() || column == instVersionCol() ) )
             {
-                if ( candidate )
-                    setText( versionCol(), QString( "(%1)" ).arg( candidate->edition().c_str() ) );
-                else
-                    setText( versionCol(), zyppObj()->edition() );
+                QFont boldFont = treeWidget()->font();
+                boldFont.setBold( true );
+
+                return boldFont;
             }
 
-            if ( _installedIsNewer )
-                setForeground( versionCol(), redTextColor()  );
-            else if ( _candidateIsNewer )
-                setForeground( versionCol(), blueTextColor() );
-            else
-                setForeground( versionCol(), normalTextColor() );
-        }
+            break;
+
+
+        default:
+            break;
     }
-    else // separate columns for installed and available versions
+
+    return value;
+}
+
+
+void
+YQPkgObjListItem::setData( int column, int role, const QVariant & value )
+{
+    if ( ( role == Qt::DisplayRole || role == Qt::EditRole ) &&
+         column >= 0 && column < 32 )
     {
-        if ( instVersionCol() >= 0 )
-        {
-            if ( installed )
-            {
-                setText( instVersionCol(), installed->edition() );
+        _explicitTextCols |= ( 1U << column );
+    }
+
+    QY2ListViewItem::setData( column, role, value );
+}
+
+
+YQPkgObjListItem::CellCache *
+YQPkgObjListItem::cellCache() const
+{
+    if ( ! _cellCache )
+    {
+        _cellCache = new CellCache();
+        CHECK_NEW( _cellCache );
+    }
+
+    if ( ! _cellCache->textsValid )
+    {
+        _cellCache->name         = fromUTF8( zyppObj()->name()    );
+        _cellCache->summary      = fromUTF8( zyppObj()->summary() );
+        _cellCache->size         = sizeText();
+        _cellCache->version      = versionText();
+        _cellCache->instVersion  = instVersionText();
+        _cellCache->versionColor = versionTextColor();
+        _cellCache->textsValid   = true;
+    }
+
+    return _cellCache;
+}
+
+
+void
+YQPkgObjListItem::invalidateCellCache( bool texts, bool statusIcon )
+{
+    if ( ! _cellCache )
+        return;
+
+    if ( texts )
+        _cellCache->textsValid = false;
+
+    if ( statusIcon )
+        _cellCache->statusIconValid = false;
+
+    emitDataChanged();
+}
 
-                if ( _installedIsNewer )
-                    setForeground( instVersionCol(), redTextColor()  );
-                else if ( _candidateIsNewer )
-                    setForeground( instVersionCol(), blueTextColor() );
-                else
-                    setForeground( versionCol(), normalTextColor() );
-            }
-        }
 
-        if ( versionCol() >= 0 )
+QString
+YQPkgObjListItem::versionText() const
+{
+    if ( ! zyppObj() )
+        return QString();
+
+    const ZyppObj candidate = selectable()->candidateObj();
+    const ZyppObj installed = selectable()->installedObj();
+
+    if ( versionCol() == instVersionCol() ) // Display both versions in the same column: 1.2.3 (1.2.4)
+    {
+        if ( installed )
         {
-            if ( zyppObj() != installed &&
+            if ( zyppObj() != installed  &&
                  zyppObj() != candidate )
             {
-                setText( versionCol(), zyppObj()->edition() );
+                return fromUTF8( zyppObj()->edition().asString() );
             }
-            else if ( candidate )
-            {
-                setText( versionCol(), candidate->edition() );
 
-                if ( _installedIsNewer )
-                    setForeground( versionCol(), redTextColor()  );
-                else if ( _candidateIsNewer )
-                    setForeground( versionCol(), blueTextColor() );
-                else
-                    setForeground( versionCol(), normalTextColor() );
+            if ( candidate && installed->edition() != candidate->edition() )
+            {
+                return QString( "%1 (%2)" )
+                    .arg( installed->edition().c_str() )
+                    .arg( candidate->edition().c_str() );
             }
+
+            // no candidate or both versions are the same anyway
+            return fromUTF8( installed->edition().asString() );
         }
+
+        if ( candidate )
+            return QString( "(%1)" ).arg( candidate->edition().c_str() );
+        else
+            return fromUTF8( zyppObj()->edition().asString() );
     }
+    else // separate columns for installed and available versions
+    {
+        if ( zyppObj() != installed &&
+             zyppObj() != candidate )
+        {
+            return fromUTF8( zyppObj()->edition().asString() );
+        }
 
-    setStatusIcon();
+        if ( candidate )
+            return fromUTF8( candidate->edition().asString() );
+    }
+
+    return QString();
+}
+
+
+QString
+YQPkgObjListItem::instVersionText() const
+{
+    const ZyppObj installed = selectable() ? selectable()->installedObj() : ZyppObj();
+
+    if ( installed )
+        return fromUTF8( installed->edition().asString() );
+
+    return QString();
+}
+
+
+QColor
+YQPkgObjListItem::versionTextColor() const
+{
+    if ( _installedIsNewer )
+        return _pkgObjList->redTextColor();
+    else if ( _candidateIsNewer )
+        return _pkgObjList->blueTextColor();
+    else
+        return _pkgObjList->normalTextColor();
+}
+
+
+QString
+YQPkgObjListItem::sizeText() const
+{
+    if ( ! zyppObj() )
+        return QString();
+
+    zypp::ByteCount size = zyppObj()->installSize();
+
+    if ( size > 0L )
+        return fromUTF8( size.asString() );
+
+    return QString();
 }
 
 
@@ -1023,6 +1156,8 @@ void
 YQPkgObjListItem::updateData()
 {
     init();
+    invalidateSortKey();
+    invalidateCellCache( true, true );
 }
 
 
@@ -1101,7 +1236,16 @@ YQPkgObjListItem::updateStatus()
 void
 YQPkgObjListItem::setStatusIcon()
 {
-    if ( statusCol() >= 0 )
+    invalidateSortKey();
+
+    if ( statusCol() < 0 )
+        return;
+
+    if ( _selectable )
+    {
+        invalidateCellCache( false, true ); // see data()
+    }
+    else // Derived classes with their own status() like YQPkgLangListItem
     {
         bool enabled = editable() && _pkgObjList->editable();
         setIcon( statusCol(), _pkgObjList->statusIcon( status(), enabled, bySelection() ) );
@@ -1354,57 +1498,40 @@ bool YQPkgObjListItem::operator<( const QTreeWidgetItem & otherListViewItem ) co
     const YQPkgObjListItem * other = dynamic_cast<const YQPkgObjListItem *> (&otherListViewItem);
     int col = treeWidget()->sortColumn();
 
-    if ( other )
+    if ( other && this->zyppObj() && other->zyppObj() )
     {
         if ( col == nameCol() )
         {
-            return ( strcasecmp( this->zyppObj()->name().c_str(), other->zyppObj()->name().c_str() ) < 0 );
+            // Case insensitive like strcasecmp()
+            return sortKey( col ).text < other->sortKey( col ).text;
         }
         if ( col == summaryCol() )
         {
             // locale aware sort
-            return ( strcoll( this->zyppObj()->summary().c_str(), other->zyppObj()->summary().c_str() ) < 0 );
+            return sortKey( col ).collatorKey->compare( *other->sortKey( col ).collatorKey ) < 0;
         }
         if ( col == sizeCol() )
         {
             // Numeric sort by size
 
-            return ( this->zyppObj()->installSize() < other->zyppObj()->installSize() );
-        }
-        else if ( col == statusCol() )
-        {
-            // Sorting by status depends on the numeric value of the ZyppStatus
-            // enum, thus it is important to insert new package states there
-            // where they make most sense. We want to show dangerous or
-            // noteworthy states first - e.g., "taboo" which should seldeom
-            // occur, but when it does, it is important.
-
-            bool result = ( this->status() < other->status() );
-            if ( ! result && this->status() == other->status() )
-                result = this->zyppObj()->name() < other->zyppObj()->name();
-            return result;
+            return sortKey( col ).number < other->sortKey( col ).number;
         }
-        else if ( col == instVersionCol() ||
+        else if ( col == statusCol() ||
+                  col == instVersionCol() ||
                   col == versionCol() )
         {
-            // Sorting by version numbers doesn't make too much sense, so let's
-            // sort by package relation:
-            // - Installed newer than candidate (red)
-            // - Candidate newer than installed (blue) - worthwhile updating
-            // - Installed
-            // - Not installed, but candidate available
+            // Status: By the numeric value of the ZyppStatus, then by name.
             //
-            // Within these categories, sort versions by ASCII - OK, it's
-            // pretty random, but predictable.
+            // Versions: By version points (see versionPoints()), then by the
+            // edition as a string. See sortKey().
 
-            int thisPoints  = this->versionPoints();
-            int otherPoints = other->versionPoints();
+            const SortKey & thisKey  = this->sortKey( col );
+            const SortKey & otherKey = other->sortKey( col );
 
-            if (thisPoints == otherPoints )
-                return ( QString (this->zyppObj()->edition().c_str() ) <
-                         QString (other->zyppObj()->edition().c_str() ) );
+            if ( thisKey.number == otherKey.number )
+                return thisKey.text < otherKey.text;
             else
-                return ( thisPoints < otherPoints );
+                return thisKey.number < otherKey.number;
         }
     }
 
@@ -1413,6 +1540,76 @@ bool YQPkgObjListItem::operator<( const QTreeWidgetItem & otherListViewItem ) co
 }
 
 
+const YQPkgObjListItem::SortKey &
+YQPkgObjListItem::sortKey( int column ) const
+{
+    if ( ! _sortKey )
+    {
+        _sortKey = new SortKey();
+        CHECK_NEW( _sortKey );
+    }
+
+    if ( _sortKey->column == column )
+        return *_sortKey;
+
+    SortKey & key = *_sortKey;
+
+    key.column = column;
+    key.number = 0;
+    key.text.clear();
+    key.collatorKey.reset();
+
+    if ( column == nameCol() )
+    {
+        key.text = zyppObj()->name();
+
+        for ( char & c: key.text )
+        {
+            if ( c >= 'A' && c <= 'Z' )
+                c += 'a' - 'A';
+        }
+    }
+    else if ( column == summaryCol() )
+    {
+        static QCollator collator; // Uses the system locale like strcoll()
+
+        key.collatorKey = collator.sortKey( fromUTF8( zyppObj()->summary() ) );
+    }
+    else if ( column == sizeCol() )
+    {
+        key.number = zyppObj()->installSize();
+    }
+    else if ( column == statusCol() )
+    {
+        // Sorting by status depends on the numeric value of the ZyppStatus
+        // enum, thus it is important to insert new package states there
+        // where they make most sense. We want to show dangerous or
+        // noteworthy states first - e.g., "taboo" which should seldeom
+        // occur, but when it does, it is important.
+
+        key.number = status();
+        key.text   = zyppObj()->name();
+    }
+    else if ( column == instVersionCol() || column == versionCol() )
+    {
+        // Sorting by version numbers doesn't make too much sense, so let's
+        // sort by package relation:
+        // - Installed newer than candidate (red)
+        // - Candidate newer than installed (blue) - worthwhile updating
+        // - Installed
+        // - Not installed, but candidate available
+        //
+        // Within these categories, sort versions by ASCII - OK, it's
+        // pretty random, but predictable.
+
+        key.number = versionPoints();
+        key.text   = zyppObj()->edition().asString();
+    }
+
+    return key;
+}
+
+
 int
 YQPkgObjListItem::versionPoints() const
 {
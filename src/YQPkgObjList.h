@@ -17,6 +17,7 @@
 #ifndef YQPkgObjList_h
 #define YQPkgObjList_h
 
+#include <QCollator>
 #include <QColor>
 #include <QPixmap>
 #include <QRegularExpression>
@@ -24,6 +25,7 @@
 #include <QEvent>
 
 #include <list>
+#include <optional>
 #include <string>
 
 #include <zypp/ResTraits.h>
@@ -512,9 +514,39 @@ public:
 
     /**
      * Set a status icon according to the package's status.
+     *
+     * For items with a selectable, this only invalidates the cached status
+     * icon and makes the list repaint the item; see data().
      **/
     virtual void setStatusIcon();
 
+    /**
+     * Return the data for 'column' and 'role'.
+     *
+     * For items with a selectable, the name, summary, size and version
+     * texts, the status icon and the version colors and fonts are not stored
+     * in the item; they are computed from the selectable when they are
+     * needed first, i.e. usually when the item is painted for the first
+     * time. The QTreeWidget only does that for the items in the visible part
+     * of the viewport, so filling a list with many thousands of items is not
+     * much more expensive than allocating the items.
+     *
+     * The results are cached in the item until updateData() or
+     * updateStatus() invalidates them. Anything that a derived class set
+     * explicitly with setText(), setIcon() etc. takes precedence.
+     *
+     * Reimplemented from QTreeWidgetItem.
+     **/
+    virtual QVariant data( int column, int role ) const override;
+
+    /**
+     * Set the data for 'column' and 'role'. This keeps track of the columns
+     * with an explicitly set text so they are not computed in data().
+     *
+     * Reimplemented from QTreeWidgetItem.
+     **/
+    virtual void setData( int column, int role, const QVariant & value ) override;
+
     /**
      * Update this item's status.
      * Triggered by QY2ListView::updateAllItemStates().
@@ -538,6 +570,13 @@ public:
      **/
     bool installedIsNewer() const { return _installedIsNewer; }
 
+    /**
+     * Check if the candidate is newer than the installed version, and the
+     * difference is not only in the release number, but in the epoch or the
+     * upstream version. Such versions are displayed in a bold font.
+     **/
+    bool candidateVersionChanged() const { return _candidateVersionChanged; }
+
     /**
      * Display this item's notify text (if there is any) that corresponds to
      * the specified status (S_Install, S_Del) in a pop-up window.
@@ -564,6 +603,9 @@ public:
     /**
      * Comparison operator for sorting.
      *
+     * This compares precomputed sort keys (see sortKey()), so sorting a
+     * large list doesn't need any libzypp calls for each comparison.
+     *
      * Reimplemented from QY2ListViewItem.
      */
     virtual bool operator< ( const QTreeWidgetItem & other ) const override;
@@ -628,11 +670,96 @@ public:
 protected:
 
     /**
-     * Initialize internal data and set fields accordingly. Only works for items
-     * presenting selectables - see YQPkgObjListItem
+     * Cell contents that are computed on demand; see data().
+     **/
+    struct CellCache
+    {
+        CellCache(): textsValid( false ), statusIconValid( false ) {}
+
+        QString name;
+        QString summary;
+        QString size;
+        QString version;
+        QString instVersion;
+        QColor  versionColor;
+        QPixmap statusIcon;
+        bool    textsValid;
+        bool    statusIconValid;
+    };
+
+    /**
+     * Precomputed key for sorting by one column; see sortKey().
+     **/
+    struct SortKey
+    {
+        SortKey(): column( -1 ), number( 0 ) {}
+
+        int                             column;      // -1: invalid
+        qint64                          number;      // Status, version points, size
+        std::string                     text;        // Name or edition
+        std::optional<QCollatorSortKey> collatorKey; // Summary
+    };
+
+    /**
+     * Return the sort key for 'column'. Compute it if there is none yet or if
+     * the current one is for a different column.
+     **/
+    const SortKey & sortKey( int column ) const;
+
+    /**
+     * Invalidate the sort key, e.g. because the status changed.
+     **/
+    void invalidateSortKey() { if ( _sortKey ) _sortKey->column = -1; }
+
+    /**
+     * Initialize internal data: Determine the zyppObj() if there is none yet
+     * and the version relations between the installed and the candidate
+     * version. Only works for items presenting selectables - see
+     * YQPkgObjListItem.
+     *
+     * This does not set any column texts or icons; see data().
      **/
     void init();
 
+    /**
+     * Return the cell cache with valid texts. Create it if it doesn't exist
+     * yet, and fill it if needed.
+     **/
+    CellCache * cellCache() const;
+
+    /**
+     * Invalidate the cached texts and / or the status icon and make the list
+     * repaint this item. This does nothing if nothing was cached yet since
+     * then the item was never painted.
+     **/
+    void invalidateCellCache( bool texts, bool statusIcon );
+
+    /**
+     * Return the text for the version column. If there is a combined column
+     * for both the installed and the available version, this is something
+     * like "1.2.3 (1.2.4)".
+     **/
+    QString versionText() const;
+
+    /**
+     * Return the text for the installed version column if there is a
+     * separate one.
+     **/
+    QString instVersionText() const;
+
+    /**
+     * Return the text color for the version column(s) depending on the
+     * version relations: Red if the installed version is newer, blue if the
+     * candidate is newer, the normal text color otherwise.
+     **/
+    QColor versionTextColor() const;
+
+    /**
+     * Return the text for the size column or an empty string if the size is
+     * unknown.
+     **/
+    QString sizeText() const;
+
     /**
      * Apply changes hook. This is called each time the user changes the status
      * of a list item manually (if the old status is different from the new
@@ -675,13 +802,17 @@ protected:
     // Data members
     //
 
-    YQPkgObjList * _pkgObjList;
-    ZyppSel        _selectable;
-    ZyppObj        _zyppObj;
-    bool           _editable:1;
-    bool           _candidateIsNewer:1;
-    bool           _installedIsNewer:1;
-    bool           _excluded:1;
+    YQPkgObjList *      _pkgObjList;
+    ZyppSel             _selectable;
+    ZyppObj             _zyppObj;
+    mutable CellCache * _cellCache;          // Only created on demand
+    mutable SortKey *   _sortKey;            // Only created on demand
+    quint32             _explicitTextCols;   // Bit mask of setText() columns
+    bool                _editable:1;
+    bool                _candidateIsNewer:1;
+    bool                _installedIsNewer:1;
+    bool                _candidateVersionChanged:1;
+    bool                _excluded:1;
 };
 
 
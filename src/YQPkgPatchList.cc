@@ -263,6 +263,7 @@ YQPkgPatchList::filter()
 #endif
 
     emit filterStart();
+    ZyppPkgMatchList matches;
 
     if ( selection() )
     {
@@ -280,7 +281,7 @@ YQPkgPatchList::filter()
 
                 if ( zyppPkg )
                 {
-                    emit filterMatch( *it, zyppPkg );
+                    matches << ZyppPkgMatch( *it, zyppPkg );
                 }
             }
         }
@@ -291,6 +292,9 @@ YQPkgPatchList::filter()
 
     }
 
+    if ( ! matches.isEmpty() )
+        emit filterMatches( matches );
+
     emit filterFinished();
 }
 
@@ -104,7 +104,7 @@ public slots:
      * Filter according to the view's rules and current selection.
      * Emits those signals:
      *    filterStart()
-     *    filterMatch() for each pkg that matches the filter
+     *    filterMatches() for the pkgs that match the filter
      *    filterFinished()
      **/
     void filter();
@@ -171,10 +171,11 @@ signals:
     void filterStart();
 
     /**
-     * Emitted during filtering for each pkg that matches the filter.
+     * Emitted during filtering for the pkgs that match the filter.
+     * This may be emitted several times during one filter run, each time
+     * with a batch of matches.
      **/
-    void filterMatch( ZyppSel selectable,
-                      ZyppPkg pkg );
+    void filterMatches( const ZyppPkgMatchList & matches );
 
     /**
      * Emitted when filtering is finished.
@@ -225,6 +225,7 @@ YQPkgPatternList::filter()
 #endif
 
     emit filterStart();
+    ZyppPkgMatchList matches;
 
     if ( selection() )  // The seleted QListViewItem
     {
@@ -249,7 +250,7 @@ YQPkgPatternList::filter()
                         ++installed;
                     ++total;
 
-                    emit filterMatch( *it, zyppPkg );
+                    matches << ZyppPkgMatch( *it, zyppPkg );
                 }
             }
 
@@ -259,6 +260,9 @@ YQPkgPatternList::filter()
         }
     }
 
+    if ( ! matches.isEmpty() )
+        emit filterMatches( matches );
+
     emit filterFinished();
     resizeColumnToContents( _statusCol );
 }
@@ -47,7 +47,7 @@ public:
      * set up).
      *
      * Set 'autoFilter' to 'false' if there is no need to do (expensive)
-     * filtering because the 'filterMatch' signal is not connected anyway.
+     * filtering because the 'filterMatches' signal is not connected anyway.
      **/
     YQPkgPatternList( QWidget * parent,
                       bool      autoFill   = true,
@@ -98,7 +98,7 @@ public slots:
      * Filter according to the view's rules and current selection.
      * Emits those signals:
      *    filterStart()
-     *    filterMatch() for each pkg that matches the filter
+     *    filterMatches() for the pkgs that match the filter
      *    filterFinished()
      **/
     void filter();
@@ -152,10 +152,11 @@ signals:
     void filterStart();
 
     /**
-     * Emitted during filtering for each pkg that matches the filter.
+     * Emitted during filtering for the pkgs that match the filter.
+     * This may be emitted several times during one filter run, each time
+     * with a batch of matches.
      **/
-    void filterMatch( ZyppSel selectable,
-                      ZyppPkg pkg );
+    void filterMatches( const ZyppPkgMatchList & matches );
 
     /**
      * Emitted when filtering is finished.
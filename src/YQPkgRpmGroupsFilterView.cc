@@ -148,6 +148,7 @@ YQPkgRpmGroupsFilterView::filter()
 {
     emit filterStart();
     logDebug() << "Filtering packages for RPM group \"" << selectedRpmGroup() << "\"" << endl;
+    _matches.clear();
 
     if ( selection() )
     {
@@ -161,7 +162,7 @@ YQPkgRpmGroupsFilterView::filter()
             // RPM group, so let's check both the installed version (if there
             // is any) and the candidate version.
             //
-            // Make sure we emit only one filterMatch() signal if both exist
+            // Make sure we report only one match if both exist
             // and both are in the same RPM group. We don't want multiple list
             // entries for the same package!
 
@@ -179,6 +180,10 @@ YQPkgRpmGroupsFilterView::filter()
         }
     }
 
+    if ( ! _matches.isEmpty() )
+        emit filterMatches( _matches );
+
+    _matches.clear();
     emit filterFinished();
 }
 
@@ -216,7 +221,7 @@ YQPkgRpmGroupsFilterView::check( ZyppSel selectable,
     if ( pkg->group() == selectedRpmGroup() ||                  // full match?
          pkg->group().find( selectedRpmGroup() + "/" ) == 0 )   // starts with selected?
     {
-        emit filterMatch( selectable, pkg );
+        _matches << ZyppPkgMatch( selectable, pkg );
         return true;
     }
 
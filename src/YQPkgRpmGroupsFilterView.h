@@ -49,7 +49,8 @@ public:
     YQPkgRpmGroupItem * selection() const;
 
     /**
-     * Check if 'pkg' matches the selected RPM group.
+     * Check if 'pkg' matches the selected RPM group and add it to the matches
+     * of the current filter run if it does.
      * Returns true if there is a match, false otherwise.
      **/
     bool check( ZyppSel selectable,
@@ -73,7 +74,7 @@ public slots:
      * Filter according to the view's rules and current selection.
      * Emits those signals:
      *    filterStart()
-     *    filterMatch() for each pkg that matches the filter
+     *    filterMatches() for the pkgs that match the filter
      *    filterFinished()
      **/
     void filter();
@@ -107,10 +108,11 @@ signals:
     void filterStart();
 
     /**
-     * Emitted during filtering for each pkg that matches the filter.
+     * Emitted during filtering for the pkgs that match the filter.
+     * This may be emitted several times during one filter run, each time
+     * with a batch of matches.
      **/
-    void filterMatch( ZyppSel selectable,
-                      ZyppPkg pkg         );
+    void filterMatches( const ZyppPkgMatchList & matches );
 
     /**
      * Emitted when filtering is finished.
@@ -160,8 +162,9 @@ protected:
     // Data members
     //
 
-    std::string _selectedRpmGroup;
-    bool        _lazyTreeInitDone;
+    std::string      _selectedRpmGroup;
+    bool             _lazyTreeInitDone;
+    ZyppPkgMatchList _matches;
 
     static YRpmGroupsTree * _rpmGroupsTree;
     static int              _unspecifiedCount;
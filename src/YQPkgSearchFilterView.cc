@@ -25,11 +25,15 @@
 #include <QMessageBox>
 #include <QPushButton>
 #include <QSettings>
+#include <QTimer>
 
 #include <zypp/PoolQuery.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/base/StrMatcher.h>
 
 #include "Exception.h"
 #include "Logger.h"
+#include "PkgSearchIndex.h"
 #include "SearchFilter.h"
 #include "YQi18n.h"
 #include "utf8.h"
@@ -41,20 +45,270 @@
 #  define VERBOSE_FILTER_VIEWS  0
 #endif
 
+#define QUERY_SLICE_MILLISEC        30
+#define TYPING_DELAY_MILLISEC      300
+
 
 using std::string;
 
 
+namespace
+{
+
+/**
+ * One part of a package query: It delivers the matching selectables one by
+ * one so it can be continued in the next time slice.
+ **/
+class QueryPart
+{
+public:
+
+    virtual ~QueryPart() {}
+
+    /**
+     * Return 'true' if there are no more results.
+     **/
+    virtual bool atEnd() const = 0;
+
+    /**
+     * Advance to the next result. Return the selectable if it matches or 0
+     * if it doesn't.
+     **/
+    virtual ZyppSel next() = 0;
+
+    /**
+     * Return a short description of this part for the log.
+     **/
+    virtual QString name() const = 0;
+};
+
+
+/**
+ * Query part for a zypp::PoolQuery, usually restricted to one repo.
+ * libzypp iterates over the query results lazily.
+ **/
+class PoolQueryPart: public QueryPart
+{
+public:
+
+    PoolQueryPart( const zypp::PoolQuery & query, const QString & name )
+        : _query( query )
+        , _it( _query.selectableBegin() )
+        , _end( _query.selectableEnd() )
+        , _name( name )
+        {}
+
+    virtual bool    atEnd() const override { return _it == _end; }
+    virtual ZyppSel next()        override { return *_it++; }
+    virtual QString name()  const override { return _name; }
+
+protected:
+
+    zypp::PoolQuery                      _query;
+    zypp::PoolQuery::Selectable_iterator _it;
+    zypp::PoolQuery::Selectable_iterator _end;
+    QString                              _name;
+};
+
+
+/**
+ * Query part that checks only the candidates from the PkgSearchIndex against
+ * a zypp::StrMatcher in the name, summary and / or description.
+ **/
+class IndexQueryPart: public QueryPart
+{
+public:
+
+    IndexQueryPart( const QList<ZyppSel>   & candidates,
+                    const zypp::StrMatcher & matcher,
+                    bool                     inName,
+                    bool                     inSummary,
+                    bool                     inDescription )
+        : _candidates( candidates )
+        , _nextCandidate( 0 )
+        , _matcher( matcher )
+        , _inName( inName )
+        , _inSummary( inSummary )
+        , _inDescription( inDescription )
+        {}
+
+    virtual bool atEnd() const override
+        { return _nextCandidate >= _candidates.size(); }
+
+    virtual ZyppSel next() override
+    {
+        ZyppSel selectable = _candidates.at( _nextCandidate++ );
+
+        for ( zypp::ui::Selectable::installed_iterator it = selectable->installedBegin();
+              it != selectable->installedEnd();
+              ++it )
+        {
+            if ( matches( it->resolvable() ) )
+                return selectable;
+        }
+
+        for ( zypp::ui::Selectable::available_iterator it = selectable->availableBegin();
+              it != selectable->availableEnd();
+              ++it )
+        {
+            if ( matches( it->resolvable() ) )
+                return selectable;
+        }
+
+        return ZyppSel();
+    }
+
+    virtual QString name() const override
+        { return "Search index"; }
+
+protected:
+
+    bool matches( ZyppObj zyppObj ) const
+    {
+        // The same texts as in the index and in a PoolQuery
+
+        return ( _inName        && _matcher( PkgSearchIndex::name       ( zyppObj ) ) ) ||
+               ( _inSummary     && _matcher( PkgSearchIndex::summary    ( zyppObj ) ) ) ||
+               ( _inDescription && _matcher( PkgSearchIndex::description( zyppObj ) ) );
+    }
+
+    QList<ZyppSel>   _candidates;
+    int              _nextCandidate;
+    zypp::StrMatcher _matcher;
+    bool             _inName;
+    bool             _inSummary;
+    bool             _inDescription;
+};
+
+}   // namespace
+
+
+/**
+ * A package query that is executed in small time slices: A number of query
+ * parts that are processed one after another, and the current position in
+ * them. A package that matches in several parts is only delivered once.
+ *
+ * The parts are the candidates from the search index (if it can narrow down
+ * the search) and one PoolQuery for all the other attributes for each repo,
+ * the installed packages first. Each of those PoolQueries only iterates over
+ * the solvables of its repo, so together they are still one pass over the
+ * pool. Don't split a PoolQuery into one per attribute; each one would be a
+ * complete pass over the pool.
+ *
+ * The time spent in each part and its number of new matches are logged so
+ * the parts can be compared.
+ *
+ * This intentionally runs in the GUI thread, and the parts are not executed
+ * in parallel: libzypp and libsolv are not thread-safe. libsolv even loads
+ * parts of the repo data like file lists on demand into a shared page cache
+ * while a query runs, and the package list reads from the same pool all the
+ * time.
+ **/
+class YQPkgSearchFilterView::QueryRun
+{
+public:
+
+    QueryRun()
+        : matchCount( 0 )
+        , _currentPart( 0 )
+        , _partNanosec( 0 )
+        , _partMatches( 0 )
+        {}
+
+    ~QueryRun() { qDeleteAll( _parts ); }
+
+    /**
+     * Add a query part. This takes over ownership of 'part'.
+     * Add the fastest parts first so their results appear first.
+     **/
+    void addPart( QueryPart * part ) { _parts << part; }
+
+    /**
+     * Return 'true' if there are no more results in any part.
+     **/
+    bool atEnd()
+    {
+        while ( _currentPart < _parts.size() && _parts.at( _currentPart )->atEnd() )
+        {
+            logPartTiming();
+            ++_currentPart;
+        }
+
+        return _currentPart >= _parts.size();
+    }
+
+    /**
+     * Advance to the next result. Return the selectable if it matches and if
+     * it was not delivered before, 0 otherwise.
+     **/
+    ZyppSel next()
+    {
+        if ( atEnd() )
+            return ZyppSel();
+
+        QElapsedTimer timer;
+        timer.start();
+
+        ZyppSel selectable = _parts.at( _currentPart )->next();
+        _partNanosec += timer.nsecsElapsed();
+
+        if ( ! selectable || contains( _delivered, selectable ) )
+            return ZyppSel();
+
+        _delivered.insert( selectable );
+        _partMatches++;
+
+        return selectable;
+    }
+
+    int matchCount;
+
+protected:
+
+    /**
+     * Log the time spent in the current part and its new matches, and
+     * reset the counters for the next part.
+     **/
+    void logPartTiming()
+    {
+        logDebug() << "Query part " << _parts.at( _currentPart )->name()
+                   << ": " << _partMatches << " new matches in "
+                   << _partNanosec / 1000000.0 << " millisec" << endl;
+
+        _partNanosec = 0;
+        _partMatches = 0;
+    }
+
+    QList<QueryPart *> _parts;
+    int                _currentPart;
+    std::set<ZyppSel>  _delivered;
+    qint64             _partNanosec;
+    int                _partMatches;
+};
+
+
 YQPkgSearchFilterView::YQPkgSearchFilterView( QWidget * parent, SearchFields searchFields )
     : QWidget( parent )
     , _ui( new Ui::SearchFilterView )
     , _searchFields( searchFields )
     , _defaultAutoMode( SearchFilter::StartsWith )
+    , _queryRun( 0 )
+    , _overrideExcludeRuleDevel( false )
+    , _overrideExcludeRuleDebugInfo( false )
 {
     CHECK_NEW( _ui );
     _ui->setupUi( this ); // Actually create the widgets from the .ui form
     _ui->searchText->installEventFilter( this );
 
+    _querySliceTimer = new QTimer( this );
+    CHECK_NEW( _querySliceTimer );
+    _querySliceTimer->setInterval( 0 );     // Whenever the event loop is idle
+
+    _typingTimer = new QTimer( this );
+    CHECK_NEW( _typingTimer );
+    _typingTimer->setSingleShot( true );
+    _typingTimer->setInterval( TYPING_DELAY_MILLISEC );
+
     // See ui_search-filter-view.h in the build/ tree for the widget names.
     //
     // That header is generated by Qt's uic (user interface compiler)
@@ -86,6 +340,15 @@ YQPkgSearchFilterView::YQPkgSearchFilterView( QWidget * parent, SearchFields sea
     connect( _ui->changeAutoDefaultButton, SIGNAL( clicked()                 ),
              this,                         SLOT  ( cycleDefaultFilterModes() ) );
 
+    connect( _ui->searchText,   SIGNAL( textEdited      ( QString ) ),
+             this,              SLOT  ( searchTextEdited( QString ) ) );
+
+    connect( _typingTimer,      SIGNAL( timeout() ),
+             this,              SLOT  ( filter()  ) );
+
+    connect( _querySliceTimer,  SIGNAL( timeout()           ),
+             this,              SLOT  ( processQuerySlice() ) );
+
     readSettings();
     updateDetectedFilterMode();
 }
@@ -93,6 +356,14 @@ YQPkgSearchFilterView::YQPkgSearchFilterView( QWidget * parent, SearchFields sea
 
 YQPkgSearchFilterView::~YQPkgSearchFilterView()
 {
+    // Not using cancelQuery() here: Don't touch the parent widgets during
+    // destruction.
+
+    _querySliceTimer->stop();
+    delete _queryRun;
+    _queryRun = 0;
+
+    restoreExcludeRules();
     writeSettings();
     delete _ui;
 }
@@ -211,6 +482,24 @@ YQPkgSearchFilterView::cycleDefaultFilterModes()
 }
 
 
+void
+YQPkgSearchFilterView::searchTextEdited( const QString & text )
+{
+    Q_UNUSED( text );
+
+    if ( ! _ui->searchAsYouType->isChecked() )
+        return;
+
+    // Any query that is still running is obsolete now
+
+    cancelQuery();
+
+    // Start a new one only when the user stops typing for a moment
+
+    _typingTimer->start();
+}
+
+
 void
 YQPkgSearchFilterView::keyPressEvent( QKeyEvent * event )
 {
@@ -248,14 +537,22 @@ YQPkgSearchFilterView::showFilter( QWidget * newFilter )
         filter();
         _ui->searchText->setFocus();
     }
+    else
+    {
+        // Another filter view is now feeding the package list
+
+        _typingTimer->stop();
+        cancelQuery();
+    }
 }
 
 
 void
 YQPkgSearchFilterView::filter()
 {
-    bool overrideExcludeRuleDevel     = false;
-    bool overrideExcludeRuleDebugInfo = false;
+    _typingTimer->stop();
+    cancelQuery();
+
     QString searchText = _ui->searchText->text().toLower();
 
     if ( searchText.contains( "-devel" ) )
@@ -268,7 +565,7 @@ YQPkgSearchFilterView::filter()
             logInfo() << "Overriding -devel exclude rule" << endl;
 
             excludeRule->overrideEnabled( false );
-            overrideExcludeRuleDevel = true;
+            _overrideExcludeRuleDevel = true;
         }
     }
 
@@ -284,23 +581,32 @@ YQPkgSearchFilterView::filter()
             logInfo() << "Overriding -debuginfo / -debugsource exclude rule" << endl;
 
             excludeRule->overrideEnabled( false );
-            overrideExcludeRuleDebugInfo = true;
+            _overrideExcludeRuleDebugInfo = true;
         }
     }
 
     ensureOneSearchCheckBoxIsActive();
     filterInternal();
 
-    if ( overrideExcludeRuleDevel )
+    // The exclude rules are restored in finishQuery() or cancelQuery()
+}
+
+
+void
+YQPkgSearchFilterView::restoreExcludeRules()
+{
+    if ( _overrideExcludeRuleDevel )
     {
         logInfo() << "Restoring -devel exclude rule" << endl;
         YQPkgSelector::instance()->excludeRuleDevelPkgs()->restoreEnabled();
+        _overrideExcludeRuleDevel = false;
     }
 
-    if ( overrideExcludeRuleDebugInfo )
+    if ( _overrideExcludeRuleDebugInfo )
     {
         logDebug() << "Restoring -debuginfo / -debugsource exclude rule" << endl;
         YQPkgSelector::instance()->excludeRuleDebugInfoPkgs()->restoreEnabled();
+        _overrideExcludeRuleDebugInfo = false;
     }
 }
 
@@ -335,145 +641,312 @@ YQPkgSearchFilterView::filterInternal()
 #endif
 
     emit filterStart();
-    int matchCount = 0;
+
+    if ( _ui->searchText->text().isEmpty() )
+    {
+        finishQuery();
+        return;
+    }
+
+    if ( _searchFields == BasicSearchFields )
+    {
+        // Only used as a secondary filter: The primary filter view did all
+        // the work in its filterStart() slot, and it only uses check().
+        // Nobody would use the results of a query.
+
+        finishQuery();
+        return;
+    }
 
     try
     {
-        if ( ! _ui->searchText->text().isEmpty() )
+        //
+        // Build the query
+        //
+
+        SearchFilter searchFilter( buildSearchFilterFromWidgets() );
+
+        // Use a zypp::PoolQuery for improved performance
+        zypp::PoolQuery query;
+        query.addKind( zypp::ResKind::package );
+        string searchPattern = toUTF8( searchFilter.pattern() );
+        query.setCaseSensitive( searchFilter.isCaseSensitive() );
+        zypp::Match::Mode matchMode = zypp::Match::SUBSTRING;
+
+        switch ( searchFilter.filterMode() )
         {
-            //
-            // Build the query
-            //
+            case SearchFilter::Contains:
+                query.setMatchSubstring();
+                break;
+
+            case SearchFilter::StartsWith:
+                query.setMatchRegex();
+                matchMode     = zypp::Match::REGEX;
+                searchPattern = "^" + searchPattern;
+                break;
+
+            case SearchFilter::ExactMatch:
+                query.setMatchExact();
+                matchMode = zypp::Match::STRING;
+                break;
+
+            case SearchFilter::Wildcard:
+                query.setMatchGlob();
+                matchMode = zypp::Match::GLOB;
+                break;
+
+            case SearchFilter::RegExp:
+                query.setMatchRegex();
+                matchMode = zypp::Match::REGEX;
+                break;
+
+            default:
+                logError() << "Unexpected search mode "
+                           << SearchFilter::toString( searchFilter.filterMode() )
+                           << " - falling back to 'Contains'"
+                           << endl;
+                query.setMatchSubstring();
+                break;
+        }
 
-            SearchFilter searchFilter( buildSearchFilterFromWidgets() );
+        query.addString( searchPattern );
 
-            // Use a zypp::PoolQuery for improved performance
-            zypp::PoolQuery query;
-            query.addKind( zypp::ResKind::package );
-            string searchPattern = toUTF8( searchFilter.pattern() );
-            query.setCaseSensitive( searchFilter.isCaseSensitive() );
+        //
+        // The query is processed in small time slices from the event loop in
+        // processQuerySlice(), so the UI remains responsive, and the user can
+        // change the search text (which cancels this query) while it is still
+        // running.
+        //
+        // If the search index can narrow down the name / summary /
+        // description search, that is a part of its own that comes first so
+        // its results appear immediately. All other attributes are searched
+        // by one PoolQuery for each repo, the installed packages first. See
+        // also class QueryRun.
+        //
 
-            switch ( searchFilter.filterMode() )
-            {
-                case SearchFilter::Contains:
-                    query.setMatchSubstring();
-                    break;
-
-                case SearchFilter::StartsWith:
-                    query.setMatchRegex();
-                    searchPattern = "^" + searchPattern;
-                    break;
-
-                case SearchFilter::ExactMatch:
-                    query.setMatchExact();
-                    break;
-
-                case SearchFilter::Wildcard:
-                    query.setMatchGlob();
-                    break;
-
-                case SearchFilter::RegExp:
-                    query.setMatchRegex();
-                    break;
-
-                default:
-                    logError() << "Unexpected search mode "
-                               << SearchFilter::toString( searchFilter.filterMode() )
-                               << " - falling back to 'Contains'"
-                               << endl;
-                    query.setMatchSubstring();
-                    break;
-            }
+        _queryRun = new QueryRun();
+        CHECK_NEW( _queryRun );
+
+        bool inName        = _ui->searchInName->isChecked();
+        bool inSummary     = _ui->searchInSummary->isChecked();
+        bool inDescription = _ui->searchInDescription->isChecked();
 
-            query.addString( searchPattern );
+        QList<zypp::sat::SolvAttr> attributes;
 
-            if ( _ui->searchInName->isChecked()        ) query.addAttribute( zypp::sat::SolvAttr::name );
-            if ( _ui->searchInDescription->isChecked() ) query.addAttribute( zypp::sat::SolvAttr::description );
-            if ( _ui->searchInSummary->isChecked()     ) query.addAttribute( zypp::sat::SolvAttr::summary );
+        if ( inName || inSummary || inDescription )
+        {
+            PkgSearchIndex * searchIndex = PkgSearchIndex::instance();
 
-            if ( _searchFields == AllSearchFields )
+            // The index is built in the background after the repos are
+            // loaded. Until it is ready, this is a normal PoolQuery.
+
+            if ( searchIndex->canNarrow( searchFilter ) && searchIndex->isValid() )
             {
-                if ( _ui->searchInRequires->isChecked()   ) query.addAttribute( zypp::sat::SolvAttr( "solvable:requires" ) );
-                if ( _ui->searchInRecommends->isChecked() ) query.addAttribute( zypp::sat::SolvAttr( "solvable:recommends" ) );
-                if ( _ui->searchInProvides->isChecked()   ) query.addAttribute( zypp::sat::SolvAttr( "solvable:provides" ) );
-                if ( _ui->searchInFileList->isChecked()   ) query.addAttribute( zypp::sat::SolvAttr::filelist );
-            }
+                // Only check the packages that have all the trigrams of the
+                // search pattern with the same matching as the query would
+
+                zypp::Match matchFlags( matchMode );
 
-            _ui->searchText->setEnabled( false );   // Disable for the duration of the search
-            _ui->searchButton->setEnabled( false );
+                if ( ! searchFilter.isCaseSensitive() )
+                    matchFlags |= zypp::Match::NOCASE;
 
-            QElapsedTimer queryTimer;
-            queryTimer.start();
+                QList<ZyppSel> candidates = searchIndex->candidates( searchFilter );
 
-            //
-            // Start the query and iterate over the results
-            //
+                logDebug() << candidates.size() << " candidates from the search index" << endl;
 
-            for ( zypp::PoolQuery::Selectable_iterator it = query.selectableBegin();
-                  it != query.selectableEnd();
-                  ++it )
+                _queryRun->addPart( new IndexQueryPart( candidates,
+                                                        zypp::StrMatcher( searchPattern, matchFlags ),
+                                                        inName, inSummary, inDescription ) );
+            }
+            else
             {
-                ZyppSel selectable = *it;
-                ZyppPkg zyppPkg    = tryCastToZyppPkg( selectable->theObj() );
-
-                if ( zyppPkg )
-                {
-                    matchCount++;
-                    emit filterMatch( selectable, zyppPkg );
-                }
-
-
-                if ( queryTimer.elapsed() > 300 ) // milisec
-                {
-                    // Process events only every 300 milliseconds - this is very
-                    // expensive since both the progress dialog and the package
-                    // list change all the time, thus display updates are necessary
-                    // each time.
-
-                    qApp->processEvents();
-                    queryTimer.restart();
-                }
+                if ( inName        ) attributes << zypp::sat::SolvAttr::name;
+                if ( inDescription ) attributes << zypp::sat::SolvAttr::description;
+                if ( inSummary     ) attributes << zypp::sat::SolvAttr::summary;
             }
+        }
 
-            if ( matchCount == 0 )
-                emit message( _( "No Results." ) );
+        if ( _searchFields == AllSearchFields )
+        {
+            if ( _ui->searchInRequires->isChecked()   ) attributes << zypp::sat::SolvAttr( "solvable:requires" );
+            if ( _ui->searchInRecommends->isChecked() ) attributes << zypp::sat::SolvAttr( "solvable:recommends" );
+            if ( _ui->searchInProvides->isChecked()   ) attributes << zypp::sat::SolvAttr( "solvable:provides" );
+            if ( _ui->searchInFileList->isChecked()   ) attributes << zypp::sat::SolvAttr::filelist;
+        }
+
+        if ( ! attributes.isEmpty() )
+        {
+            for ( const zypp::sat::SolvAttr & attribute: attributes )
+                query.addAttribute( attribute );
+
+            addRepoQueryParts( query );
         }
     }
     catch ( const std::exception & exception )
     {
-        logWarning() << "CAUGHT zypp exception: " << exception.what() << endl;
+        delete _queryRun;
+        _queryRun = 0;
+
+        showQueryError( exception );
+        finishQuery();
+        return;
+    }
+
+    _querySliceTimer->start();
+}
+
+
+void
+YQPkgSearchFilterView::addRepoQueryParts( const zypp::PoolQuery & query )
+{
+    // The installed packages first: Users mostly look for those, and the
+    // system repo tends to be the smallest one.
+
+    QList<zypp::sat::Repository> repos;
+    zypp::sat::Pool satPool = zypp::sat::Pool::instance();
+
+    for ( zypp::sat::Pool::RepositoryIterator it = satPool.reposBegin();
+          it != satPool.reposEnd();
+          ++it )
+    {
+        if ( it->isSystemRepo() )
+            repos.prepend( *it );
+        else
+            repos.append( *it );
+    }
 
-        QMessageBox msgBox;
+    for ( const zypp::sat::Repository & repo: repos )
+    {
+        zypp::PoolQuery repoQuery( query );
+        repoQuery.addRepo( repo.alias() );
 
-        // Translators: This is a (short) text indicating that something went
-        // wrong while searching for packages. At this point, it is not clear
-        // if it's a user error (e.g., syntax error in regular expression) or
-        // an internal error. But there is a "Details" button that will return
-        // the original (translated) error message.
+        _queryRun->addPart( new PoolQueryPart( repoQuery, fromUTF8( repo.alias() ) ) );
+    }
+}
 
-        QString heading = _( "Query Error" );
 
-        if ( heading.length() < 25 )    // Avoid very narrow message boxes
+void
+YQPkgSearchFilterView::processQuerySlice()
+{
+    if ( ! _queryRun )
+    {
+        _querySliceTimer->stop();
+        return;
+    }
+
+    QElapsedTimer    sliceTimer;
+    ZyppPkgMatchList matches;
+    sliceTimer.start();
+
+    try
+    {
+        while ( ! _queryRun->atEnd() &&
+                ! sliceTimer.hasExpired( QUERY_SLICE_MILLISEC ) )
         {
-            QString blanks;
-            blanks.fill( ' ', 50 - heading.length() );
-            heading += blanks;
+            ZyppSel selectable = _queryRun->next();
+
+            if ( ! selectable )
+                continue;
+
+            ZyppPkg zyppPkg = tryCastToZyppPkg( selectable->theObj() );
+
+            if ( zyppPkg )
+            {
+                _queryRun->matchCount++;
+                matches << ZyppPkgMatch( selectable, zyppPkg );
+            }
         }
+    }
+    catch ( const std::exception & exception )
+    {
+        if ( ! matches.isEmpty() )
+            emit filterMatches( matches );
 
-        msgBox.setText( heading );
-        msgBox.setIcon( QMessageBox::Warning );
-        msgBox.setInformativeText( fromUTF8( exception.what() ) );
-        msgBox.exec();
+        showQueryError( exception );
+        finishQuery();
+        return;
     }
 
-    _ui->searchText->setEnabled(true);   // Re-enable the widgets we disabled earlier
-    _ui->searchButton->setEnabled(true);
+    if ( ! matches.isEmpty() )
+        emit filterMatches( matches );
+
+    if ( _queryRun && _queryRun->atEnd() )
+        finishQuery();
+}
+
+
+void
+YQPkgSearchFilterView::finishQuery()
+{
+    _querySliceTimer->stop();
+
+    if ( _queryRun )
+    {
+        if ( _queryRun->matchCount == 0 )
+            emit message( _( "No Results." ) );
+
+        delete _queryRun;
+        _queryRun = 0;
+    }
+
+    restoreExcludeRules();
     parentWidget()->parentWidget()->setCursor( Qt::ArrowCursor );
 
     emit filterFinished();
 }
 
 
+void
+YQPkgSearchFilterView::cancelQuery()
+{
+    if ( ! _queryRun )
+        return;
+
+    logDebug() << "Cancelling query after "
+               << _queryRun->matchCount << " matches" << endl;
+
+    _querySliceTimer->stop();
+
+    delete _queryRun;
+    _queryRun = 0;
+
+    // Only the local cleanup, no filterFinished(): Another filter view might
+    // already be filling the package list.
+
+    restoreExcludeRules();
+    parentWidget()->parentWidget()->setCursor( Qt::ArrowCursor );
+}
+
+
+void
+YQPkgSearchFilterView::showQueryError( const std::exception & exception )
+{
+    logWarning() << "CAUGHT zypp exception: " << exception.what() << endl;
+
+    QMessageBox msgBox;
+
+    // Translators: This is a (short) text indicating that something went
+    // wrong while searching for packages. At this point, it is not clear
+    // if it's a user error (e.g., syntax error in regular expression) or
+    // an internal error. But there is a "Details" button that will return
+    // the original (translated) error message.
+
+    QString heading = _( "Query Error" );
+
+    if ( heading.length() < 25 )    // Avoid very narrow message boxes
+    {
+        QString blanks;
+        blanks.fill( ' ', 50 - heading.length() );
+        heading += blanks;
+    }
+
+    msgBox.setText( heading );
+    msgBox.setIcon( QMessageBox::Warning );
+    msgBox.setInformativeText( fromUTF8( exception.what() ) );
+    msgBox.exec();
+}
+
+
 bool
 YQPkgSearchFilterView::check( ZyppSel   selectable,
                               ZyppObj   zyppObj )
@@ -527,6 +1000,7 @@ void YQPkgSearchFilterView::readSettings()
     _ui->searchInFileList->setChecked    ( settings.value( "searchInFileList",    false  ).toBool() );
 
     _ui->caseSensitive->setChecked       ( settings.value( "caseSensitive",       false  ).toBool() );
+    _ui->searchAsYouType->setChecked     ( settings.value( "searchAsYouType",     false  ).toBool() );
     _ui->searchMode->setCurrentIndex     ( settings.value( "searchMode",          0      ).toInt() );
     _defaultAutoMode = (SearchFilter::FilterMode) ( settings.value( "defaultAutoMode", 2 ).toInt() );
 
@@ -547,6 +1021,7 @@ void YQPkgSearchFilterView::writeSettings()
     settings.setValue( "searchInFileList",    _ui->searchInFileList->isChecked()    );
 
     settings.setValue( "caseSensitive",       _ui->caseSensitive->isChecked()       );
+    settings.setValue( "searchAsYouType",     _ui->searchAsYouType->isChecked()     );
     settings.setValue( "searchMode",          _ui->searchMode->currentIndex()       );
     settings.setValue( "defaultAutoMode",     (int) _defaultAutoMode                );
 
@@ -21,6 +21,7 @@
 #include <QWidget>
 #include <QEvent>
 #include <QWidget>
+#include <zypp/PoolQuery.h>
 
 #include "SearchFilter.h"
 
@@ -37,6 +38,7 @@ class QComboBox;
 class QCheckBox;
 class QPushButton;
 class QRadioButton;
+class QTimer;
 
 
 /**
@@ -50,7 +52,8 @@ public:
     enum SearchFields
     {
         AllSearchFields,
-        BasicSearchFields  // Only name, summary, description
+        BasicSearchFields  // Only name, summary, description;
+                           // used as a secondary filter only with check()
     };
 
 
@@ -84,11 +87,23 @@ public slots:
      * Filter according to the view's rules and current selection.
      * Emits those signals:
      *    filterStart()
-     *    filterMatch() for each pkg that matches the filter
+     *    filterMatches() for the pkgs that match the filter
      *    filterFinished()
+     *
+     * The query is executed in small time slices from the event loop, so
+     * filterMatches() and filterFinished() are emitted only after this
+     * returns. A query that is still running is cancelled first.
      **/
     void filter();
 
+    /**
+     * Cancel the search query that is currently running (if there is any):
+     * Restore the exclude rules and the normal cursor. Unlike a complete
+     * query, this does not emit filterFinished(): The package list might
+     * already be filled by another filter view.
+     **/
+    void cancelQuery();
+
     /**
      * Check if 'searchFilter' matches a zypp capabilites container 'capSet'
      * such as its 'provides()' or 'requires()'.
@@ -126,6 +141,20 @@ protected slots:
      **/
     void cycleDefaultFilterModes();
 
+    /**
+     * Notification that the user edited the search text: In "search as you
+     * type" mode, cancel any running query and (re-)start the timer to start
+     * a new one when the user stops typing for a moment.
+     **/
+    void searchTextEdited( const QString & text );
+
+    /**
+     * Process the results of the running query for a few milliseconds and
+     * emit them as one batch with filterMatches(). Finish the query if there
+     * are no more results.
+     **/
+    void processQuerySlice();
+
 
 signals:
 
@@ -136,10 +165,11 @@ signals:
     void filterStart();
 
     /**
-     * Emitted during filtering for each pkg that matches the filter.
+     * Emitted during filtering for the pkgs that match the filter.
+     * This may be emitted several times during one filter run, each time
+     * with a batch of matches.
      **/
-    void filterMatch( ZyppSel selectable,
-                      ZyppPkg pkg );
+    void filterMatches( const ZyppPkgMatchList & matches );
 
     /**
      * Emitted when filtering is finished.
@@ -154,11 +184,36 @@ signals:
 
 protected:
 
+    class QueryRun;
+
     /**
-     * The filtering without overriding and restoring any exclude rules.
+     * The filtering without overriding and restoring any exclude rules:
+     * Build the query from the widgets and start it.
      **/
     void filterInternal();
 
+    /**
+     * Clean up after the running query has delivered all its results:
+     * Restore the exclude rules and emit filterFinished().
+     **/
+    void finishQuery();
+
+    /**
+     * Add one query part for each repo to the running query that searches
+     * with a copy of 'query' in that repo.
+     **/
+    void addRepoQueryParts( const zypp::PoolQuery & query );
+
+    /**
+     * Restore the exclude rules that were overridden for this query.
+     **/
+    void restoreExcludeRules();
+
+    /**
+     * Show a message box for a query error.
+     **/
+    void showQueryError( const std::exception & exception );
+
     /**
      * Check if at least one of the "search in" check boxes is checked.
      * Check one if needed.
@@ -207,6 +262,12 @@ protected:
     Ui::SearchFilterView *   _ui;
     SearchFields             _searchFields;
     SearchFilter::FilterMode _defaultAutoMode;
+
+    QueryRun *               _queryRun;
+    QTimer *                 _querySliceTimer;
+    QTimer *                 _typingTimer;
+    bool                     _overrideExcludeRuleDevel;
+    bool                     _overrideExcludeRuleDebugInfo;
 };
 
 
@@ -50,14 +50,14 @@ void YQPkgSecondaryFilterView::init(QWidget * primaryWidget)
 
     primaryWidget->setSizePolicy( QSizePolicy( QSizePolicy::Ignored, QSizePolicy::Expanding ) );// hor/vert
 
-    // Directly propagate signals filterStart() and filterFinished()
+    // Propagate signals filterStart() and filterFinished()
     // from the primary filter to the outside
 
-    connect( primaryWidget, SIGNAL( filterStart() ),
-             this,          SIGNAL( filterStart() ) );
+    connect( primaryWidget, SIGNAL( filterStart()           ),
+             this,          SLOT  ( primaryFilterStart()    ) );
 
-    connect( primaryWidget, SIGNAL( filterFinished() ),
-             this,          SIGNAL( filterFinished() ) );
+    connect( primaryWidget, SIGNAL( filterFinished()        ),
+             this,          SLOT  ( primaryFilterFinished() ) );
 
     // Redirect filterMatch() and filterNearMatch() signals to the secondary filter
 
@@ -163,11 +163,28 @@ void YQPkgSecondaryFilterView::filter()
 }
 
 
+void YQPkgSecondaryFilterView::primaryFilterStart()
+{
+    _matches.clear();
+    emit filterStart();
+}
+
+
+void YQPkgSecondaryFilterView::primaryFilterFinished()
+{
+    if ( ! _matches.isEmpty() )
+        emit filterMatches( _matches );
+
+    _matches.clear();
+    emit filterFinished();
+}
+
+
 void YQPkgSecondaryFilterView::primaryFilterMatch( ZyppSel selectable,
                                                    ZyppPkg pkg )
 {
     if ( secondaryFilterMatch( selectable, pkg ) )
-        emit filterMatch( selectable, pkg );
+        _matches << ZyppPkgMatch( selectable, pkg );
 }
 
 
@@ -63,11 +63,12 @@ signals:
     void filterStart();
 
     /**
-     * Emitted during filtering for each pkg that matches the filter
-     * and the candidate package comes from the respective repository
+     * Emitted during filtering for the pkgs that match the filter
+     * and where the candidate package comes from the respective repository.
+     * The matches of the primary filter are collected and sent as one batch
+     * when the primary filter is finished.
      **/
-    void filterMatch( ZyppSel selectable,
-                      ZyppPkg pkg );
+    void filterMatches( const ZyppPkgMatchList & matches );
 
     /**
      * Emitted during filtering for each pkg that matches the filter
@@ -92,7 +93,7 @@ public slots:
      * Filter according to the view's rules and current selection.
      * Emits those signals:
      *    filterStart()
-     *    filterMatch() for each pkg that matches the filter
+     *    filterMatches() for the pkgs that match the filter
      *    filterFinished()
      **/
     void filter();
@@ -101,8 +102,19 @@ public slots:
 protected slots:
 
     /**
-     * Propagate a filter match from the primary filter
-     * and appy any selected secondary filter(s) to it
+     * Propagate the start of filtering from the primary filter
+     **/
+    void primaryFilterStart();
+
+    /**
+     * Propagate the end of filtering from the primary filter:
+     * Send the collected matches and then filterFinished()
+     **/
+    void primaryFilterFinished();
+
+    /**
+     * Collect a filter match from the primary filter
+     * if it also matches any selected secondary filter(s)
      **/
     void primaryFilterMatch( ZyppSel selectable,
                              ZyppPkg pkg );
@@ -142,6 +154,7 @@ protected:
     QWidget *               _allPackages;
     YQPkgSearchFilterView * _searchFilterView;
     YQPkgStatusFilterView * _statusFilterView;
+    ZyppPkgMatchList        _matches;
 };
 
 
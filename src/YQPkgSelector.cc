@@ -950,8 +950,8 @@ YQPkgSelector::connectFilter( QWidget * filter,
     connect( filter,    SIGNAL( filterStart()   ),
              this,      SLOT  ( busyCursor()            ) );
 
-    connect( filter,    SIGNAL( filterMatch( ZyppSel, ZyppPkg ) ),
-             pkgList,   SLOT  ( addPkgItem ( ZyppSel, ZyppPkg ) ) );
+    connect( filter,    SIGNAL( filterMatches( ZyppPkgMatchList ) ),
+             pkgList,   SLOT  ( addPkgItems  ( ZyppPkgMatchList ) ) );
 
     connect( filter,    SIGNAL( filterFinished()       ),
              pkgList,   SLOT  ( resort() ) );
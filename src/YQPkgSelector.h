@@ -368,7 +368,7 @@ protected:
      * Connect a filter view that provides the usual signals with a package
      * list. By convention, filter views provide the following signals:
      *    filterStart()
-     *    filterMatch()
+     *    filterMatches()
      *    filterFinished()
      *    updatePackages()  (optional)
      **/
@@ -119,6 +119,7 @@ YQPkgStatusFilterView::filter()
 #endif
 
     emit filterStart();
+    ZyppPkgMatchList matches;
 
     for ( ZyppPoolIterator it = zyppPkgBegin();
           it != zyppPkgEnd();
@@ -126,19 +127,30 @@ YQPkgStatusFilterView::filter()
     {
         ZyppSel selectable = *it;
 
-        bool match =
-            check( selectable, selectable->candidateObj() ) ||
-            check( selectable, selectable->installedObj() );
+        // Check the candidate if there is one, the installed package
+        // otherwise. If there is neither an installed nor a candidate
+        // package, check any other instance.
 
-        // If there is neither an installed nor a candidate package, check
-        // any other instance.
+        ZyppObj zyppObj = selectable->candidateObj();
 
-        if ( ! match                      &&
-             ! selectable->candidateObj() &&
-             ! selectable->installedObj()   )
-            check( selectable,  selectable->theObj() );
+        if ( ! zyppObj )
+            zyppObj = selectable->installedObj();
+
+        if ( ! zyppObj )
+            zyppObj = selectable->theObj();
+
+        if ( check( selectable, zyppObj ) )
+        {
+            ZyppPkg zyppPkg = tryCastToZyppPkg( zyppObj );
+
+            if ( zyppPkg )
+                matches << ZyppPkgMatch( selectable, zyppPkg );
+        }
     }
 
+    if ( ! matches.isEmpty() )
+        emit filterMatches( matches );
+
     emit filterFinished();
 }
 
@@ -169,14 +181,6 @@ YQPkgStatusFilterView::check( ZyppSel selectable,
             // catch unhandled enum states
     }
 
-    if ( match )
-    {
-        ZyppPkg zyppPkg = tryCastToZyppPkg( zyppObj );
-
-        if ( zyppPkg )
-            emit filterMatch( selectable, zyppPkg );
-    }
-
     return match;
 }
 
@@ -111,6 +111,7 @@ YQPkgUpdatesFilterView::filter()
 #endif
 
     emit filterStart();
+    ZyppPkgMatchList matches;
 
     for ( ZyppPoolIterator it = zyppPkgBegin();
           it != zyppPkgEnd();
@@ -125,10 +126,13 @@ YQPkgUpdatesFilterView::filter()
             ZyppPkg zyppPkg   = tryCastToZyppPkg( installed );
 
             if ( zyppPkg )
-                emit filterMatch( selectable, zyppPkg );
+                matches << ZyppPkgMatch( selectable, zyppPkg );
         }
     }
 
+    if ( ! matches.isEmpty() )
+        emit filterMatches( matches );
+
     emit filterFinished();
 }
 
@@ -18,6 +18,8 @@
 #define YQZypp_h
 
 #include <set>
+#include <QList>
+#include <QPair>
 #include <zypp/ui/Status.h>
 #include <zypp/ui/Selectable.h>
 #include <zypp/RepoInfo.h>
@@ -57,6 +59,13 @@ typedef zypp::Patch::constPtr                   ZyppPatch;
 typedef zypp::Product::constPtr                 ZyppProduct;
 typedef zypp::PoolItem                          ZyppPoolItem;
 
+// A package that matched a filter: The selectable and the package object that
+// matched, which is not necessarily the candidate. Filter views send those in
+// batches with their filterMatches() signal.
+
+typedef QPair<ZyppSel, ZyppPkg>                 ZyppPkgMatch;
+typedef QList<ZyppPkgMatch>                     ZyppPkgMatchList;
+
 
 typedef zypp::ResPoolProxy                      ZyppPool;
 typedef zypp::ResPoolProxy::const_iterator      ZyppPoolIterator;
@@ -14,7 +14,16 @@
  */
 
 
-#include <QtAlgorithms>  // qDeleteAll()
+#include <sys/stat.h>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
 
 #include "ZyppHistory.h"
 #include "ZyppHistoryParser.h"
@@ -23,6 +32,10 @@
 
 #define DEFAULT_ZYPP_HISTORY "/var/log/zypp/history"
 
+#define CACHE_FILE_PREFIX       "zypp-history-"
+#define CACHE_MAGIC             0x4d795a48      // "MyZH"
+#define CACHE_FORMAT_VERSION    2
+
 using namespace ZyppHistoryEvents;
 
 
@@ -31,7 +44,10 @@ QString       ZyppHistory::_fileName( DEFAULT_ZYPP_HISTORY );
 
 
 ZyppHistory::ZyppHistory():
-    _dirty( true )
+    _dirty( true ),
+    _inode( 0 ),
+    _size( -1 ),
+    _mtime( 0 )
 {
 
 }
@@ -55,45 +71,309 @@ ZyppHistory * ZyppHistory::instance()
 }
 
 
+ZyppHistory::FileState ZyppHistory::fileState()
+{
+    FileState   state;
+    struct stat fileStat;
+
+    if ( stat( QFile::encodeName( _fileName ).constData(), &fileStat ) == 0 )
+    {
+        state.inode = fileStat.st_ino;
+        state.size  = fileStat.st_size;
+        state.mtime = fileStat.st_mtime;
+    }
+
+    return state;
+}
+
+
+bool ZyppHistory::needsFullParse()
+{
+    if ( ! _dirty )
+        return false;
+
+    FileState state = fileState();
+
+    if ( _size < 0 && state.inode != 0 )  // Nothing parsed yet
+        loadCache();
+
+    return ! canResume( state.inode, state.size, state.mtime );
+}
+
+
 bool ZyppHistory::read()
 {
     if ( ! _dirty )
         return true;  // success
 
+    FileState state = fileState();
+    quint64   inode = state.inode;
+    qint64    size  = state.size;
+    qint64    mtime = state.mtime;
+
+    if ( _size < 0 && inode != 0 )  // Nothing parsed yet
+        loadCache();
+
     try
     {
-        clear();
         ZyppHistoryParser parser( _fileName );
-        _dirty  = false; // Even if this fails, don't try again
-        _events = parser.parse();
+
+        if ( canResume( inode, size, mtime ) )
+        {
+            _dirty = false;
+
+            if ( size == _size )
+            {
+                logDebug() << "Zypp history file " << _fileName << " is unchanged" << endl;
+                return true;
+            }
+
+            // Parse the last command again together with the new lines
+
+            _events.truncate( _resumePoint.commandCount, _resumePoint.eventCount );
+            parser.parse( _events, _resumePoint.offset, _resumePoint.lineNo );
+        }
+        else
+        {
+            clear();
+            _dirty = false; // Even if this fails, don't try again
+            parser.parse( _events );
+        }
+
+        _inode       = inode;
+        _size        = parser.fileSize();
+        _mtime       = mtime;
+        _resumePoint = parser.resumePoint();
     }
     catch ( const FileException & exception )
     {
         CAUGHT ( exception );
+        clear();  // Don't keep a half-parsed history
+        _dirty = false;
         RETHROW( exception );
     }
     catch ( const ZyppHistoryParseException & exception )
     {
         CAUGHT ( exception );
+        clear();  // Don't keep a half-parsed history
+        _dirty = false;
         RETHROW( exception );
     }
 
+    saveCache();
+
     return true;  // success
 }
 
 
+bool ZyppHistory::canResume( quint64 inode, qint64 size, qint64 mtime ) const
+{
+    if ( _size < 0 || inode == 0 )
+        return false;
+
+    if ( inode != _inode )
+    {
+        logInfo() << "Zypp history file " << _fileName << " was replaced" << endl;
+        return false;
+    }
+
+    if ( size < _size )
+    {
+        logInfo() << "Zypp history file " << _fileName << " was truncated" << endl;
+        return false;
+    }
+
+    if ( size == _size && mtime != _mtime )
+    {
+        logInfo() << "Zypp history file " << _fileName << " was modified" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+QString ZyppHistory::cacheFileName()
+{
+    QString cacheDir = QStandardPaths::writableLocation( QStandardPaths::GenericCacheLocation );
+
+    if ( cacheDir.isEmpty() )
+        return QString();
+
+    // One cache file for each zypp history file (see --zypp-history)
+
+    QByteArray hash = QCryptographicHash::hash( QFile::encodeName( _fileName ),
+                                                QCryptographicHash::Md5 ).toHex();
+
+    return cacheDir + "/myrlyn/" CACHE_FILE_PREFIX + QString::fromLatin1( hash.left( 16 ) );
+}
+
+
+bool ZyppHistory::loadCache()
+{
+    QString cacheFile = cacheFileName();
+
+    if ( cacheFile.isEmpty() )
+        return false;
+
+    QFile file( cacheFile );
+
+    if ( ! file.open( QIODevice::ReadOnly ) )
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    uchar *    mapped = file.size() > 0 ? file.map( 0, file.size() ) : 0;
+    QByteArray data   = mapped ?
+        QByteArray::fromRawData( (const char *) mapped, file.size() ) : file.readAll();
+
+    QDataStream stream( data );
+    stream.setVersion( QDataStream::Qt_6_0 );
+
+    quint32 magic   = 0;
+    quint32 version = 0;
+    QString fileName;
+
+    stream >> magic >> version;
+
+    bool ok = magic == CACHE_MAGIC && version == CACHE_FORMAT_VERSION;
+
+    if ( ok )
+    {
+        stream >> fileName;
+        ok = fileName == _fileName;
+    }
+
+    if ( ok )
+    {
+        stream >> _inode
+               >> _size
+               >> _mtime
+               >> _resumePoint.offset
+               >> _resumePoint.lineNo
+               >> _resumePoint.commandCount
+               >> _resumePoint.eventCount;
+
+        ok = stream.status() == QDataStream::Ok && _events.read( stream );
+
+        if ( ok && ( _resumePoint.commandCount > _events.commandCount() ||
+                     _resumePoint.eventCount   > _events.eventCount()   ||
+                     _resumePoint.offset       > _size                  ||
+                     _resumePoint.lineNo       < 0                         ) )
+        {
+            ok = false;
+        }
+    }
+
+    data.clear();  // Before unmapping: This may point into the mapped file
+
+    if ( mapped )
+        file.unmap( mapped );
+
+    if ( ! ok )
+    {
+        logInfo() << "Ignoring invalid zypp history cache " << cacheFile << endl;
+        clear();
+
+        return false;
+    }
+
+    logInfo() << "Loaded " << _events.eventCount() << " zypp history events from "
+              << cacheFile << " in " << timer.elapsed() << " millisec" << endl;
+
+    return true;
+}
+
+
+bool ZyppHistory::saveCache() const
+{
+    QString cacheFile = cacheFileName();
+
+    if ( cacheFile.isEmpty() || _size < 0 || _inode == 0 )
+        return false;
+
+    if ( ! QDir().mkpath( QFileInfo( cacheFile ).path() ) )
+        return false;
+
+    // Write to a temporary file and rename it only when complete
+    QSaveFile file( cacheFile );
+
+    if ( ! file.open( QIODevice::WriteOnly ) )
+        return false;
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_6_0 );
+
+    stream << (quint32) CACHE_MAGIC
+           << (quint32) CACHE_FORMAT_VERSION
+           << _fileName
+           << _inode
+           << _size
+           << _mtime
+           << _resumePoint.offset
+           << _resumePoint.lineNo
+           << _resumePoint.commandCount
+           << _resumePoint.eventCount;
+
+    _events.write( stream );
+
+    if ( stream.status() == QDataStream::Ok && file.commit() )
+    {
+        logDebug() << "Saved zypp history cache to " << cacheFile << endl;
+        return true;
+    }
+
+    logWarning() << "Error writing zypp history cache " << cacheFile << endl;
+
+    return false;
+}
+
+
 void ZyppHistory::clear()
 {
-    qDeleteAll( _events );
     _events.clear();
-    _dirty = true;
+    _dirty       = true;
+    _inode       = 0;
+    _size        = -1;
+    _mtime       = 0;
+    _resumePoint = ZyppHistoryParser::ResumePoint();
+}
+
+
+void ZyppHistory::setPartialEvents( const EventStore & events )
+{
+    clear();
+    _events = events;  // _dirty stays 'true'
+}
+
+
+void ZyppHistory::setParsedEvents( const EventStore &                     events,
+                                   const FileState &                      fileState,
+                                   const ZyppHistoryParser::ResumePoint & resumePoint )
+{
+    _events      = events;
+    _dirty       = false;
+    _inode       = fileState.inode;
+    _size        = fileState.size;
+    _mtime       = fileState.mtime;
+    _resumePoint = resumePoint;
+
+    saveCache();
+}
+
+
+void ZyppHistory::setParseFailed()
+{
+    clear();  // Don't keep a half-parsed history
+    _dirty = false;
 }
 
 
 void ZyppHistory::dropCache()
 {
-    logInfo() << "Dropping zypp history cache" << endl;
-    instance()->clear();
+    logInfo() << "Marking the zypp history cache as outdated" << endl;
+    instance()->_dirty = true;
 }
 
 
@@ -104,5 +384,8 @@ void ZyppHistory::setFileName( const QString & fileName )
     if ( fileName.isEmpty() )
         _fileName = DEFAULT_ZYPP_HISTORY;
 
+    if ( _instance )
+        _instance->clear();  // That was parsed from a different file
+
     logInfo() << "Using zypp history file " << _fileName << endl;
 }
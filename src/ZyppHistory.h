@@ -17,7 +17,9 @@
 #define ZyppHistory_h
 
 #include <QString>
+
 #include "ZyppHistoryEvents.h"
+#include "ZyppHistoryParser.h"
 
 /**
  * Singleton class for the content of the zypp history file where libzypp
@@ -34,6 +36,20 @@
  * underlying data might have changed, such as after a package transaction
  * (installing / updating / removing packages) was done, and the user returns
  * to the Myrlyn main screen.
+ *
+ * Since the zypp history file is only ever appended to, the next read() after
+ * that only parses the lines that were added since the last time. If the
+ * file was replaced (a different inode, e.g. by log rotation) or it became
+ * smaller, it is parsed completely again.
+ *
+ * The parsed events are also saved to a cache file in the user's cache
+ * directory (~/.cache/myrlyn), one for each zypp history file. When Myrlyn is
+ * started the next time, they are loaded from there, and again only the lines
+ * that were added since then are parsed.
+ *
+ * Parsing the complete file can take a while for a large history. The
+ * ZyppHistoryLoader does that in the background and sets the events here
+ * step by step.
  **/
 class ZyppHistory
 {
@@ -60,17 +76,66 @@ public:
     static ZyppHistory * instance();
 
     /**
-     * Read and parse the zypp history file if that hasn't been done yet.
+     * The state of the zypp history file that is relevant for reusing the
+     * result of a previous parse.
+     **/
+    struct FileState
+    {
+        quint64 inode;
+        qint64  size;
+        qint64  mtime;
+
+        FileState(): inode(0), size(-1), mtime(0) {}
+    };
+
+    /**
+     * Return the current state of the zypp history file.
+     **/
+    static FileState fileState();
+
+    /**
+     * Read and parse the zypp history file if that hasn't been done yet, or
+     * parse what was appended to it after dropCache().
      * Return 'true' on success.
      *
      * This may throw exceptions.
      **/
     bool read();
 
+    /**
+     * Return 'true' if read() would have to parse the complete file because
+     * there is no parse result yet that it could use or continue, not even
+     * in the cache file.
+     **/
+    bool needsFullParse();
+
+    /**
+     * Set the events that were parsed so far from the end of the file while
+     * the rest is still being parsed. This is still incomplete, so read()
+     * will not use it.
+     **/
+    void setPartialEvents( const ZyppHistoryEvents::EventStore & events );
+
+    /**
+     * Set the events of a complete parse of the file that had the state
+     * 'fileState', and where to continue parsing when more lines are appended.
+     * This is the same as if read() had parsed the file; they are also
+     * saved to the cache file.
+     **/
+    void setParsedEvents( const ZyppHistoryEvents::EventStore &  events,
+                          const FileState &                      fileState,
+                          const ZyppHistoryParser::ResumePoint & resumePoint );
+
+    /**
+     * Clear the content after a failed parse, but don't try again with the
+     * next read() until dropCache() is called.
+     **/
+    void setParseFailed();
+
     /**
      * Return the zypp history events. Make sure to call read() first.
      **/
-    const ZyppHistoryEvents::EventList & events() const { return _events; }
+    const ZyppHistoryEvents::EventStore & events() const { return _events; }
 
     /**
      * Clear the content.
@@ -78,7 +143,8 @@ public:
     void clear();
 
     /**
-     * Drop the cached content of the zypp history events.
+     * Mark the cached content of the zypp history events as outdated, so the
+     * next read() checks the file again.
      **/
     static void dropCache();
 
@@ -96,11 +162,45 @@ public:
 
 protected:
 
+    /**
+     * Return 'true' if the file that was parsed last time is still the same
+     * with 'inode', 'size' and 'mtime', i.e. it can only have more lines
+     * appended.
+     **/
+    bool canResume( quint64 inode, qint64 size, qint64 mtime ) const;
+
+    /**
+     * Return the name (with full path) of the cache file for the current
+     * zypp history file.
+     **/
+    static QString cacheFileName();
+
+    /**
+     * Load the events and the state of the last parse from the cache file.
+     * Return 'true' on success. The caller still needs to check with
+     * canResume() if they are still valid.
+     **/
+    bool loadCache();
+
+    /**
+     * Save the events and the state of the last parse to the cache file.
+     * Return 'true' on success.
+     **/
+    bool saveCache() const;
+
+
     static ZyppHistory * _instance;
     static QString       _fileName;
 
-    ZyppHistoryEvents::EventList _events;
-    bool                         _dirty;
+    ZyppHistoryEvents::EventStore _events;
+    bool                          _dirty;
+
+    // The state of the last parse
+
+    quint64                          _inode;
+    qint64                           _size;
+    qint64                           _mtime;
+    ZyppHistoryParser::ResumePoint   _resumePoint;
 
 };  // class ZyppHistory
 
@@ -14,9 +14,13 @@
  */
 
 
+#include <algorithm>
+
 #include <QDate>
 #include <QFontMetrics>
 #include <QHeaderView>
+#include <QMessageBox>
+#include <QSet>
 #include <QSettings>
 
 #include "Exception.h"
@@ -25,29 +29,23 @@
 #include "WindowSettings.h"
 #include "utf8.h"
 #include "YQi18n.h"
-#include "YQIconPool.h"
 #include "ZyppHistory.h"
+#include "ZyppHistoryEventsModel.h"
 #include "ZyppHistoryFilter.h"
 #include "ZyppHistoryFilterDialog.h"
+#include "ZyppHistoryLoader.h"
 #include "ZyppHistoryBrowser.h"
 
 
 using namespace ZyppHistoryEvents;
 
 
-enum EventsTreeColumns
-{
-    NameCol,
-    VersionCol,
-    ArchCol,
-    RepoCol
-};
-
-
 ZyppHistoryBrowser::ZyppHistoryBrowser( QWidget * parent )
     : QDialog( parent ? parent : MainWindow::instance() )
     , _ui( new Ui::ZyppHistoryBrowser )  // Use the Qt designer .ui form (XML)
     , _lastTimeLineItem(0)
+    , _eventsModel(0)
+    , _loader(0)
     , _filteredEventsDirty( true )
     , _filterDialog(0)
     , _filter(0)
@@ -55,6 +53,13 @@ ZyppHistoryBrowser::ZyppHistoryBrowser( QWidget * parent )
     CHECK_NEW( _ui );
     _ui->setupUi( this ); // Actually create the widgets from the .ui form
 
+    _eventsModel = new ZyppHistoryEventsModel( events(), this );
+    CHECK_NEW( _eventsModel );
+    _ui->eventsTree->setModel( _eventsModel );
+
+    _loader = new ZyppHistoryLoader( this );
+    CHECK_NEW( _loader );
+
     // See ui_zypp-history-browser.h for the widget names.
     //
     // That header is generated by Qt's uic (user interface compiler)
@@ -106,6 +111,18 @@ void ZyppHistoryBrowser::connectWidgets()
 
     connect( _ui->clearFilterButton,  SIGNAL( clicked() ),
              this,                    SLOT  ( clearFilter() ) );
+
+    connect( _eventsModel, SIGNAL( rowsInserted     ( const QModelIndex &, int, int ) ),
+             this,         SLOT  ( eventRowsInserted( const QModelIndex &, int, int ) ) );
+
+    connect( _loader,      SIGNAL( eventsChanged() ),
+             this,         SLOT  ( eventsLoaded()  ) );
+
+    connect( _loader,      SIGNAL( progress        ( qint64, qint64, qint64 ) ),
+             this,         SLOT  ( showLoadProgress( qint64, qint64, qint64 ) ) );
+
+    connect( _loader,      SIGNAL( failed()     ),
+             this,         SLOT  ( loadFailed() ) );
 }
 
 
@@ -122,25 +139,114 @@ void ZyppHistoryBrowser::selectLastTimeLineItem()
 }
 
 
-void ZyppHistoryBrowser::populate()
+bool ZyppHistoryBrowser::selectTimeLineItem( const QString & date )
 {
-    {
-        QSignalBlocker blocker( _ui->timeLineTree );
+    if ( date.isEmpty() )
+        return false;
+
+    QList<QTreeWidgetItem *> items =
+        _ui->timeLineTree->findItems( date, Qt::MatchExactly | Qt::MatchRecursive );
+
+    if ( items.isEmpty() || ! ( items.first()->flags() & Qt::ItemIsEnabled ) )
+        return false;
+
+    QTreeWidgetItem * item = items.first();
+
+    for ( QTreeWidgetItem * parent = item->parent(); parent; parent = parent->parent() )
+        parent->setExpanded( true );
+
+    _ui->timeLineTree->scrollToItem( item );
+    _ui->timeLineTree->setCurrentItem( item,
+                                       0, // column
+                                       QItemSelectionModel::SelectCurrent );
+    return true;
+}
 
-        _lastTimeLineItem = 0;
-        _ui->timeLineTree->clear();
-        _ui->eventsTree->clear();
-    }
+
+void ZyppHistoryBrowser::clearTrees()
+{
+    QSignalBlocker blocker( _ui->timeLineTree );
+
+    _lastTimeLineItem = 0;
+    _ui->timeLineTree->clear();
+    _eventsModel->clear(); // Before the events change
+}
+
+
+void ZyppHistoryBrowser::populate()
+{
+    clearTrees();
 
     // This can be called repeatedly without any performance pentalty:
-    // It uses cached data if possible.
-    ZyppHistory::instance()->read();
+    // It uses cached data if possible. If the whole file needs to be parsed,
+    // this happens in the background, and eventsLoaded() is called when
+    // there is more.
+    _loader->load();
+    _filteredEventsDirty = true;
 
     populateTimeLineTree();
     selectLastTimeLineItem();
 }
 
 
+void ZyppHistoryBrowser::eventsLoaded()
+{
+    // Older dates were added: Rebuild everything, but stay with the date
+    // that the user selected.
+
+    QTreeWidgetItem * currentItem = _ui->timeLineTree->currentItem();
+    QString currentDate = currentItem ? currentItem->text( 0 ) : QString();
+
+    clearTrees();
+    _filteredEventsDirty = true;
+
+    populateTimeLineTree();
+
+    if ( ! selectTimeLineItem( currentDate ) )
+        selectLastTimeLineItem();
+}
+
+
+void ZyppHistoryBrowser::showLoadProgress( qint64 bytesParsed, qint64 bytesTotal, qint64 millisec )
+{
+    double mb       = bytesParsed / ( 1024.0 * 1024.0 );
+    double mbPerSec = millisec > 0 ? mb * 1000.0 / millisec : 0.0;
+    QString text;
+
+    if ( bytesParsed < bytesTotal )
+    {
+        text = _( "Reading the history: %1%  (%2 MB/s)" )
+            .arg( bytesTotal > 0 ? (int) ( 100 * bytesParsed / bytesTotal ) : 0 )
+            .arg( mbPerSec, 0, 'f', 1 );
+    }
+    else
+    {
+        text = _( "Read %1 MB in %2 sec  (%3 MB/s)" )
+            .arg( mb, 0, 'f', 1 )
+            .arg( millisec / 1000.0, 0, 'f', 1 )
+            .arg( mbPerSec, 0, 'f', 1 );
+    }
+
+    _ui->loadStatusLabel->setText( text );
+}
+
+
+void ZyppHistoryBrowser::loadFailed()
+{
+    clearTrees();
+    _filteredEventsDirty = true;
+    _ui->loadStatusLabel->clear();
+
+    QMessageBox msgBox( this );
+    msgBox.setText( _( "Parse error in zypp history file\n"
+                       "%1\n\n"
+                       "Check the log!" ).arg( ZyppHistory::fileName() ) );
+    msgBox.setIcon( QMessageBox::Warning );
+    msgBox.addButton( QMessageBox::Ok );
+    msgBox.exec();
+}
+
+
 void ZyppHistoryBrowser::populateTimeLineTree()
 {
     _lastTimeLineItem = 0;
@@ -149,6 +255,8 @@ void ZyppHistoryBrowser::populateTimeLineTree()
     if ( dates.isEmpty() )
         return;
 
+    QSet<QString> dateSet( dates.cbegin(), dates.cend() );
+
     QString firstDate = dates.first();
     QString lastDate  = dates.last();
 
@@ -242,7 +350,7 @@ void ZyppHistoryBrowser::populateTimeLineTree()
                 CHECK_NEW( dateItem );
                 dateItem->setText( 0, date );
 
-                if ( ! dates.contains( date ) )
+                if ( ! dateSet.contains( date ) )
                     dateItem ->setFlags( Qt::NoItemFlags );  // Disable this item
                 else
                     _lastTimeLineItem = dateItem;
@@ -256,16 +364,27 @@ QStringList
 ZyppHistoryBrowser::uniqueDates()
 {
     QStringList dates;
-    QString lastDate;
 
-    for ( Event * event: events() )
+    if ( ! _filter )
     {
-        QString date = event->date();
+        // Straight from the index
 
-        if ( date != lastDate )
+        for ( Day day: events().days() )
+            dates << dateString( (Timestamp) day * 1000000 );
+    }
+    else
+    {
+        Day lastDay = 0;
+
+        for ( int cmdNo: commands() )
         {
-            dates << date;
-            lastDate = date;
+            Day day = dayOf( events().commandTimestamp( cmdNo ) );
+
+            if ( day != lastDay )
+            {
+                dates << dateString( events().commandTimestamp( cmdNo ) );
+                lastDay = day;
+            }
         }
     }
 
@@ -333,176 +452,87 @@ void ZyppHistoryBrowser::timeLineClicked( QTreeWidgetItem * item )
 
 void ZyppHistoryBrowser::populateEventsTree( const QString & date )
 {
-    _ui->eventsTree->clear();
+    Day fromDay = dayRangeStart( date );
+    Day toDay   = dayRangeEnd  ( date );
+    const QVector<int> & filteredCommands = commands();
+    QVector<int> cmdNos;
 
-    for ( Event * event: events() )
+    for ( int cmdNo: events().commandsInDays( fromDay, toDay ) )
     {
-        if ( event->timestamp.startsWith( date ) )
-            addEventItem( event );
+        if ( ! _filter || std::binary_search( filteredCommands.cbegin(),
+                                              filteredCommands.cend(),
+                                              cmdNo ) )
+        {
+            cmdNos << cmdNo;
+        }
     }
-}
 
+    _eventsModel->setShowPlusMinusCount( _ui->showPlusMinusCount->isChecked(),
+                                         _trivialPkgInstallCount,
+                                         _trivialPkgRemoveCount );
+    _eventsModel->setCommands( cmdNos, _filterMatches );
 
-void ZyppHistoryBrowser::populateEventsTree()
-{
-    QTreeWidgetItem * item = _ui->timeLineTree->currentItem();
-
-    if ( item )
-        timeLineClicked( item );
-}
-
-
-void ZyppHistoryBrowser::addEventItem( Event * event, QTreeWidgetItem * parentItem )
-{
-    CHECK_PTR( event );
-
-    QTreeWidgetItem * item = new QTreeWidgetItem;
-    CHECK_NEW( item );
-
-    if ( parentItem )
-        parentItem->addChild( item );
-    else
-        _ui->eventsTree->addTopLevelItem( item );
-
-    switch ( event->eventType )
+    for ( int row = 0; row < _eventsModel->rowCount(); row++ )
     {
-        case EventType::Command:     fillCommandItem( item, event ); break;
-
-        case EventType::PkgInstall:
-        case EventType::PkgRemove:   fillPkgItem    ( item, event ); break;
+        QModelIndex index = _eventsModel->index( row, 0 );
+        _ui->eventsTree->setFirstColumnSpanned( row, QModelIndex(), true );
 
-        case EventType::RepoAdd:
-        case EventType::RepoRemove:
-        case EventType::RepoUrl:
-        case EventType::RepoAlias:   fillRepoItem   ( item, event ); break;
+        // Only expand the commands of a single day: The child events of a
+        // collapsed command are not even looked at.
 
-        case EventType::Patch:       fillPatchItem  ( item, event ); break;
-
-        default:
-            break;
+        if ( fromDay == toDay )
+            _ui->eventsTree->expand( index );
     }
 }
 
 
-void ZyppHistoryBrowser::fillCommandItem( QTreeWidgetItem * item, Event * event )
+void ZyppHistoryBrowser::eventRowsInserted( const QModelIndex & parent, int first, int last )
 {
-    CommandEvent * commandEvent = dynamic_cast<CommandEvent *>( event );
-    CHECK_DYNAMIC_CAST( commandEvent, "ZyppHistoryEvents::CommandEvent" );
-
-    int pkgInstallCount = 0;
-    int pkgRemoveCount  = 0;
+    if ( ! parent.isValid() ) // The toplevel rows are handled in populateEventsTree()
+        return;
 
-    for ( Event * childEvent: commandEvent->childEvents() )
+    for ( int row = first; row <= last; row++ )
     {
-        switch ( childEvent->eventType )
-        {
-            case EventType::PkgInstall: pkgInstallCount++; break;
-            case EventType::PkgRemove:  pkgRemoveCount++;  break;
-            default: break;
-        }
-
-        addEventItem( childEvent,
-                      item ); // parentItem
+        if ( _eventsModel->isSpanned( _eventsModel->index( row, 0, parent ) ) )
+            _ui->eventsTree->setFirstColumnSpanned( row, parent, true );
     }
-
-    QString text = QString( "%1  %2" )
-        .arg( event->timestamp )
-        .arg( commandEvent->command );
-
-    if ( _ui->showPlusMinusCount->isChecked() &&
-         ( pkgInstallCount > _trivialPkgInstallCount ||
-           pkgRemoveCount  > _trivialPkgRemoveCount    ) )
-    {
-        if ( pkgRemoveCount == 0 )
-            text += QString( "   (+%1)" ).arg( pkgInstallCount );
-        else if ( pkgInstallCount == 0 )
-            text += QString( "   (-%1)" ).arg( pkgRemoveCount );
-        else
-        {
-            text += QString( "   (+%1/-%2)" )
-                .arg( pkgInstallCount )
-                .arg( pkgRemoveCount  );
-        }
-    }
-
-    item->setText( 0, text );
-
-    static QFont boldFont( item->font( 0 ) );
-    boldFont.setBold( true );
-    item->setFont( 0, boldFont );
-
-    item->setExpanded( true );
-    item->setFirstColumnSpanned( true );
-
 }
 
 
-void ZyppHistoryBrowser::fillPkgItem( QTreeWidgetItem * item, Event * event )
+Day ZyppHistoryBrowser::dayRangeStart( const QString & date )
 {
-    PkgEvent * pkgEvent = dynamic_cast<PkgEvent *>( event );
-    CHECK_DYNAMIC_CAST( pkgEvent, "ZyppHistoryEvents::PkgEvent" );
+    // "2025-12-28" -> 20251228
+    // "2025-12"    -> 20251201
+    // "2025"       -> 20250101
 
-    QPixmap icon = event->eventType == EventType::PkgInstall ?
-        YQIconPool::pkgInstall() : YQIconPool::pkgDel();
+    int year  = date.section( '-', 0, 0 ).toInt();
+    int month = date.section( '-', 1, 1 ).toInt();
+    int day   = date.section( '-', 2, 2 ).toInt();
 
-    item->setText( NameCol,      pkgEvent->name      );
-    item->setIcon( NameCol,      icon                );
-    item->setText( VersionCol,   pkgEvent->version   );
-    item->setText( ArchCol,      pkgEvent->arch      );
-    item->setText( RepoCol,      pkgEvent->repoAlias );
+    return year * 10000 + ( month > 0 ? month : 1 ) * 100 + ( day > 0 ? day : 1 );
 }
 
 
-void ZyppHistoryBrowser::fillRepoItem( QTreeWidgetItem * item, Event * event )
+Day ZyppHistoryBrowser::dayRangeEnd( const QString & date )
 {
-    RepoEvent * repoEvent = dynamic_cast<RepoEvent *>( event );
-    CHECK_DYNAMIC_CAST( repoEvent, "ZyppHistoryEvents::RepoEvent" );
-    QString text;
+    // "2025-12-28" -> 20251228
+    // "2025-12"    -> 20251231
+    // "2025"       -> 20251231
 
-    switch ( event->eventType )
-    {
-        case EventType::RepoAdd:
-            text = _( "Repo+  %1  %2" )
-                .arg( repoEvent->repoAlias )
-                .arg( repoEvent->url );
-            break;
-
-        case EventType::RepoRemove:
-            text = _( "Repo-  %1" )
-                .arg( repoEvent->repoAlias );
-            break;
-
-        case EventType::RepoUrl:
-            text =  _( "Repo-URL  %1 -> %2" )
-                .arg( repoEvent->oldUrl )
-                .arg( repoEvent->url    );
-            break;
-
-        case EventType::RepoAlias:
-            text = _( "Repo-Alias  %1 -> %2" )
-                .arg( repoEvent->oldRepoAlias )
-                .arg( repoEvent->repoAlias    );
-            break;
-
-        default:
-            break;
-    }
-
-    item->setText( 0, text );
-    item->setFirstColumnSpanned( true );
+    int year  = date.section( '-', 0, 0 ).toInt();
+    int month = date.section( '-', 1, 1 ).toInt();
+    int day   = date.section( '-', 2, 2 ).toInt();
 
+    return year * 10000 + ( month > 0 ? month : 12 ) * 100 + ( day > 0 ? day : 31 );
 }
 
 
-void ZyppHistoryBrowser::fillPatchItem( QTreeWidgetItem * item, Event * event )
+void ZyppHistoryBrowser::populateEventsTree()
 {
-    PatchEvent * patchEvent = dynamic_cast<PatchEvent *>( event );
-    CHECK_DYNAMIC_CAST( patchEvent, "ZyppHistoryEvents::PatchEvent" );
+    QTreeWidgetItem * item = _ui->timeLineTree->currentItem();
 
-    item->setText( NameCol,     _( "Patch %1" ).arg( patchEvent->name ) );
-    item->setText( VersionCol,  patchEvent->version   );
-    item->setText( ArchCol,     patchEvent->arch      );
-    item->setText( RepoCol,     patchEvent->repoAlias );
+    if ( item )
+        timeLineClicked( item );
 }
 
 
@@ -516,69 +546,98 @@ void ZyppHistoryBrowser::setColWidths()
     QFontMetrics  fontMetrics( _ui->eventsTree->font() );
     QHeaderView * header     ( _ui->eventsTree->header() );
 
-    header->resizeSection( NameCol,    fontMetrics.horizontalAdvance( longPkgName ) );
-    header->resizeSection( VersionCol, fontMetrics.horizontalAdvance( longVersion ) );
-    header->resizeSection( ArchCol,    fontMetrics.horizontalAdvance( longArch    ) );
-    header->resizeSection( RepoCol,    fontMetrics.horizontalAdvance( longRepo    ) );
+    header->resizeSection( ZyppHistoryEventsModel::NameCol,    fontMetrics.horizontalAdvance( longPkgName ) );
+    header->resizeSection( ZyppHistoryEventsModel::VersionCol, fontMetrics.horizontalAdvance( longVersion ) );
+    header->resizeSection( ZyppHistoryEventsModel::ArchCol,    fontMetrics.horizontalAdvance( longArch    ) );
+    header->resizeSection( ZyppHistoryEventsModel::RepoCol,    fontMetrics.horizontalAdvance( longRepo    ) );
 }
 
 
-EventList
-ZyppHistoryBrowser::events()
+const EventStore &
+ZyppHistoryBrowser::events() const
 {
-    if ( _filter )
-    {
-        if ( _filteredEventsDirty )
-            filterEvents();
+    return ZyppHistory::instance()->events();
+}
 
-        return _filteredEvents;
-    }
-    else  // ! _filter
-    {
-        return ZyppHistory::instance()->events();
-    }
+
+const QVector<int> &
+ZyppHistoryBrowser::commands()
+{
+    if ( _filteredEventsDirty )
+        filterEvents();
+
+    return _commands;
 }
 
 
 void ZyppHistoryBrowser::filterEvents()
 {
-    _filteredEvents.clear();
+    const EventStore & events = this->events();
+
+    _commands.clear();
+    _filterMatches.clear();
     _filteredEventsDirty = false;
 
     if ( ! _filter )
+    {
+        _commands.reserve( events.commandCount() );
+
+        for ( int cmdNo = 0; cmdNo < events.commandCount(); cmdNo++ )
+            _commands << cmdNo;
+
         return;
+    }
 
     // Need a reference to avoid an awkward functor call via the pointer:
-    //   _filter->operator()( event );
+    //   _filter->operator()( events, eventNo );
     // ...ugh...
     // With the reference, this works as a functor should:
-    //   filter( event );
+    //   filter( events, eventNo );
 
     ZyppHistoryFilter & filter( *_filter );
+    filter.prepare( events );
+    _filterMatches.resize( events.eventCount() );
 
-    for ( Event * event: ZyppHistory::instance()->events() )
+    QVector<int> candidates;
+
+    if ( filter.candidates( events, candidates ) )
     {
-        CommandEvent * commandEvent = dynamic_cast<CommandEvent *>( event );
+        // Only check the events that the index found
 
-        if ( commandEvent )
+        for ( int eventNo: candidates )
         {
-            CommandEvent * clone = commandEvent->shallowClone();
-            clone->dontDeleteChildEvents();
-
-            for ( Event * childEvent: commandEvent->childEvents() )
+            if ( filter( events, eventNo ) )
             {
-                if ( filter( childEvent ) )
-                    clone->addChildEvent( childEvent );
+                _filterMatches.setBit( eventNo );
+                int cmdNo = events.commandOf( eventNo );
+
+                if ( _commands.isEmpty() || _commands.last() != cmdNo )
+                    _commands << cmdNo;
             }
+        }
+
+        return;
+    }
+
+    for ( int cmdNo = 0; cmdNo < events.commandCount(); cmdNo++ )
+    {
+        bool haveMatch = false;
 
-            if ( clone->hasChildEvents() )
-                _filteredEvents << clone;
-            else
-                delete clone;
+        for ( int eventNo = events.firstEvent( cmdNo ); eventNo < events.endEvent( cmdNo ); eventNo++ )
+        {
+            if ( filter( events, eventNo ) )
+            {
+                _filterMatches.setBit( eventNo );
+                haveMatch = true;
+            }
         }
+
+        if ( haveMatch )
+            _commands << cmdNo;
     }
 }
 
+
 void ZyppHistoryBrowser::setFilter( ZyppHistoryFilter * newFilter )
 {
     if ( _filter )
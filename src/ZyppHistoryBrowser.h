@@ -17,7 +17,10 @@
 #ifndef ZyppHistoryBrowser_h
 #define ZyppHistoryBrowser_h
 
+#include <QBitArray>
 #include <QDialog>
+#include <QVector>
+
 #include "ZyppHistoryEvents.h"
 
 
@@ -30,6 +33,8 @@
 
 
 class QTreeWidgetItem;
+class ZyppHistoryEventsModel;
+class ZyppHistoryLoader;
 class ZyppHistoryFilterDialog;
 class ZyppHistoryFilter;
 
@@ -72,6 +77,28 @@ protected slots:
 
     void clearFilter();
 
+    /**
+     * Notification that the events model inserted child rows, i.e. that the
+     * child events of a command were fetched.
+     **/
+    void eventRowsInserted( const QModelIndex & parent, int first, int last );
+
+    /**
+     * Notification that the history loader has more (older) events, or that
+     * they are complete.
+     **/
+    void eventsLoaded();
+
+    /**
+     * Show the progress of the history loader in the status area.
+     **/
+    void showLoadProgress( qint64 bytesParsed, qint64 bytesTotal, qint64 millisec );
+
+    /**
+     * Notification that the history loader failed.
+     **/
+    void loadFailed();
+
 
 protected:
 
@@ -79,6 +106,17 @@ protected:
     void populate();
     void populateTimeLineTree();
     void selectLastTimeLineItem();
+
+    /**
+     * Select the timeline item for 'date' if there is one and it is enabled.
+     * Return 'true' on success.
+     **/
+    bool selectTimeLineItem( const QString & date );
+
+    /**
+     * Clear the timeline tree and the events tree.
+     **/
+    void clearTrees();
     void setColWidths();
     void updateCurrentFilterLabel();
 
@@ -87,6 +125,14 @@ protected:
      **/
     void populateEventsTree( const QString & date );
 
+    /**
+     * Return the first or the last day of a date range from the timeline
+     * tree: "2025-12-28" (a single day), "2025-12" (a month), "2025" (a
+     * year).
+     **/
+    static ZyppHistoryEvents::Day dayRangeStart( const QString & date );
+    static ZyppHistoryEvents::Day dayRangeEnd  ( const QString & date );
+
     /**
      * Return a list of unique dates of the timestamps of the toplevel (usually
      * command) zypp history events.
@@ -107,37 +153,21 @@ protected:
                             const QStringList & stringList ) const;
 
     /**
-     * Create a QTreeWidgetItem for the given zypp history event and add it as
-     * a child item to 'parentItem' if specified, or as a toplevel item to the
-     * event tree widget.
-     *
-     * Events that have child events (like CommandEvent) will call this
-     * recursively.
+     * Return the zypp history events.
      **/
-    void addEventItem( ZyppHistoryEvents::Event * event,
-                       QTreeWidgetItem          * parentItem = 0 );
-
-
-    void fillCommandItem( QTreeWidgetItem * item, ZyppHistoryEvents::Event * event );
-    void fillPkgItem    ( QTreeWidgetItem * item, ZyppHistoryEvents::Event * event );
-    void fillRepoItem   ( QTreeWidgetItem * item, ZyppHistoryEvents::Event * event );
-    void fillPatchItem  ( QTreeWidgetItem * item, ZyppHistoryEvents::Event * event );
+    const ZyppHistoryEvents::EventStore & events() const;
 
     /**
-     * Return the zypp history events, possibly with any filters applied.
+     * Return the numbers of the commands to display, i.e. the commands with
+     * any child events that pass the filter.
      **/
-    ZyppHistoryEvents::EventList events();
+    const QVector<int> & commands();
 
     /**
      * Filter all events
      **/
     void filterEvents();
 
-    /**
-     * Filter one event. Return 'true' to keep this event, 'false' if not.
-     **/
-    bool filterEvent( ZyppHistoryEvents::Event * event );
-
     /**
      * Set a new ZyppHistoryFilter and delete the old one if non-null.
      **/
@@ -154,7 +184,10 @@ protected:
     int                          _trivialPkgInstallCount;
     int                          _trivialPkgRemoveCount;
 
-    ZyppHistoryEvents::EventList _filteredEvents;
+    QVector<int>                 _commands;          // see commands()
+    QBitArray                    _filterMatches;     // by event number
+    ZyppHistoryEventsModel  *    _eventsModel;
+    ZyppHistoryLoader       *    _loader;
     bool                         _filteredEventsDirty;
     ZyppHistoryFilterDialog *    _filterDialog;
     ZyppHistoryFilter       *    _filter;
@@ -14,51 +14,526 @@
  */
 
 
+#include <algorithm>
+
+#include <QDataStream>
+
 #include "ZyppHistoryEvents.h"
 #include "Exception.h"
 
+#define TIMESTAMP_DIGITS    14  // "2025-12-28 14:15:26"
+
 using namespace ZyppHistoryEvents;
 
 
-QString Event::date() const
+Timestamp ZyppHistoryEvents::packTimestamp( QByteArrayView str )
+{
+    Timestamp timestamp = 0;
+    int       digits    = 0;
+
+    for ( char c: str )
+    {
+        if ( c >= '0' && c <= '9' )
+        {
+            timestamp = timestamp * 10 + ( c - '0' );
+            digits++;
+        }
+        else if ( c != '-' && c != ' ' && c != ':' )
+        {
+            return 0;
+        }
+    }
+
+    return digits == TIMESTAMP_DIGITS ? timestamp : 0;
+}
+
+
+QString ZyppHistoryEvents::timestampString( Timestamp timestamp )
+{
+    return dateString( timestamp ) + " " + timeString( timestamp );
+}
+
+
+QString ZyppHistoryEvents::dateString( Timestamp timestamp )
+{
+    // 20251228141526 -> "2025-12-28"
+    Timestamp date = timestamp / 1000000;
+
+    return QString::asprintf( "%04d-%02d-%02d",
+                              (int) ( date / 10000 ),
+                              (int) ( date / 100 % 100 ),
+                              (int) ( date % 100 ) );
+}
+
+
+QString ZyppHistoryEvents::timeString( Timestamp timestamp )
+{
+    // 20251228141526 -> "14:15:26"
+    Timestamp time = timestamp % 1000000;
+
+    return QString::asprintf( "%02d:%02d:%02d",
+                              (int) ( time / 10000 ),
+                              (int) ( time / 100 % 100 ),
+                              (int) ( time % 100 ) );
+}
+
+
+
+
+EventStore::EventStore()
+    : _indexesDirty( true )
+{
+    clear();
+}
+
+
+void EventStore::clear()
+{
+    _strings.clear();
+    _stringIds.clear();
+
+    _timestamps.clear();
+    _eventTypes.clear();
+    _names.clear();
+    _versions.clear();
+    _archs.clear();
+    _repos.clear();
+    _patchStates.clear();
+
+    _commandTimestamps.clear();
+    _commands.clear();
+    _rawCommands.clear();
+    _commandFirstEvents.clear();
+
+    _indexesDirty = true;
+    _dayCommands.clear();
+    _pkgNameEvents.clear();
+    _pkgRepoEvents.clear();
+
+    addString( "" );  // StringId 0
+}
+
+
+void EventStore::squeeze()
 {
-    // timestamp:  "2025-12-28 14:15:26" -> "2025-12-28"
-    return timestamp.section( ' ', 0, 0 );
+    _strings.squeeze();
+
+    _timestamps.squeeze();
+    _eventTypes.squeeze();
+    _names.squeeze();
+    _versions.squeeze();
+    _archs.squeeze();
+    _repos.squeeze();
+    _patchStates.squeeze();
+
+    _commandTimestamps.squeeze();
+    _commands.squeeze();
+    _rawCommands.squeeze();
+    _commandFirstEvents.squeeze();
 }
 
 
+void EventStore::truncate( int commandCount, int eventCount )
+{
+    _indexesDirty = true;
+
+    if ( commandCount < this->commandCount() )
+    {
+        _commandTimestamps.resize ( commandCount );
+        _commands.resize          ( commandCount );
+        _rawCommands.resize       ( commandCount );
+        _commandFirstEvents.resize( commandCount );
+    }
+
+    if ( eventCount < this->eventCount() )
+    {
+        _timestamps.resize( eventCount );
+        _eventTypes.resize( eventCount );
+        _names.resize     ( eventCount );
+        _versions.resize  ( eventCount );
+        _archs.resize     ( eventCount );
+        _repos.resize     ( eventCount );
 
-QString Event::time() const
+        QHash<int, StringId>::iterator it = _patchStates.begin();
+
+        while ( it != _patchStates.end() )
+        {
+            if ( it.key() >= eventCount )
+                it = _patchStates.erase( it );
+            else
+                ++it;
+        }
+    }
+}
+
+
+StringId EventStore::addString( const QString & str )
 {
-    // timestamp:  "2025-12-28 14:15:26" -> "14:15:26"
-    return timestamp.section( ' ', 1, 1 );
+    QHash<QString, StringId>::const_iterator it = _stringIds.constFind( str );
+
+    if ( it != _stringIds.constEnd() )
+        return it.value();
+
+    StringId id = _strings.size();
+    _strings << str;
+    _stringIds.insert( str, id );
+
+    return id;
 }
 
 
+void EventStore::addCommand( Timestamp timestamp,
+                             StringId  command,
+                             StringId  rawCommand )
+{
+    _commandTimestamps  << timestamp;
+    _commands           << command;
+    _rawCommands        << rawCommand;
+    _commandFirstEvents << eventCount();
+    _indexesDirty = true;
+}
+
 
-void ParentEvent::addChildEvent( Event * childEvent )
+void EventStore::dropEmptyLastCommand()
 {
-    if ( childEvent )
-        _childEvents << childEvent;
+    if ( isEmpty() || childEventsCount( commandCount() - 1 ) > 0 )
+        return;
+
+    _commandTimestamps.removeLast();
+    _commands.removeLast();
+    _rawCommands.removeLast();
+    _commandFirstEvents.removeLast();
+    _indexesDirty = true;
 }
 
 
-ParentEvent::~ParentEvent()
+void EventStore::addEvent( EventType eventType,
+                           Timestamp timestamp,
+                           StringId  name,
+                           StringId  version,
+                           StringId  arch,
+                           StringId  repoAlias )
 {
-    if ( _doDelete )
-        qDeleteAll( _childEvents );
+    if ( isEmpty() )
+        THROW( Exception( "Zypp history event without a command" ) );
+
+    _timestamps << timestamp;
+    _eventTypes << (quint8) eventType;
+    _names      << name;
+    _versions   << version;
+    _archs      << arch;
+    _repos      << repoAlias;
+    _indexesDirty = true;
 }
 
 
-CommandEvent *
-CommandEvent::shallowClone()
+void EventStore::addPkgEvent( EventType eventType,
+                              Timestamp timestamp,
+                              StringId  name,
+                              StringId  version,
+                              StringId  arch,
+                              StringId  repoAlias )
 {
-    CommandEvent * clone = new CommandEvent;
-    CHECK_NEW( clone );
+    addEvent( eventType, timestamp, name, version, arch, repoAlias );
+}
+
+
+void EventStore::addPatchEvent( Timestamp timestamp,
+                                StringId  name,
+                                StringId  version,
+                                StringId  arch,
+                                StringId  repoAlias,
+                                StringId  patchState )
+{
+    addEvent( EventType::Patch, timestamp, name, version, arch, repoAlias );
+
+    if ( patchState != 0 )
+        _patchStates.insert( eventCount() - 1, patchState );
+}
+
+
+void EventStore::addRepoEvent( EventType eventType,
+                               Timestamp timestamp,
+                               StringId  repoAlias,
+                               StringId  url,
+                               StringId  oldRepoAlias,
+                               StringId  oldUrl )
+{
+    // See the column usage in the class description
+
+    addEvent( eventType, timestamp,
+              url,            // name column
+              oldUrl,         // version column
+              oldRepoAlias,   // arch column
+              repoAlias );
+}
+
+
+void EventStore::append( const EventStore & other, bool continueLastCommand )
+{
+    QVector<StringId> ids;  // other's string IDs -> ours
+    ids.reserve( other.stringCount() );
+
+    for ( const QString & str: other._strings )
+        ids << addString( str );
+
+    int eventCount = this->eventCount() + other.eventCount();
+
+    _timestamps.reserve( eventCount );
+    _eventTypes.reserve( eventCount );
+    _names.reserve     ( eventCount );
+    _versions.reserve  ( eventCount );
+    _archs.reserve     ( eventCount );
+    _repos.reserve     ( eventCount );
+
+    int cmdNo = 0;
+
+    if ( continueLastCommand && ! isEmpty() && other.commandCount() > 0 )
+    {
+        appendEvents( other, other.firstEvent( 0 ), other.endEvent( 0 ), ids );
+        cmdNo = 1;
+    }
+
+    dropEmptyLastCommand();
 
-    clone->timestamp  = this->timestamp;
-    clone->command    = this->command;
-    clone->rawCommand = this->rawCommand;
+    for ( ; cmdNo < other.commandCount(); cmdNo++ )
+    {
+        addCommand( other._commandTimestamps.at( cmdNo ),
+                    ids.at( other._commands.at( cmdNo ) ),
+                    ids.at( other._rawCommands.at( cmdNo ) ) );
+
+        appendEvents( other, other.firstEvent( cmdNo ), other.endEvent( cmdNo ), ids );
+    }
+}
+
+
+void EventStore::appendEvents( const EventStore &        other,
+                               int                       from,
+                               int                       to,
+                               const QVector<StringId> & ids )
+{
+    for ( int eventNo = from; eventNo < to; eventNo++ )
+    {
+        StringId patchState = other._patchStates.value( eventNo, 0 );
+
+        if ( patchState != 0 )
+            _patchStates.insert( this->eventCount(), ids.at( patchState ) );
+
+        _timestamps << other._timestamps.at( eventNo );
+        _eventTypes << other._eventTypes.at( eventNo );
+        _names      << ids.at( other._names.at( eventNo )    );
+        _versions   << ids.at( other._versions.at( eventNo ) );
+        _archs      << ids.at( other._archs.at( eventNo )    );
+        _repos      << ids.at( other._repos.at( eventNo )    );
+    }
+
+    _indexesDirty = true;
+}
+
+
+void EventStore::write( QDataStream & stream ) const
+{
+    stream << _strings
+           << _timestamps
+           << _eventTypes
+           << _names
+           << _versions
+           << _archs
+           << _repos
+           << _patchStates
+           << _commandTimestamps
+           << _commands
+           << _rawCommands
+           << _commandFirstEvents;
+}
+
+
+bool EventStore::read( QDataStream & stream )
+{
+    clear();
+    _strings.clear();
+    _stringIds.clear();
+
+    stream >> _strings
+           >> _timestamps
+           >> _eventTypes
+           >> _names
+           >> _versions
+           >> _archs
+           >> _repos
+           >> _patchStates
+           >> _commandTimestamps
+           >> _commands
+           >> _rawCommands
+           >> _commandFirstEvents;
+
+    if ( stream.status() != QDataStream::Ok || ! isConsistent() )
+    {
+        clear();
+        return false;
+    }
+
+    _stringIds.reserve( _strings.size() );
+
+    for ( int id = 0; id < _strings.size(); id++ )
+        _stringIds.insert( _strings.at( id ), id );
+
+    return true;
+}
+
+
+bool EventStore::isConsistent() const
+{
+    int events   = _eventTypes.size();
+    int commands = _commandTimestamps.size();
+    int strings  = _strings.size();
+
+    if ( strings == 0 || ! _strings.first().isEmpty() )
+        return false;
+
+    if ( _timestamps.size() != events ||
+         _names.size()      != events ||
+         _versions.size()   != events ||
+         _archs.size()      != events ||
+         _repos.size()      != events   )
+    {
+        return false;
+    }
+
+    if ( _commands.size()           != commands ||
+         _rawCommands.size()        != commands ||
+         _commandFirstEvents.size() != commands   )
+    {
+        return false;
+    }
+
+    if ( events > 0 && commands == 0 )
+        return false;
+
+    for ( int eventNo = 0; eventNo < events; eventNo++ )
+    {
+        if ( _names.at( eventNo )    >= (StringId) strings ||
+             _versions.at( eventNo ) >= (StringId) strings ||
+             _archs.at( eventNo )    >= (StringId) strings ||
+             _repos.at( eventNo )    >= (StringId) strings   )
+        {
+            return false;
+        }
+    }
+
+    for ( QHash<int, StringId>::const_iterator it = _patchStates.constBegin();
+          it != _patchStates.constEnd();
+          ++it )
+    {
+        if ( it.key() < 0 || it.key() >= events || it.value() >= (StringId) strings )
+            return false;
+    }
+
+    int lastFirstEvent = 0;
+
+    for ( int cmdNo = 0; cmdNo < commands; cmdNo++ )
+    {
+        int firstEvent = _commandFirstEvents.at( cmdNo );
+
+        if ( firstEvent < lastFirstEvent || firstEvent > events )
+            return false;
+
+        if ( _commands.at( cmdNo )    >= (StringId) strings ||
+             _rawCommands.at( cmdNo ) >= (StringId) strings   )
+        {
+            return false;
+        }
+
+        lastFirstEvent = firstEvent;
+    }
+
+    return commands == 0 || _commandFirstEvents.first() == 0;
+}
+
+
+int EventStore::commandOf( int eventNo ) const
+{
+    // The last command that starts at or before this event
+
+    QVector<int>::const_iterator it = std::upper_bound( _commandFirstEvents.cbegin(),
+                                                        _commandFirstEvents.cend(),
+                                                        eventNo );
+    return ( it - _commandFirstEvents.cbegin() ) - 1;
+}
+
+
+void EventStore::ensureIndexes() const
+{
+    if ( ! _indexesDirty )
+        return;
+
+    _dayCommands.clear();
+    _pkgNameEvents.clear();
+    _pkgRepoEvents.clear();
+
+    for ( int cmdNo = 0; cmdNo < commandCount(); cmdNo++ )
+        _dayCommands[ dayOf( _commandTimestamps.at( cmdNo ) ) ] << cmdNo;
+
+    for ( int eventNo = 0; eventNo < eventCount(); eventNo++ )
+    {
+        switch ( eventType( eventNo ) )
+        {
+            case EventType::PkgInstall:
+            case EventType::PkgRemove:
+                _pkgNameEvents[ _names.at( eventNo ) ] << eventNo;
+                _pkgRepoEvents[ _repos.at( eventNo ) ] << eventNo;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    _indexesDirty = false;
+}
+
+
+QList<Day> EventStore::days() const
+{
+    ensureIndexes();
+
+    return _dayCommands.keys();
+}
+
+
+QVector<int> EventStore::commandsInDays( Day fromDay, Day toDay ) const
+{
+    ensureIndexes();
+
+    QVector<int> result;
+
+    for ( QMap<Day, QVector<int> >::const_iterator it = _dayCommands.lowerBound( fromDay );
+          it != _dayCommands.constEnd() && it.key() <= toDay;
+          ++it )
+    {
+        result << it.value();
+    }
+
+    // Only needed if the clock was turned back at some time
+    std::sort( result.begin(), result.end() );
+
+    return result;
+}
+
+
+const EventStore::PostingLists &
+EventStore::pkgNameIndex() const
+{
+    ensureIndexes();
+
+    return _pkgNameEvents;
+}
+
+
+const EventStore::PostingLists &
+EventStore::pkgRepoIndex() const
+{
+    ensureIndexes();
 
-    return clone;
+    return _pkgRepoEvents;
 }
@@ -17,9 +17,15 @@
 #define ZyppHistoryEvents_h
 
 
-#include <QString>
+#include <QByteArrayView>
+#include <QHash>
 #include <QList>
-#include <QtAlgorithms>  // qDeleteAll()
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+
+class QDataStream;
 
 
 /**
@@ -42,149 +48,324 @@ namespace ZyppHistoryEvents
         Patch          //   patch
     };
 
+
     /**
-     * Base class for all the events
+     * A timestamp packed into a 64 bit integer with the decimal digits of
+     * "2025-12-28 14:15:26", i.e. 20251228141526. Those can be compared like
+     * the original strings.
      **/
-    struct Event
-    {
-        QString   timestamp;    // "2025-12-28 14:15:26"
-        EventType eventType;
+    typedef quint64 Timestamp;
 
-        QString date() const;   // "2025-12-28"
-        QString time() const;   // "14:15:26"
+    /**
+     * Pack a timestamp string like "2025-12-28 14:15:26".
+     * Return 0 if this is not a valid timestamp.
+     **/
+    Timestamp packTimestamp( QByteArrayView str );
 
-        virtual ~Event() {}     // To make it polymorphic for dynamic_cast
-    };
+    /**
+     * The day of a timestamp as an integer with the decimal digits of
+     * "2025-12-28", i.e. 20251228.
+     **/
+    typedef quint32 Day;
+
+    inline Day dayOf( Timestamp timestamp ) { return (Day) ( timestamp / 1000000 ); }
 
+    QString timestampString( Timestamp timestamp );  // "2025-12-28 14:15:26"
+    QString dateString     ( Timestamp timestamp );  // "2025-12-28"
+    QString timeString     ( Timestamp timestamp );  // "14:15:26"
 
-    typedef QList<Event *> EventList;
+
+    /**
+     * Index of a string in the string table of an EventStore.
+     * 0 is always the empty string.
+     **/
+    typedef quint32 StringId;
 
 
     /**
-     * Base class for events that can have child events, like CommandEvent.
+     * Columnar storage for all the zypp history events.
      *
-     * Child Events are the events triggered in that command or session,
-     * i.e. with a single 'zypper' command, or in a single Myrlyn or YaST
-     * session; or the PkgEvents (PkgInstallEvent, PkgRemoveEvent)
+     * Events are numbered 0..eventCount()-1 in the order of the history file,
+     * and each column is a flat array indexed by that event number. Strings
+     * are only stored once in the string table; the columns only contain
+     * their IDs. A long history has hundreds of thousands of events, but only
+     * a few thousand different package names, versions, archs and repo
+     * aliases.
+     *
+     * Commands (the commands or command sessions like 'zypper in xhost' or a
+     * Myrlyn or YaST session) are stored separately, numbered
+     * 0..commandCount()-1. Their child events are all the events from
+     * firstEvent() to endEvent() - 1.
+     *
+     * Package and patch events use the name, version, arch and repo alias
+     * columns. Repo events use the repo alias column for the (new) repo alias
+     * and the other columns for the URL, the old URL and the old repo alias;
+     * use the accessors for the event type to avoid any confusion.
      **/
-    struct ParentEvent: public Event
+    class EventStore
     {
-        const EventList & childEvents() { return _childEvents; }
+    public:
 
-        qsizetype childEventsCount() const { return   _childEvents.size();    }
-        bool      hasChildEvents()   const { return ! _childEvents.isEmpty(); }
+        /**
+         * Constructor: Create an empty event store.
+         **/
+        EventStore();
 
         /**
-         * Add a child event. This class takes over ownership of the child and
-         * will delete it in its destructor.
+         * Remove all events, commands and strings.
          **/
-        void addChildEvent( Event * childEvent );
+        void clear();
 
         /**
-         * Release any unused memory in the childEvents list.
-         *
-         * This is useful because QList optimizes memory allocation by
-         * reserving more capacity in advance to avoid repeatedly re-allocating
-         * the the space for its items. But when we know for sure that we are
-         * not going to add any more items, we can tell it to release all
-         * reserved slots that are not yet used.
-         *
-         * As the zypp history file is parsed, the next "command" or "patch"
-         * line marks the end of the previous one, so we can "finalize" that
-         * previous command or patch by calling this method.
+         * Release any unused memory in the columns.
          **/
-        void squeezeChildEvents() { _childEvents.squeeze(); }
+        void squeeze();
 
         /**
-         * Don't delete the child events in the destructor.
+         * Remove all commands from 'commandCount' on and all events from
+         * 'eventCount' on. The strings are kept.
          **/
-        void dontDeleteChildEvents() { _doDelete = false; }
+        void truncate( int commandCount, int eventCount );
+
+        bool isEmpty() const { return _commandTimestamps.isEmpty(); }
+
+
+        //
+        // Strings
+        //
 
         /**
-         * Constructor.
+         * Return the ID of 'str'. Add it to the string table if it's not
+         * there yet.
          **/
-        ParentEvent(): _doDelete( true ) {}
+        StringId addString( const QString & str );
+
+        const QString & string( StringId id ) const { return _strings.at( id ); }
+
+        int stringCount() const { return _strings.size(); }
+
+
+        //
+        // Events
+        //
+
+        int eventCount() const { return _eventTypes.size(); }
+
+        EventType eventType( int eventNo ) const
+            { return (EventType) _eventTypes.at( eventNo ); }
+
+        Timestamp timestamp( int eventNo ) const
+            { return _timestamps.at( eventNo ); }
+
+        // Package and patch events
+
+        StringId nameId     ( int eventNo ) const { return _names.at( eventNo );   }
+        StringId versionId  ( int eventNo ) const { return _versions.at( eventNo ); }
+        StringId archId     ( int eventNo ) const { return _archs.at( eventNo );   }
+        StringId repoAliasId( int eventNo ) const { return _repos.at( eventNo );   }
+
+        const QString & name     ( int eventNo ) const { return string( nameId     ( eventNo ) ); }
+        const QString & version  ( int eventNo ) const { return string( versionId  ( eventNo ) ); }
+        const QString & arch     ( int eventNo ) const { return string( archId     ( eventNo ) ); }
+        const QString & repoAlias( int eventNo ) const { return string( repoAliasId( eventNo ) ); }
+
+        // Patch events only
+
+        const QString & patchState( int eventNo ) const
+            { return string( _patchStates.value( eventNo, 0 ) ); }
+
+        // Repo events only (repoAlias() is also valid for them)
+
+        const QString & url         ( int eventNo ) const { return string( _names.at( eventNo )    ); }
+        const QString & oldUrl      ( int eventNo ) const { return string( _versions.at( eventNo ) ); }
+        const QString & oldRepoAlias( int eventNo ) const { return string( _archs.at( eventNo )    ); }
+
+
+        //
+        // Commands
+        //
+
+        int commandCount() const { return _commandTimestamps.size(); }
+
+        Timestamp commandTimestamp( int cmdNo ) const
+            { return _commandTimestamps.at( cmdNo ); }
+
+        StringId commandId( int cmdNo ) const { return _commands.at( cmdNo ); }
+
+        const QString & command   ( int cmdNo ) const { return string( _commands.at( cmdNo )    ); }
+        const QString & rawCommand( int cmdNo ) const { return string( _rawCommands.at( cmdNo ) ); }
 
         /**
-         * Destructor. This deletes all child events
-         * unless _doDelete is false.
+         * Return the number of the first child event of a command.
          **/
-        virtual ~ParentEvent();
+        int firstEvent( int cmdNo ) const { return _commandFirstEvents.at( cmdNo ); }
 
-    protected:
+        /**
+         * Return the number of the event after the last child event of a
+         * command.
+         **/
+        int endEvent( int cmdNo ) const
+        {
+            return cmdNo + 1 < commandCount() ?
+                _commandFirstEvents.at( cmdNo + 1 ) : eventCount();
+        }
 
-        EventList _childEvents;
-        bool      _doDelete;
-    };
+        int childEventsCount( int cmdNo ) const
+            { return endEvent( cmdNo ) - firstEvent( cmdNo ); }
 
+        /**
+         * Return the number of the command that event number 'eventNo'
+         * belongs to.
+         **/
+        int commandOf( int eventNo ) const;
 
-    /**
-     * The command / command session event; the only type of event that can
-     * have child events. Those are the events triggered in that command or
-     * session, i.e. with a single 'zypper' command, or in a single Myrlyn or
-     * YaST session.
-     **/
-    struct CommandEvent: public ParentEvent
-    {
-        QString command;     // "YaST sw_single", "zypper in qdirstat ..."
-        QString rawCommand;  // "/usr/bin/ruby3.3 /usr/lib/YaST2/bin/y2start sw_single qt"
 
-        CommandEvent() { eventType = EventType::Command; }
+        //
+        // Indexes. They are built when they are needed for the first time
+        // after the events were changed.
+        //
 
         /**
-         * Create a shallow clone of this without any children.
-         * Ownership is transferred to the caller.
+         * Return the days with any commands in ascending order.
          **/
-        CommandEvent * shallowClone();
+        QList<Day> days() const;
 
-    private:
+        /**
+         * Return the numbers of the commands from day 'fromDay' to day 'toDay'
+         * (inclusive) in ascending order.
+         **/
+        QVector<int> commandsInDays( Day fromDay, Day toDay ) const;
 
-        // Disable copy constructor and assignment operator
-        CommandEvent( const CommandEvent & other );
-        CommandEvent operator==( const CommandEvent & other );
-    };
+        typedef QHash<StringId, QVector<int> > PostingLists;
 
+        /**
+         * Return the numbers of the package events (PkgInstall, PkgRemove)
+         * for each package name string ID in ascending order.
+         **/
+        const PostingLists & pkgNameIndex() const;
 
-    /**
-     * Package events: PkgInstallEvent, PkgRemoveEvent. Notice that the zypper
-     * history does not make a difference between installing and updating a
-     * package.
-     **/
-    struct PkgEvent: public Event
-    {
-        QString name;
-        QString version;
-        QString arch;
-        QString repoAlias;
-    };
+        /**
+         * Return the numbers of the package events (PkgInstall, PkgRemove)
+         * for each repo alias string ID in ascending order.
+         **/
+        const PostingLists & pkgRepoIndex() const;
 
 
-    /**
-     * Repo events: RepoAddEvent, RepoRemoveEvent, RepoUrlEvent, RepoAliasEvent.
-     *
-     * Those may or may not be interesting for the user, but they are in the
-     * zypp history, so they are preserved here.
-     **/
-    struct RepoEvent: public Event
-    {
-        QString repoAlias;
-        QString url;
+        //
+        // Adding commands and events. Events are always child events of the
+        // last command, so there has to be one before adding any events.
+        //
 
-        QString oldRepoAlias;
-        QString oldUrl;
-    };
+        void addCommand( Timestamp timestamp,
+                         StringId  command,
+                         StringId  rawCommand );
 
+        /**
+         * Remove the last command if it has no child events.
+         **/
+        void dropEmptyLastCommand();
+
+        void addPkgEvent( EventType eventType,
+                          Timestamp timestamp,
+                          StringId  name,
+                          StringId  version,
+                          StringId  arch,
+                          StringId  repoAlias );
+
+        void addPatchEvent( Timestamp timestamp,
+                            StringId  name,
+                            StringId  version,
+                            StringId  arch,
+                            StringId  repoAlias,
+                            StringId  patchState );
+
+        void addRepoEvent( EventType eventType,
+                           Timestamp timestamp,
+                           StringId  repoAlias,
+                           StringId  url,
+                           StringId  oldRepoAlias = 0,
+                           StringId  oldUrl       = 0 );
 
-    /**
-     * Patch events.
-     **/
-    struct PatchEvent: public Event
-    {
-        QString name;
-        QString version;
-        QString arch;
-        QString repoAlias;
-        QString patchState;  // "applied", "needed"
+        /**
+         * Append all commands and events of 'other', e.g. from parsing
+         * the next part of the same file.
+         *
+         * If 'continueLastCommand' is 'true', the first command of 'other'
+         * is only a bracket for events that really belong to the last
+         * command here, so its events are added to that command instead.
+         * After that, the last command is dropped if it has no child events.
+         **/
+        void append( const EventStore & other, bool continueLastCommand );
+
+        /**
+         * Write the content to 'stream'.
+         **/
+        void write( QDataStream & stream ) const;
+
+        /**
+         * Read the content from 'stream'. Return 'true' on success, 'false'
+         * if there was an error or if the data are inconsistent. In that case,
+         * the store is empty.
+         **/
+        bool read( QDataStream & stream );
+
+    protected:
+
+        /**
+         * Return 'true' if all the columns have the right size and all string
+         * IDs and event ranges are valid.
+         **/
+        bool isConsistent() const;
+
+        /**
+         * Build the indexes if they are outdated.
+         **/
+        void ensureIndexes() const;
+
+        /**
+         * Append the events 'from' to 'to' - 1 of 'other' with their string
+         * IDs mapped by 'ids'.
+         **/
+        void appendEvents( const EventStore &        other,
+                           int                       from,
+                           int                       to,
+                           const QVector<StringId> & ids );
+
+        void addEvent( EventType eventType,
+                       Timestamp timestamp,
+                       StringId  name,
+                       StringId  version,
+                       StringId  arch,
+                       StringId  repoAlias );
+
+        // Strings
+
+        QVector<QString>          _strings;
+        QHash<QString, StringId>  _stringIds;
+
+        // Events
+
+        QVector<Timestamp>        _timestamps;
+        QVector<quint8>           _eventTypes;
+        QVector<StringId>         _names;
+        QVector<StringId>         _versions;
+        QVector<StringId>         _archs;
+        QVector<StringId>         _repos;
+        QHash<int, StringId>      _patchStates;  // Only for the few patch events
+
+        // Commands
+
+        QVector<Timestamp>        _commandTimestamps;
+        QVector<StringId>         _commands;
+        QVector<StringId>         _rawCommands;
+        QVector<int>              _commandFirstEvents;
+
+        // Indexes (see ensureIndexes())
+
+        mutable bool                        _indexesDirty;
+        mutable QMap<Day, QVector<int> >    _dayCommands;   // day -> command numbers
+        mutable PostingLists                _pkgNameEvents; // name ID -> event numbers
+        mutable PostingLists                _pkgRepoEvents; // repo alias ID -> event numbers
     };
 
 }  // namespace ZyppHistoryEvents
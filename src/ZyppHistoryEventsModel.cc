@@ -0,0 +1,418 @@
+/*  ---------------------------------------------------------
+               __  __            _
+              |  \/  |_   _ _ __| |_   _ _ __
+              | |\/| | | | | '__| | | | | '_ \
+              | |  | | |_| | |  | | |_| | | | |
+              |_|  |_|\__, |_|  |_|\__, |_| |_|
+                      |___/        |___/
+    ---------------------------------------------------------
+
+    Project:  Myrlyn Package Manager GUI
+    Copyright (c) Stefan Hundhammer <Stefan.Hundhammer@gmx.de>
+    License:  GPL V2 - See file LICENSE for details.
+
+ */
+
+
+#include <QFont>
+
+#include "YQi18n.h"
+#include "YQIconPool.h"
+#include "ZyppHistoryEventsModel.h"
+
+
+using namespace ZyppHistoryEvents;
+
+
+// The internal ID of a model index is 0 for a command (toplevel) row and the
+// command row + 1 for a child event row.
+
+
+ZyppHistoryEventsModel::ZyppHistoryEventsModel( const EventStore & events,
+                                                QObject *          parent )
+    : QAbstractItemModel( parent )
+    , _events( events )
+    , _showPlusMinusCount( true )
+    , _trivialInstallCount( 0 )
+    , _trivialRemoveCount( 0 )
+{
+
+}
+
+
+ZyppHistoryEventsModel::~ZyppHistoryEventsModel()
+{
+
+}
+
+
+void ZyppHistoryEventsModel::setCommands( const QVector<int> & commands,
+                                          const QBitArray &    filterMatches )
+{
+    beginResetModel();
+
+    _filterMatches = filterMatches;
+    _commandRows.clear();
+    _commandRows.reserve( commands.size() );
+
+    for ( int cmdNo: commands )
+        _commandRows << CommandRow( cmdNo );
+
+    endResetModel();
+}
+
+
+void ZyppHistoryEventsModel::clear()
+{
+    beginResetModel();
+
+    _commandRows.clear();
+    _filterMatches.clear();
+
+    endResetModel();
+}
+
+
+void ZyppHistoryEventsModel::setShowPlusMinusCount( bool show,
+                                                    int  trivialInstallCount,
+                                                    int  trivialRemoveCount )
+{
+    _showPlusMinusCount  = show;
+    _trivialInstallCount = trivialInstallCount;
+    _trivialRemoveCount  = trivialRemoveCount;
+}
+
+
+int ZyppHistoryEventsModel::eventNo( const QModelIndex & index ) const
+{
+    if ( ! index.isValid() || index.internalId() == 0 )
+        return -1;
+
+    const CommandRow & row = _commandRows.at( index.internalId() - 1 );
+
+    return row.eventNos.at( index.row() );
+}
+
+
+bool ZyppHistoryEventsModel::isSpanned( const QModelIndex & index ) const
+{
+    if ( isCommand( index ) )
+        return true;
+
+    int eventNo = this->eventNo( index );
+
+    if ( eventNo < 0 )
+        return false;
+
+    switch ( _events.eventType( eventNo ) )
+    {
+        case EventType::RepoAdd:
+        case EventType::RepoRemove:
+        case EventType::RepoUrl:
+        case EventType::RepoAlias:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+
+QModelIndex ZyppHistoryEventsModel::index( int row, int column,
+                                           const QModelIndex & parent ) const
+{
+    if ( row < 0 || column < 0 || column >= ColumnCount )
+        return QModelIndex();
+
+    if ( ! parent.isValid() )
+    {
+        if ( row >= _commandRows.size() )
+            return QModelIndex();
+
+        return createIndex( row, column, (quintptr) 0 );
+    }
+
+    if ( ! isCommand( parent ) || row >= _commandRows.at( parent.row() ).eventNos.size() )
+        return QModelIndex();
+
+    return createIndex( row, column, (quintptr) parent.row() + 1 );
+}
+
+
+QModelIndex ZyppHistoryEventsModel::parent( const QModelIndex & index ) const
+{
+    if ( ! index.isValid() || index.internalId() == 0 )
+        return QModelIndex();
+
+    return createIndex( index.internalId() - 1, 0, (quintptr) 0 );
+}
+
+
+int ZyppHistoryEventsModel::rowCount( const QModelIndex & parent ) const
+{
+    if ( ! parent.isValid() )
+        return _commandRows.size();
+
+    if ( isCommand( parent ) && parent.column() == 0 )
+        return _commandRows.at( parent.row() ).eventNos.size();
+
+    return 0;
+}
+
+
+int ZyppHistoryEventsModel::columnCount( const QModelIndex & parent ) const
+{
+    Q_UNUSED( parent );
+
+    return ColumnCount;
+}
+
+
+bool ZyppHistoryEventsModel::hasChildren( const QModelIndex & parent ) const
+{
+    if ( ! parent.isValid() )
+        return ! _commandRows.isEmpty();
+
+    if ( ! isCommand( parent ) || parent.column() != 0 )
+        return false;
+
+    const CommandRow & row = _commandRows.at( parent.row() );
+
+    if ( row.fetched )
+        return ! row.eventNos.isEmpty();
+
+    // Don't fetch the children just to find out if there are any: With a
+    // filter, only commands with at least one matching event are in the list.
+
+    return _events.childEventsCount( row.cmdNo ) > 0;
+}
+
+
+bool ZyppHistoryEventsModel::canFetchMore( const QModelIndex & parent ) const
+{
+    return isCommand( parent ) && ! _commandRows.at( parent.row() ).fetched;
+}
+
+
+void ZyppHistoryEventsModel::fetchMore( const QModelIndex & parent )
+{
+    if ( ! canFetchMore( parent ) )
+        return;
+
+    CommandRow & row = _commandRows[ parent.row() ];
+    QVector<int> eventNos;
+
+    for ( int eventNo = _events.firstEvent( row.cmdNo ); eventNo < _events.endEvent( row.cmdNo ); eventNo++ )
+    {
+        if ( acceptEvent( eventNo ) )
+            eventNos << eventNo;
+    }
+
+    row.fetched = true;
+
+    if ( eventNos.isEmpty() )
+        return;
+
+    beginInsertRows( parent, 0, eventNos.size() - 1 );
+    row.eventNos.swap( eventNos );
+    endInsertRows();
+}
+
+
+QVariant ZyppHistoryEventsModel::data( const QModelIndex & index, int role ) const
+{
+    if ( ! index.isValid() )
+        return QVariant();
+
+    if ( isCommand( index ) )
+    {
+        if ( index.column() != NameCol )
+            return QVariant();
+
+        switch ( role )
+        {
+            case Qt::DisplayRole:
+                return commandText( _commandRows.at( index.row() ) );
+
+            case Qt::FontRole:
+                {
+                    QFont boldFont;
+                    boldFont.setBold( true );
+
+                    return boldFont;
+                }
+
+            default:
+                return QVariant();
+        }
+    }
+
+    int eventNo = this->eventNo( index );
+
+    switch ( role )
+    {
+        case Qt::DisplayRole:
+            return eventText( eventNo, index.column() );
+
+        case Qt::DecorationRole:
+
+            if ( index.column() != NameCol )
+                break;
+
+            switch ( _events.eventType( eventNo ) )
+            {
+                case EventType::PkgInstall: return YQIconPool::pkgInstall();
+                case EventType::PkgRemove:  return YQIconPool::pkgDel();
+                default: break;
+            }
+
+            break;
+
+        default:
+            break;
+    }
+
+    return QVariant();
+}
+
+
+QVariant ZyppHistoryEventsModel::headerData( int section,
+                                             Qt::Orientation orientation,
+                                             int role ) const
+{
+    if ( orientation != Qt::Horizontal || role != Qt::DisplayRole )
+        return QVariant();
+
+    switch ( section )
+    {
+        case NameCol:    return _( "Name"    );
+        case VersionCol: return _( "Version" );
+        case ArchCol:    return _( "Arch."   );
+        case RepoCol:    return _( "Repo"    );
+
+        default:
+            return QVariant();
+    }
+}
+
+
+void ZyppHistoryEventsModel::countPkgEvents( const CommandRow & row ) const
+{
+    if ( row.installCount >= 0 )
+        return;
+
+    row.installCount = 0;
+    row.removeCount  = 0;
+
+    for ( int eventNo = _events.firstEvent( row.cmdNo ); eventNo < _events.endEvent( row.cmdNo ); eventNo++ )
+    {
+        if ( ! acceptEvent( eventNo ) )
+            continue;
+
+        switch ( _events.eventType( eventNo ) )
+        {
+            case EventType::PkgInstall: row.installCount++; break;
+            case EventType::PkgRemove:  row.removeCount++;  break;
+            default: break;
+        }
+    }
+}
+
+
+QString ZyppHistoryEventsModel::commandText( const CommandRow & row ) const
+{
+    QString text = QString( "%1  %2" )
+        .arg( timestampString( _events.commandTimestamp( row.cmdNo ) ) )
+        .arg( _events.command( row.cmdNo ) );
+
+    if ( ! _showPlusMinusCount )
+        return text;
+
+    countPkgEvents( row );
+
+    if ( row.installCount > _trivialInstallCount ||
+         row.removeCount  > _trivialRemoveCount    )
+    {
+        if ( row.removeCount == 0 )
+            text += QString( "   (+%1)" ).arg( row.installCount );
+        else if ( row.installCount == 0 )
+            text += QString( "   (-%1)" ).arg( row.removeCount );
+        else
+        {
+            text += QString( "   (+%1/-%2)" )
+                .arg( row.installCount )
+                .arg( row.removeCount  );
+        }
+    }
+
+    return text;
+}
+
+
+QString ZyppHistoryEventsModel::eventText( int eventNo, int column ) const
+{
+    switch ( _events.eventType( eventNo ) )
+    {
+        case EventType::PkgInstall:
+        case EventType::PkgRemove:
+
+            switch ( column )
+            {
+                case NameCol:    return _events.name     ( eventNo );
+                case VersionCol: return _events.version  ( eventNo );
+                case ArchCol:    return _events.arch     ( eventNo );
+                case RepoCol:    return _events.repoAlias( eventNo );
+                default:         return QString();
+            }
+
+        case EventType::RepoAdd:
+        case EventType::RepoRemove:
+        case EventType::RepoUrl:
+        case EventType::RepoAlias:
+
+            return column == NameCol ? repoText( eventNo ) : QString();
+
+        case EventType::Patch:
+
+            switch ( column )
+            {
+                case NameCol:    return _( "Patch %1" ).arg( _events.name( eventNo ) );
+                case VersionCol: return _events.version  ( eventNo );
+                case ArchCol:    return _events.arch     ( eventNo );
+                case RepoCol:    return _events.repoAlias( eventNo );
+                default:         return QString();
+            }
+
+        default:
+            return QString();
+    }
+}
+
+
+QString ZyppHistoryEventsModel::repoText( int eventNo ) const
+{
+    switch ( _events.eventType( eventNo ) )
+    {
+        case EventType::RepoAdd:
+            return _( "Repo+  %1  %2" )
+                .arg( _events.repoAlias( eventNo ) )
+                .arg( _events.url( eventNo ) );
+
+        case EventType::RepoRemove:
+            return _( "Repo-  %1" )
+                .arg( _events.repoAlias( eventNo ) );
+
+        case EventType::RepoUrl:
+            return _( "Repo-URL  %1 -> %2" )
+                .arg( _events.oldUrl( eventNo ) )
+                .arg( _events.url( eventNo ) );
+
+        case EventType::RepoAlias:
+            return _( "Repo-Alias  %1 -> %2" )
+                .arg( _events.oldRepoAlias( eventNo ) )
+                .arg( _events.repoAlias( eventNo ) );
+
+        default:
+            return QString();
+    }
+}
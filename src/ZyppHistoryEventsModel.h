@@ -0,0 +1,186 @@
+/*  ---------------------------------------------------------
+               __  __            _
+              |  \/  |_   _ _ __| |_   _ _ __
+              | |\/| | | | | '__| | | | | '_ \
+              | |  | | |_| | |  | | |_| | | | |
+              |_|  |_|\__, |_|  |_|\__, |_| |_|
+                      |___/        |___/
+    ---------------------------------------------------------
+
+    Project:  Myrlyn Package Manager GUI
+    Copyright (c) Stefan Hundhammer <Stefan.Hundhammer@gmx.de>
+    License:  GPL V2 - See file LICENSE for details.
+
+ */
+
+
+#ifndef ZyppHistoryEventsModel_h
+#define ZyppHistoryEventsModel_h
+
+#include <QAbstractItemModel>
+#include <QBitArray>
+#include <QVector>
+
+#include "ZyppHistoryEvents.h"
+
+
+/**
+ * Item model for the events tree of the zypp history browser: The commands
+ * are the toplevel rows, their child events (install / remove a package,
+ * add / remove a repo, ...) are the child rows.
+ *
+ * Nothing here is a widget item; the view only asks for the data of the rows
+ * that are visible. The child rows of a command are only determined when the
+ * view first needs them (typically when the command is expanded), so showing
+ * a month with a 'zypper dup' with 3000 packages is as cheap as showing one
+ * with a single package.
+ *
+ * This model does not own the EventStore. Call clear() before the
+ * EventStore is changed.
+ **/
+class ZyppHistoryEventsModel: public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+
+    enum Column
+    {
+        NameCol,
+        VersionCol,
+        ArchCol,
+        RepoCol,
+        ColumnCount
+    };
+
+    /**
+     * Constructor.
+     **/
+    ZyppHistoryEventsModel( const ZyppHistoryEvents::EventStore & events,
+                            QObject * parent = 0 );
+
+    /**
+     * Destructor.
+     **/
+    virtual ~ZyppHistoryEventsModel();
+
+    /**
+     * Show the commands with the command numbers 'commands' (sorted) and
+     * their child events that pass the filter: 'filterMatches' has a bit for
+     * each event; if it is empty, there is no filter, i.e. all child events
+     * are shown.
+     **/
+    void setCommands( const QVector<int> & commands,
+                      const QBitArray &    filterMatches = QBitArray() );
+
+    /**
+     * Remove all rows.
+     **/
+    void clear();
+
+    /**
+     * Show the number of installed and removed packages of each command that
+     * installs more than 'trivialInstallCount' or removes more than
+     * 'trivialRemoveCount' packages. Call this before setCommands().
+     **/
+    void setShowPlusMinusCount( bool show,
+                                int  trivialInstallCount,
+                                int  trivialRemoveCount );
+
+    /**
+     * Return 'true' if 'index' is a command (toplevel) row.
+     **/
+    bool isCommand( const QModelIndex & index ) const
+        { return index.isValid() && index.internalId() == 0; }
+
+    /**
+     * Return the event number of a child event row or -1 if 'index' is not
+     * a child event.
+     **/
+    int eventNo( const QModelIndex & index ) const;
+
+    /**
+     * Return 'true' if the row of 'index' should use all columns for its text
+     * (the commands and the repo events).
+     **/
+    bool isSpanned( const QModelIndex & index ) const;
+
+
+    //
+    // QAbstractItemModel API
+    //
+
+    QModelIndex index( int row, int column,
+                       const QModelIndex & parent = QModelIndex() ) const override;
+
+    QModelIndex parent( const QModelIndex & index ) const override;
+
+    int rowCount   ( const QModelIndex & parent = QModelIndex() ) const override;
+    int columnCount( const QModelIndex & parent = QModelIndex() ) const override;
+
+    bool hasChildren( const QModelIndex & parent = QModelIndex() ) const override;
+    bool canFetchMore( const QModelIndex & parent ) const override;
+    void fetchMore   ( const QModelIndex & parent ) override;
+
+    QVariant data( const QModelIndex & index,
+                   int role = Qt::DisplayRole ) const override;
+
+    QVariant headerData( int section,
+                         Qt::Orientation orientation,
+                         int role = Qt::DisplayRole ) const override;
+
+
+protected:
+
+    /**
+     * One toplevel row. The child event numbers are only filled in
+     * fetchMore().
+     **/
+    struct CommandRow
+    {
+        CommandRow( int cmdNo = -1 )
+            : cmdNo( cmdNo )
+            , fetched( false )
+            , installCount( -1 )
+            , removeCount( -1 )
+            {}
+
+        int          cmdNo;
+        bool         fetched;
+        QVector<int> eventNos;
+
+        // Only counted when the command text is first needed
+        mutable int  installCount;
+        mutable int  removeCount;
+    };
+
+    /**
+     * Return 'true' if child event number 'eventNo' passes the filter.
+     **/
+    bool acceptEvent( int eventNo ) const
+        { return _filterMatches.isEmpty() || _filterMatches.testBit( eventNo ); }
+
+    /**
+     * Count the installed and removed packages of the command in 'row' if
+     * that was not done yet.
+     **/
+    void countPkgEvents( const CommandRow & row ) const;
+
+    QString commandText( const CommandRow & row ) const;
+    QString eventText  ( int eventNo, int column ) const;
+    QString repoText   ( int eventNo ) const;
+
+
+    // Data members
+
+    const ZyppHistoryEvents::EventStore & _events;
+    QVector<CommandRow>                   _commandRows;
+    QBitArray                             _filterMatches;
+
+    bool                                  _showPlusMinusCount;
+    int                                   _trivialInstallCount;
+    int                                   _trivialRemoveCount;
+};
+
+
+#endif // ZyppHistoryEventsModel_h
@@ -14,6 +14,10 @@
  */
 
 
+#include <algorithm>
+
+#include <QStringList>
+
 #include "YQi18n.h"
 #include "ZyppHistoryEvents.h"
 #include "ZyppHistoryFilter.h"
@@ -28,12 +32,9 @@ ZyppHistoryRepoEventsFilter::ZyppHistoryRepoEventsFilter()
 
 
 bool
-ZyppHistoryRepoEventsFilter::operator() ( Event * event )
+ZyppHistoryRepoEventsFilter::operator() ( const EventStore & events, int eventNo )
 {
-    if ( ! event )
-        return false;  // reject
-
-    switch ( event->eventType )
+    switch ( events.eventType( eventNo ) )
     {
         case EventType::RepoAdd:
         case EventType::RepoRemove:
@@ -49,6 +50,46 @@ ZyppHistoryRepoEventsFilter::operator() ( Event * event )
 
 
 
+void ZyppHistorySearchFilter::prepare( const EventStore & events )
+{
+    _matchCache.fill( -1, events.stringCount() );
+}
+
+
+bool ZyppHistorySearchFilter::matches( const EventStore & events, StringId id )
+{
+    if ( (int) id >= _matchCache.size() )  // New strings since prepare()
+        _matchCache.resize( events.stringCount(), -1 );
+
+    qint8 & cached = _matchCache[ id ];
+
+    if ( cached < 0 )
+        cached = _searchFilter.matches( events.string( id ) ) ? 1 : 0;
+
+    return cached > 0;
+}
+
+
+void ZyppHistorySearchFilter::indexCandidates( const EventStore &               events,
+                                               const EventStore::PostingLists & index,
+                                               QVector<int> &                   eventNos )
+{
+    eventNos.clear();
+
+    for ( EventStore::PostingLists::const_iterator it = index.constBegin();
+          it != index.constEnd();
+          ++it )
+    {
+        if ( matches( events, it.key() ) )
+            eventNos << it.value();
+    }
+
+    std::sort( eventNos.begin(), eventNos.end() );
+}
+
+
+
+
 ZyppHistoryPkgNameFilter::ZyppHistoryPkgNameFilter( const QString &          searchPattern,
                                                     SearchFilter::FilterMode filterMode,
                                                     SearchFilter::FilterMode defaultFilterMode )
@@ -59,14 +100,25 @@ ZyppHistoryPkgNameFilter::ZyppHistoryPkgNameFilter( const QString &          sea
 
 
 bool
-ZyppHistoryPkgNameFilter::operator() ( Event * event )
+ZyppHistoryPkgNameFilter::operator() ( const EventStore & events, int eventNo )
 {
-    PkgEvent * pkgEvent = dynamic_cast<PkgEvent *>( event );
+    switch ( events.eventType( eventNo ) )
+    {
+        case EventType::PkgInstall:
+        case EventType::PkgRemove:
+            return matches( events, events.nameId( eventNo ) );
 
-    if ( pkgEvent )
-        return _searchFilter.matches( pkgEvent->name );
-    else
-        return false; // reject
+        default:
+            return false; // reject
+    }
+}
+
+
+bool
+ZyppHistoryPkgNameFilter::candidates( const EventStore & events, QVector<int> & eventNos )
+{
+    indexCandidates( events, events.pkgNameIndex(), eventNos );
+    return true;
 }
 
 
@@ -82,12 +134,313 @@ ZyppHistoryPkgRepoAliasFilter::ZyppHistoryPkgRepoAliasFilter( const QString &
 
 
 bool
-ZyppHistoryPkgRepoAliasFilter::operator() ( Event * event )
+ZyppHistoryPkgRepoAliasFilter::operator() ( const EventStore & events, int eventNo )
 {
-    PkgEvent * pkgEvent = dynamic_cast<PkgEvent *>( event );
+    switch ( events.eventType( eventNo ) )
+    {
+        case EventType::PkgInstall:
+        case EventType::PkgRemove:
+            return matches( events, events.repoAliasId( eventNo ) );
+
+        default:
+            return false; // reject
+    }
+}
+
+
+bool
+ZyppHistoryPkgRepoAliasFilter::candidates( const EventStore & events, QVector<int> & eventNos )
+{
+    indexCandidates( events, events.pkgRepoIndex(), eventNos );
+    return true;
+}
+
+
+
+
+
+ZyppHistoryPkgVersionFilter::ZyppHistoryPkgVersionFilter( const QString &          searchPattern,
+                                                          SearchFilter::FilterMode filterMode,
+                                                          SearchFilter::FilterMode defaultFilterMode )
+    : ZyppHistorySearchFilter( searchPattern, filterMode, defaultFilterMode )
+{
+    _description = _( "Package version \"%1\"" ).arg( searchPattern );
+}
+
 
-    if ( pkgEvent )
-        return _searchFilter.matches( pkgEvent->repoAlias );
-    else
-        return false; // reject
+bool
+ZyppHistoryPkgVersionFilter::operator() ( const EventStore & events, int eventNo )
+{
+    switch ( events.eventType( eventNo ) )
+    {
+        case EventType::PkgInstall:
+        case EventType::PkgRemove:
+            return matches( events, events.versionId( eventNo ) );
+
+        default:
+            return false; // reject
+    }
+}
+
+
+
+
+ZyppHistoryCommandFilter::ZyppHistoryCommandFilter( const QString &          searchPattern,
+                                                    SearchFilter::FilterMode filterMode,
+                                                    SearchFilter::FilterMode defaultFilterMode )
+    : ZyppHistorySearchFilter( searchPattern, filterMode, defaultFilterMode )
+{
+    _description = _( "Command \"%1\"" ).arg( searchPattern );
+}
+
+
+bool
+ZyppHistoryCommandFilter::operator() ( const EventStore & events, int eventNo )
+{
+    return matches( events, events.commandId( events.commandOf( eventNo ) ) );
+}
+
+
+bool
+ZyppHistoryCommandFilter::candidates( const EventStore & events, QVector<int> & eventNos )
+{
+    // There are far fewer commands than events
+
+    eventNos.clear();
+
+    for ( int cmdNo = 0; cmdNo < events.commandCount(); cmdNo++ )
+    {
+        if ( matches( events, events.commandId( cmdNo ) ) )
+        {
+            for ( int eventNo = events.firstEvent( cmdNo ); eventNo < events.endEvent( cmdNo ); eventNo++ )
+                eventNos << eventNo;
+        }
+    }
+
+    return true;
+}
+
+
+
+
+ZyppHistoryDateRangeFilter::ZyppHistoryDateRangeFilter( Day fromDay, Day toDay )
+    : _fromDay( fromDay )
+    , _toDay( toDay )
+{
+    _description = _( "From %1 to %2" )
+        .arg( dateString( (Timestamp) fromDay * 1000000 ) )
+        .arg( dateString( (Timestamp) toDay   * 1000000 ) );
+}
+
+
+bool
+ZyppHistoryDateRangeFilter::operator() ( const EventStore & events, int eventNo )
+{
+    Day day = dayOf( events.commandTimestamp( events.commandOf( eventNo ) ) );
+
+    return day >= _fromDay && day <= _toDay;
+}
+
+
+bool
+ZyppHistoryDateRangeFilter::candidates( const EventStore & events, QVector<int> & eventNos )
+{
+    eventNos.clear();
+
+    for ( int cmdNo: events.commandsInDays( _fromDay, _toDay ) )
+    {
+        for ( int eventNo = events.firstEvent( cmdNo ); eventNo < events.endEvent( cmdNo ); eventNo++ )
+            eventNos << eventNo;
+    }
+
+    return true;
+}
+
+
+
+
+ZyppHistoryCompositeFilter::ZyppHistoryCompositeFilter( const QList<ZyppHistoryFilter *> & filters,
+                                                        const QString &                    conjunction )
+    : _filters( filters )
+    , _conjunction( conjunction )
+{
+    updateDescription();
+}
+
+
+ZyppHistoryCompositeFilter::~ZyppHistoryCompositeFilter()
+{
+    qDeleteAll( _filters );
+}
+
+
+void ZyppHistoryCompositeFilter::add( ZyppHistoryFilter * filter )
+{
+    if ( filter )
+    {
+        _filters << filter;
+        updateDescription();
+    }
+}
+
+
+void ZyppHistoryCompositeFilter::prepare( const EventStore & events )
+{
+    for ( ZyppHistoryFilter * filter: _filters )
+        filter->prepare( events );
+
+    std::stable_sort( _filters.begin(), _filters.end(),
+                      []( const ZyppHistoryFilter * a, const ZyppHistoryFilter * b )
+                      {
+                          return a->cost() < b->cost();
+                      } );
+}
+
+
+int ZyppHistoryCompositeFilter::cost() const
+{
+    int sum = 0;
+
+    for ( const ZyppHistoryFilter * filter: _filters )
+        sum += filter->cost();
+
+    return sum;
+}
+
+
+void ZyppHistoryCompositeFilter::updateDescription()
+{
+    QStringList descriptions;
+
+    for ( ZyppHistoryFilter * filter: _filters )
+        descriptions << filter->description();
+
+    _description = descriptions.join( QString( " %1 " ).arg( _conjunction ) );
+}
+
+
+
+
+ZyppHistoryAndFilter::ZyppHistoryAndFilter( const QList<ZyppHistoryFilter *> & filters )
+    : ZyppHistoryCompositeFilter( filters, _( "and" ) )
+{
+
+}
+
+
+bool
+ZyppHistoryAndFilter::operator() ( const EventStore & events, int eventNo )
+{
+    // prepare() sorted the child filters by cost, so the cheap ones are first
+
+    for ( ZyppHistoryFilter * filter: _filters )
+    {
+        if ( ! (*filter)( events, eventNo ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+bool
+ZyppHistoryAndFilter::candidates( const EventStore & events, QVector<int> & eventNos )
+{
+    // Any child filter that can use an index narrows down the candidates;
+    // the cheap ones (like a date range) first.
+
+    bool         haveCandidates = false;
+    QVector<int> childEventNos;
+
+    for ( ZyppHistoryFilter * filter: _filters )
+    {
+        if ( haveCandidates && eventNos.isEmpty() )
+            break;
+
+        if ( ! filter->candidates( events, childEventNos ) )
+            continue;
+
+        if ( ! haveCandidates )
+        {
+            eventNos.swap( childEventNos );
+            haveCandidates = true;
+        }
+        else
+        {
+            QVector<int> intersection;
+
+            std::set_intersection( eventNos.cbegin(),      eventNos.cend(),
+                                   childEventNos.cbegin(), childEventNos.cend(),
+                                   std::back_inserter( intersection ) );
+            eventNos.swap( intersection );
+        }
+    }
+
+    return haveCandidates;
+}
+
+
+
+
+ZyppHistoryOrFilter::ZyppHistoryOrFilter( const QList<ZyppHistoryFilter *> & filters )
+    : ZyppHistoryCompositeFilter( filters, _( "or" ) )
+{
+
+}
+
+
+bool
+ZyppHistoryOrFilter::operator() ( const EventStore & events, int eventNo )
+{
+    for ( ZyppHistoryFilter * filter: _filters )
+    {
+        if ( (*filter)( events, eventNo ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+bool
+ZyppHistoryOrFilter::candidates( const EventStore & events, QVector<int> & eventNos )
+{
+    // Every child filter needs to narrow down its candidates, otherwise all
+    // events are candidates anyway.
+
+    QVector<int> childEventNos;
+    eventNos.clear();
+
+    for ( ZyppHistoryFilter * filter: _filters )
+    {
+        if ( ! filter->candidates( events, childEventNos ) )
+        {
+            eventNos.clear();
+            return false;
+        }
+
+        QVector<int> merged;
+
+        std::set_union( eventNos.cbegin(),      eventNos.cend(),
+                        childEventNos.cbegin(), childEventNos.cend(),
+                        std::back_inserter( merged ) );
+        eventNos.swap( merged );
+    }
+
+    return true;
+}
+
+
+
+
+ZyppHistoryNotFilter::ZyppHistoryNotFilter( ZyppHistoryFilter * filter )
+    : _filter( filter )
+{
+    _description = _( "Not: %1" ).arg( _filter->description() );
+}
+
+
+ZyppHistoryNotFilter::~ZyppHistoryNotFilter()
+{
+    delete _filter;
 }
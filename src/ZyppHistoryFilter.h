@@ -16,7 +16,9 @@
 #ifndef ZyppHistoryFilter_h
 #define ZyppHistoryFilter_h
 
+#include <QList>
 #include <QString>
+#include <QVector>
 
 #include "SearchFilter.h"
 #include "ZyppHistoryEvents.h"
@@ -38,19 +40,20 @@
  *       : _userData( userData )
  *     {}
  *
- *     bool operator() ( ... *event ) override
+ *     bool operator() ( const EventStore & events, int eventNo ) override
  *     {
- *       return event->foo == userData;
+ *       return events.foo( eventNo ) == userData;
  *     }
  *   };
  *
  *   main()
  *   {
  *     MyFilter filter( 42 );
+ *     filter.prepare( events );
  *
- *     for ( Event ev: events() )
- *       if ( filter( event ) )
- *         filteredEvents << ev;
+ *     for ( int eventNo = 0; eventNo < events.eventCount(); eventNo++ )
+ *       if ( filter( events, eventNo ) )
+ *         filteredEvents << eventNo;
  *   }
  **/
 class ZyppHistoryFilter
@@ -72,12 +75,45 @@ public:
     virtual ~ZyppHistoryFilter() {};
 
     /**
-     * Overloaded function call operator: Check if the specified event should
-     * be accepted (kept) (-> true) or rejected (filtered out) (->false).
+     * Overloaded function call operator: Check if event number 'eventNo' in
+     * 'events' should be accepted (kept) (-> true) or rejected (filtered out)
+     * (->false).
      *
      * Derived classes are required to implement this.
      **/
-    virtual bool operator() ( ZyppHistoryEvents::Event * event ) = 0;
+    virtual bool operator() ( const ZyppHistoryEvents::EventStore & events,
+                              int                                   eventNo ) = 0;
+
+    /**
+     * Prepare for filtering the events in 'events'. Call this before the
+     * first event and whenever the events might have changed.
+     *
+     * Derived classes can reimplement this to set up or clear any cached
+     * data.
+     **/
+    virtual void prepare( const ZyppHistoryEvents::EventStore & events )
+        { Q_UNUSED( events ); }
+
+    /**
+     * If this filter can use an index of 'events' to find the events that
+     * might match, store their numbers in ascending order in 'eventNos' and
+     * return 'true'. Those events still need to be checked with operator().
+     *
+     * Return 'false' if all events need to be checked.
+     *
+     * Call prepare() first.
+     **/
+    virtual bool candidates( const ZyppHistoryEvents::EventStore & events,
+                             QVector<int> &                        eventNos )
+        { Q_UNUSED( events ); Q_UNUSED( eventNos ); return false; }
+
+    /**
+     * Return the relative cost of operator() for one event: 1 for just
+     * comparing a column of the EventStore, more for anything that needs
+     * string matching. Composite filters use this to check the cheap
+     * criteria first.
+     **/
+    virtual int cost() const { return 1; }
 
     /**
      * Return a (translated) concise textual description for the user what this
@@ -99,9 +135,9 @@ protected:
  *
  *   ZyppHistoryEventTypeFilter myFilter( ZyppHistoryEvents::EventType PkgRemove );
  *
- *   for ( Event event: events() )
- *     if ( myFilter( event ) )
- *       keepEvent( event );
+ *   for ( int eventNo = 0; eventNo < events.eventCount(); eventNo++ )
+ *     if ( myFilter( events, eventNo ) )
+ *       keepEvent( eventNo );
  **/
 class ZyppHistoryEventTypeFilter: public ZyppHistoryFilter
 {
@@ -113,8 +149,9 @@ public:
 
     virtual ~ZyppHistoryEventTypeFilter() {}
 
-    virtual bool operator() ( ZyppHistoryEvents::Event * event ) override
-        { return event && event->eventType == _eventType; }
+    virtual bool operator() ( const ZyppHistoryEvents::EventStore & events,
+                              int                                   eventNo ) override
+        { return events.eventType( eventNo ) == _eventType; }
 
 protected:
     ZyppHistoryEvents::EventType _eventType;
@@ -131,7 +168,8 @@ public:
     ZyppHistoryRepoEventsFilter();
     virtual ~ZyppHistoryRepoEventsFilter() {}
 
-    virtual bool operator() ( ZyppHistoryEvents::Event * event ) override;
+    virtual bool operator() ( const ZyppHistoryEvents::EventStore & events,
+                              int                                   eventNo ) override;
 };
 
 
@@ -152,8 +190,30 @@ protected:
 
     // Notice that derived classes are still required to implement operator()
 
+    virtual void prepare( const ZyppHistoryEvents::EventStore & events ) override;
+
+    virtual int cost() const override { return 10; }
+
+    /**
+     * Return 'true' if the string with ID 'id' matches the search filter.
+     *
+     * The same few strings (package names, repo aliases) are used in many
+     * events, so the result is cached for each string ID.
+     **/
+    bool matches( const ZyppHistoryEvents::EventStore & events,
+                  ZyppHistoryEvents::StringId           id );
+
+    /**
+     * Store the numbers of all events in 'index' with a string that matches
+     * the search filter in 'eventNos' in ascending order.
+     **/
+    void indexCandidates( const ZyppHistoryEvents::EventStore &               events,
+                          const ZyppHistoryEvents::EventStore::PostingLists & index,
+                          QVector<int> &                                      eventNos );
+
 protected:
-    SearchFilter _searchFilter;
+    SearchFilter    _searchFilter;
+    QVector<qint8>  _matchCache;  // -1: unknown; 0: no match; 1: match
 };
 
 
@@ -169,7 +229,11 @@ public:
 
     virtual ~ZyppHistoryPkgNameFilter() {}
 
-    virtual bool operator() ( ZyppHistoryEvents::Event * event ) override;
+    virtual bool operator() ( const ZyppHistoryEvents::EventStore & events,
+                              int                                   eventNo ) override;
+
+    virtual bool candidates( const ZyppHistoryEvents::EventStore & events,
+                             QVector<int> &                        eventNos ) override;
 };
 
 
@@ -185,9 +249,190 @@ public:
 
     virtual ~ZyppHistoryPkgRepoAliasFilter() {}
 
-    virtual bool operator() ( ZyppHistoryEvents::Event * event ) override;
+    virtual bool operator() ( const ZyppHistoryEvents::EventStore & events,
+                              int                                   eventNo ) override;
+
+    virtual bool candidates( const ZyppHistoryEvents::EventStore & events,
+                             QVector<int> &                        eventNos ) override;
+};
+
+
+/**
+ * Event filter that accepts all PkgEvents with a package version that
+ * matches 'searchPattern'.
+ **/
+class ZyppHistoryPkgVersionFilter: public ZyppHistorySearchFilter
+{
+public:
+    ZyppHistoryPkgVersionFilter( const QString &          searchPattern,
+                                 SearchFilter::FilterMode filterMode        = SearchFilter::Auto,
+                                 SearchFilter::FilterMode defaultFilterMode = SearchFilter::StartsWith );
+
+    virtual ~ZyppHistoryPkgVersionFilter() {}
+
+    virtual bool operator() ( const ZyppHistoryEvents::EventStore & events,
+                              int                                   eventNo ) override;
+};
+
+
+/**
+ * Event filter that accepts all child events of commands that match
+ * 'searchPattern', e.g. "zypper" or "myrlyn".
+ **/
+class ZyppHistoryCommandFilter: public ZyppHistorySearchFilter
+{
+public:
+    ZyppHistoryCommandFilter( const QString &          searchPattern,
+                              SearchFilter::FilterMode filterMode        = SearchFilter::Auto,
+                              SearchFilter::FilterMode defaultFilterMode = SearchFilter::StartsWith );
+
+    virtual ~ZyppHistoryCommandFilter() {}
+
+    virtual bool operator() ( const ZyppHistoryEvents::EventStore & events,
+                              int                                   eventNo ) override;
+
+    virtual bool candidates( const ZyppHistoryEvents::EventStore & events,
+                             QVector<int> &                        eventNos ) override;
+};
+
+
+/**
+ * Event filter that accepts all child events of commands from day 'fromDay'
+ * to day 'toDay' (inclusive).
+ *
+ * This uses the date of the command, not of the event itself, just like the
+ * timeline in the history browser.
+ **/
+class ZyppHistoryDateRangeFilter: public ZyppHistoryFilter
+{
+public:
+    ZyppHistoryDateRangeFilter( ZyppHistoryEvents::Day fromDay,
+                                ZyppHistoryEvents::Day toDay );
+
+    virtual ~ZyppHistoryDateRangeFilter() {}
+
+    virtual bool operator() ( const ZyppHistoryEvents::EventStore & events,
+                              int                                   eventNo ) override;
+
+    virtual bool candidates( const ZyppHistoryEvents::EventStore & events,
+                             QVector<int> &                        eventNos ) override;
+
+    virtual int cost() const override { return 2; }  // Binary search for the command
+
+protected:
+    ZyppHistoryEvents::Day _fromDay;
+    ZyppHistoryEvents::Day _toDay;
+};
+
+
+/**
+ * Abstract base class for filters that combine other filters.
+ *
+ * This takes over ownership of the child filters.
+ **/
+class ZyppHistoryCompositeFilter: public ZyppHistoryFilter
+{
+protected:
+    ZyppHistoryCompositeFilter( const QList<ZyppHistoryFilter *> & filters,
+                                const QString &                    conjunction );
+
+public:
+    virtual ~ZyppHistoryCompositeFilter();
+
+    /**
+     * Add another child filter. Ownership is transferred to this object.
+     **/
+    void add( ZyppHistoryFilter * filter );
+
+    /**
+     * Prepare all child filters and sort them by cost() so the cheap ones
+     * are checked first.
+     **/
+    virtual void prepare( const ZyppHistoryEvents::EventStore & events ) override;
+
+    virtual int cost() const override;
+
+protected:
+
+    /**
+     * Set the description from the child filters' descriptions, separated
+     * with the conjunction ("and", "or").
+     **/
+    void updateDescription();
+
+    QList<ZyppHistoryFilter *> _filters;
+    QString                    _conjunction;
+};
+
+
+/**
+ * Event filter that accepts events that pass all of its child filters.
+ *
+ * For the candidates, it intersects the candidates of all child filters
+ * that can use an index, so e.g. a date range narrows down the events that
+ * the package name filter needs to check.
+ *
+ * Usage:
+ *
+ *   ZyppHistoryAndFilter filter( { new ZyppHistoryDateRangeFilter( 20250101, 20251231 ),
+ *                                  new ZyppHistoryPkgNameFilter( "kernel-default" ) } );
+ **/
+class ZyppHistoryAndFilter: public ZyppHistoryCompositeFilter
+{
+public:
+    ZyppHistoryAndFilter( const QList<ZyppHistoryFilter *> & filters = QList<ZyppHistoryFilter *>() );
+    virtual ~ZyppHistoryAndFilter() {}
+
+    virtual bool operator() ( const ZyppHistoryEvents::EventStore & events,
+                              int                                   eventNo ) override;
+
+    virtual bool candidates( const ZyppHistoryEvents::EventStore & events,
+                             QVector<int> &                        eventNos ) override;
 };
 
 
+/**
+ * Event filter that accepts events that pass any of its child filters.
+ *
+ * It can only narrow down the candidates if all of its child filters can.
+ **/
+class ZyppHistoryOrFilter: public ZyppHistoryCompositeFilter
+{
+public:
+    ZyppHistoryOrFilter( const QList<ZyppHistoryFilter *> & filters = QList<ZyppHistoryFilter *>() );
+    virtual ~ZyppHistoryOrFilter() {}
+
+    virtual bool operator() ( const ZyppHistoryEvents::EventStore & events,
+                              int                                   eventNo ) override;
+
+    virtual bool candidates( const ZyppHistoryEvents::EventStore & events,
+                             QVector<int> &                        eventNos ) override;
+};
+
+
+/**
+ * Event filter that accepts events that its child filter rejects.
+ *
+ * This takes over ownership of the child filter.
+ **/
+class ZyppHistoryNotFilter: public ZyppHistoryFilter
+{
+public:
+    ZyppHistoryNotFilter( ZyppHistoryFilter * filter );
+    virtual ~ZyppHistoryNotFilter();
+
+    virtual bool operator() ( const ZyppHistoryEvents::EventStore & events,
+                              int                                   eventNo ) override
+        { return ! (*_filter)( events, eventNo ); }
+
+    virtual void prepare( const ZyppHistoryEvents::EventStore & events ) override
+        { _filter->prepare( events ); }
+
+    virtual int cost() const override { return _filter->cost(); }
+
+protected:
+    ZyppHistoryFilter * _filter;
+};
+
 
 #endif  // ZyppHistoryFilter_h
@@ -14,6 +14,7 @@
  */
 
 
+#include <QDate>
 #include <QSettings>
 
 #include "Exception.h"
@@ -45,8 +46,11 @@ ZyppHistoryFilterDialog::ZyppHistoryFilterDialog( QWidget * parent )
     WindowSettings::read( this, "ZyppHistoryFilterDialog" );
     readSettings();
 
+    _ui->toDate->setDate( QDate::currentDate() );
+    _ui->fromDate->setDate( QDate::currentDate().addYears( -1 ) );
+
     connectWidgets();
-    initRadioButtons();
+    initCheckBoxes();
     enableOkButton();
 }
 
@@ -64,10 +68,10 @@ ZyppHistoryFilterDialog::~ZyppHistoryFilterDialog()
 
 void ZyppHistoryFilterDialog::connectWidgets()
 {
-    for ( QRadioButton * radioButton: findChildren<QRadioButton *>() )
+    for ( QCheckBox * checkBox: criteriaCheckBoxes() )
     {
-        connect( radioButton, SIGNAL( toggled           ( bool ) ),
-                 this,        SLOT  ( radioButtonToggled( bool ) ) );
+        connect( checkBox, SIGNAL( toggled         ( bool ) ),
+                 this,     SLOT  ( criterionToggled( bool ) ) );
     }
 
     connect( _ui->pkgName,    SIGNAL( textEdited     ( QString ) ),
@@ -75,48 +79,96 @@ void ZyppHistoryFilterDialog::connectWidgets()
 
     connect( _ui->repoAlias,  SIGNAL( textEdited     ( QString ) ),
              this,            SLOT  ( enableOkButton ()          ) );
+
+    connect( _ui->pkgVersion, SIGNAL( textEdited     ( QString ) ),
+             this,            SLOT  ( enableOkButton ()          ) );
+
+    connect( _ui->command,    SIGNAL( textEdited     ( QString ) ),
+             this,            SLOT  ( enableOkButton ()          ) );
 }
 
 
-void ZyppHistoryFilterDialog::initRadioButtons()
+QList<QCheckBox *>
+ZyppHistoryFilterDialog::criteriaCheckBoxes()
 {
-    for ( QRadioButton * radioButton: findChildren<QRadioButton *>() )
-        radioButton->setChecked( false );
-
-    _ui->pkgByNameRadioButton->setChecked( true );
+    return QList<QCheckBox *>()
+        << _ui->pkgByNameCheckBox
+        << _ui->pkgByRepoCheckBox
+        << _ui->pkgByVersionCheckBox
+        << _ui->commandCheckBox
+        << _ui->pkgInstallCheckBox
+        << _ui->pkgRemoveCheckBox
+        << _ui->repoEventsCheckBox;
 }
 
 
-void ZyppHistoryFilterDialog::radioButtonToggled( bool checked )
+void ZyppHistoryFilterDialog::initCheckBoxes()
 {
-    if ( ! checked )
-        return;
+    for ( QCheckBox * checkBox: criteriaCheckBoxes() )
+        checkBox->setChecked( false );
+
+    _ui->pkgByNameCheckBox->setChecked( true );
+    _ui->andRadioButton->setChecked( true );
+    _ui->invertCheckBox->setChecked( false );
 
-    QWidget * radioButton = qobject_cast<QRadioButton *>( sender() );
+    enableCriteriaFields();
+}
+
+
+void ZyppHistoryFilterDialog::criterionToggled( bool checked )
+{
+    enableCriteriaFields();
 
     if ( checked )
     {
-        _ui->pkgByNameGroupBox->setEnabled( radioButton == _ui->pkgByNameRadioButton );
-        _ui->pkgByRepoGroupBox->setEnabled( radioButton == _ui->pkgByRepoRadioButton );
+        QObject * checkBox = sender();
 
-        if ( _ui->pkgByNameRadioButton->isChecked() )
+        if ( checkBox == _ui->pkgByNameCheckBox )
             _ui->pkgName->setFocus();
-        else if ( _ui->pkgByRepoRadioButton->isChecked() )
+        else if ( checkBox == _ui->pkgByRepoCheckBox )
             _ui->repoAlias->setFocus();
+        else if ( checkBox == _ui->pkgByVersionCheckBox )
+            _ui->pkgVersion->setFocus();
+        else if ( checkBox == _ui->commandCheckBox )
+            _ui->command->setFocus();
     }
 
     enableOkButton();
 }
 
 
+void ZyppHistoryFilterDialog::enableCriteriaFields()
+{
+    _ui->pkgByNameGroupBox->setEnabled   ( _ui->pkgByNameCheckBox->isChecked()    );
+    _ui->pkgByRepoGroupBox->setEnabled   ( _ui->pkgByRepoCheckBox->isChecked()    );
+    _ui->pkgByVersionGroupBox->setEnabled( _ui->pkgByVersionCheckBox->isChecked() );
+    _ui->commandGroupBox->setEnabled     ( _ui->commandCheckBox->isChecked()      );
+}
+
+
 void ZyppHistoryFilterDialog::enableOkButton()
 {
-    bool ok = true;
+    // At least one criterion, and each checked one with a search text
+
+    bool ok = false;
+
+    for ( QCheckBox * checkBox: criteriaCheckBoxes() )
+    {
+        if ( checkBox->isChecked() )
+            ok = true;
+    }
+
+    if ( _ui->pkgByNameCheckBox->isChecked() && _ui->pkgName->text().isEmpty() )
+        ok = false;
+
+    if ( _ui->pkgByRepoCheckBox->isChecked() && _ui->repoAlias->text().isEmpty() )
+        ok = false;
 
-    if ( _ui->pkgByNameRadioButton->isChecked() )
-        ok = ! _ui->pkgName->text().isEmpty();
-    else if ( _ui->pkgByRepoRadioButton->isChecked() )
-        ok = ! _ui->repoAlias->text().isEmpty();
+    if ( _ui->pkgByVersionCheckBox->isChecked() && _ui->pkgVersion->text().isEmpty() )
+        ok = false;
+
+    if ( _ui->commandCheckBox->isChecked() && _ui->command->text().isEmpty() )
+        ok = false;
 
     _ui->okButton->setEnabled( ok );
 }
@@ -126,46 +178,103 @@ void ZyppHistoryFilterDialog::enableOkButton()
 ZyppHistoryFilter *
 ZyppHistoryFilterDialog::filter()
 {
-    if ( _ui->pkgByNameRadioButton->isChecked() )
+    QList<ZyppHistoryFilter *> filters = criteriaFilters();
+
+    if ( filters.isEmpty() )
+        return 0;
+
+    ZyppHistoryFilter * filter = filters.first();
+
+    if ( filters.size() > 1 )
     {
-        QString searchText = _ui->pkgName->text();
-        int     searchMode = _ui->pkgByNameSearchMode->currentIndex();
+        if ( _ui->orRadioButton->isChecked() )
+            filter = new ZyppHistoryOrFilter( filters );
+        else
+            filter = new ZyppHistoryAndFilter( filters );
+
+        CHECK_NEW( filter );
+    }
 
-        if ( ! searchText.isEmpty() )
-        {
-            return new ZyppHistoryPkgNameFilter( searchText,
+    if ( _ui->invertCheckBox->isChecked() )
+    {
+        filter = new ZyppHistoryNotFilter( filter );
+        CHECK_NEW( filter );
+    }
+
+    if ( ! _ui->dateRangeGroupBox->isChecked() )
+        return filter;
+
+    QDate fromDate = qMin( _ui->fromDate->date(), _ui->toDate->date() );
+    QDate toDate   = qMax( _ui->fromDate->date(), _ui->toDate->date() );
+
+    ZyppHistoryFilter * dateRangeFilter =
+        new ZyppHistoryDateRangeFilter( fromDate.toString( "yyyyMMdd" ).toUInt(),
+                                        toDate.toString  ( "yyyyMMdd" ).toUInt() );
+    CHECK_NEW( dateRangeFilter );
+
+    ZyppHistoryFilter * andFilter = new ZyppHistoryAndFilter( { dateRangeFilter, filter } );
+    CHECK_NEW( andFilter );
+
+    return andFilter;
+}
+
+
+QList<ZyppHistoryFilter *>
+ZyppHistoryFilterDialog::criteriaFilters()
+{
+    QList<ZyppHistoryFilter *> filters;
+
+    if ( _ui->pkgByNameCheckBox->isChecked() && ! _ui->pkgName->text().isEmpty() )
+    {
+        int searchMode = _ui->pkgByNameSearchMode->currentIndex();
+
+        filters << new ZyppHistoryPkgNameFilter( _ui->pkgName->text(),
                                                  (SearchFilter::FilterMode) searchMode );
-        }
     }
-    else if ( _ui->pkgByRepoRadioButton->isChecked() )
+
+    if ( _ui->pkgByRepoCheckBox->isChecked() && ! _ui->repoAlias->text().isEmpty() )
     {
-        QString searchText = _ui->repoAlias->text();
-        int     searchMode = _ui->pkgByRepoSearchMode->currentIndex();
+        int searchMode = _ui->pkgByRepoSearchMode->currentIndex();
 
-        if ( ! searchText.isEmpty() )
-        {
-            return new ZyppHistoryPkgRepoAliasFilter( searchText,
+        filters << new ZyppHistoryPkgRepoAliasFilter( _ui->repoAlias->text(),
                                                       (SearchFilter::FilterMode) searchMode );
-
-        }
     }
-    else if ( _ui->pkgInstallRadioButton->isChecked() )
+
+    if ( _ui->pkgByVersionCheckBox->isChecked() && ! _ui->pkgVersion->text().isEmpty() )
     {
-        return new ZyppHistoryEventTypeFilter( ZyppHistoryEvents::EventType::PkgInstall,
-                                               _( "Only package installation / update" ) );
+        int searchMode = _ui->pkgByVersionSearchMode->currentIndex();
+
+        filters << new ZyppHistoryPkgVersionFilter( _ui->pkgVersion->text(),
+                                                    (SearchFilter::FilterMode) searchMode );
     }
-    else if ( _ui->pkgRemoveRadioButton->isChecked() )
+
+    if ( _ui->commandCheckBox->isChecked() && ! _ui->command->text().isEmpty() )
     {
-        return new ZyppHistoryEventTypeFilter( ZyppHistoryEvents::EventType::PkgRemove,
-                                               _( "Only package removal" ) );
+        int searchMode = _ui->commandSearchMode->currentIndex();
 
+        filters << new ZyppHistoryCommandFilter( _ui->command->text(),
+                                                 (SearchFilter::FilterMode) searchMode );
     }
-    else if ( _ui->repoEventsRadioButton->isChecked() )
+
+    if ( _ui->pkgInstallCheckBox->isChecked() )
+    {
+        filters << new ZyppHistoryEventTypeFilter( ZyppHistoryEvents::EventType::PkgInstall,
+                                                   _( "Only package installation / update" ) );
+    }
+
+    if ( _ui->pkgRemoveCheckBox->isChecked() )
     {
-        return new ZyppHistoryRepoEventsFilter();
+        filters << new ZyppHistoryEventTypeFilter( ZyppHistoryEvents::EventType::PkgRemove,
+                                                   _( "Only package removal" ) );
     }
 
-    return 0;
+    if ( _ui->repoEventsCheckBox->isChecked() )
+        filters << new ZyppHistoryRepoEventsFilter();
+
+    for ( ZyppHistoryFilter * filter: filters )
+        CHECK_NEW( filter );
+
+    return filters;
 }
 
 
@@ -174,8 +283,10 @@ void ZyppHistoryFilterDialog::readSettings()
     QSettings settings;
     settings.beginGroup( "ZyppHistoryFilterDialog" );
 
-    _ui->pkgByNameSearchMode->setCurrentIndex( settings.value( "pkgByNameSearchMode", 0 ).toInt() );
-    _ui->pkgByNameSearchMode->setCurrentIndex( settings.value( "pkgByRepoSearchMode", 0 ).toInt() );
+    _ui->pkgByNameSearchMode->setCurrentIndex   ( settings.value( "pkgByNameSearchMode",    0 ).toInt() );
+    _ui->pkgByRepoSearchMode->setCurrentIndex   ( settings.value( "pkgByRepoSearchMode",    0 ).toInt() );
+    _ui->pkgByVersionSearchMode->setCurrentIndex( settings.value( "pkgByVersionSearchMode", 0 ).toInt() );
+    _ui->commandSearchMode->setCurrentIndex     ( settings.value( "commandSearchMode",      0 ).toInt() );
 
     settings.endGroup();
 }
@@ -186,8 +297,10 @@ void ZyppHistoryFilterDialog::writeSettings()
     QSettings settings;
     settings.beginGroup( "ZyppHistoryFilterDialog" );
 
-    settings.setValue( "pkgByNameSearchMode", _ui->pkgByNameSearchMode->currentIndex() );
-    settings.setValue( "pkgByRepoSearchMode", _ui->pkgByNameSearchMode->currentIndex() );
+    settings.setValue( "pkgByNameSearchMode",    _ui->pkgByNameSearchMode->currentIndex()    );
+    settings.setValue( "pkgByRepoSearchMode",    _ui->pkgByRepoSearchMode->currentIndex()    );
+    settings.setValue( "pkgByVersionSearchMode", _ui->pkgByVersionSearchMode->currentIndex() );
+    settings.setValue( "commandSearchMode",      _ui->commandSearchMode->currentIndex()      );
 
     settings.endGroup();
 }
@@ -48,7 +48,9 @@ public:
     virtual ~ZyppHistoryFilterDialog();
 
     /**
-     * Create a filter from the fields in this dialog.
+     * Create a filter from the fields in this dialog: The checked criteria,
+     * combined with AND or OR, inverted if "Exclude" is checked, and
+     * restricted to the date range if that is checked.
      *
      * This should only be called when the dialog was finished with
      * QDialog::Accepted, otherwise the result is undefined. In error cases
@@ -63,10 +65,10 @@ public:
 protected slots:
 
     /**
-     * Notification that any of the radio buttons was toggled so the fields
-     * under the other radio buttons can be enabled or disabled accordingly.
+     * Notification that any of the criteria check boxes was toggled so the
+     * fields under it can be enabled or disabled accordingly.
      **/
-    void radioButtonToggled( bool checked );
+    void criterionToggled( bool checked );
 
     /**
      * Enable or disable the [OK] button depending on the other widgets.
@@ -77,7 +79,23 @@ protected slots:
 protected:
 
     void connectWidgets();
-    void initRadioButtons();
+    void initCheckBoxes();
+
+    /**
+     * Enable or disable the fields of each criterion depending on its check
+     * box.
+     **/
+    void enableCriteriaFields();
+
+    /**
+     * Create a filter for each checked criterion.
+     **/
+    QList<ZyppHistoryFilter *> criteriaFilters();
+
+    /**
+     * Return the check boxes of all criteria.
+     **/
+    QList<QCheckBox *> criteriaCheckBoxes();
 
     void readSettings();
     void writeSettings();
@@ -0,0 +1,342 @@
+/*  ---------------------------------------------------------
+               __  __            _
+              |  \/  |_   _ _ __| |_   _ _ __
+              | |\/| | | | | '__| | | | | '_ \
+              | |  | | |_| | |  | | |_| | | | |
+              |_|  |_|\__, |_|  |_|\__, |_| |_|
+                      |___/        |___/
+    ---------------------------------------------------------
+
+    Project:  Myrlyn Package Manager GUI
+    Copyright (c) Stefan Hundhammer <Stefan.Hundhammer@gmx.de>
+    License:  GPL V2 - See file LICENSE for details.
+
+ */
+
+
+#include <cstring>      // memchr()
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include "Exception.h"
+#include "Logger.h"
+#include "ZyppHistoryLoader.h"
+
+
+#define FIRST_CHUNK_SIZE        ( 256 * 1024 )  // The most recent days
+
+using namespace ZyppHistoryEvents;
+
+
+ZyppHistoryLoader::ZyppHistoryLoader( QObject * parent )
+    : QObject( parent )
+    , _mapped( 0 )
+    , _size( 0 )
+    , _thread( 0 )
+    , _leadingEvents( false )
+    , _bytesParsed( 0 )
+{
+    // The worker thread emits this; process the chunks in this thread
+
+    connect( this, SIGNAL( chunkParsed()         ),
+             this, SLOT  ( processParsedChunks() ),
+             Qt::QueuedConnection );
+}
+
+
+ZyppHistoryLoader::~ZyppHistoryLoader()
+{
+    if ( _thread )
+    {
+        logInfo() << "Canceling parsing the zypp history" << endl;
+
+        _canceled.storeRelaxed( 1 );
+        _thread->wait();
+        delete _thread;
+
+        ZyppHistory::instance()->clear();  // Don't keep a half-parsed history
+    }
+
+    cleanup();
+}
+
+
+void ZyppHistoryLoader::load()
+{
+    if ( _thread )  // Already busy
+        return;
+
+    ZyppHistory * history = ZyppHistory::instance();
+
+    if ( ! history->needsFullParse() )
+    {
+        history->read();  // Just the cache and maybe a few appended lines
+        return;
+    }
+
+    _fileName = ZyppHistory::fileName();
+    _file.setFileName( _fileName );
+
+    if ( _file.open( QIODevice::ReadOnly ) )
+    {
+        _fileState      = ZyppHistory::fileState();
+        _size           = _file.size();
+        _fileState.size = _size;
+        _mapped         = _size > 0 ? _file.map( 0, _size ) : 0;
+    }
+
+    if ( ! _mapped )
+    {
+        // Can't open it (read() reports that), or not a regular file (e.g. a
+        // pipe), or it's empty: Use the conventional way.
+
+        cleanup();
+        history->read();  // This may throw
+        return;
+    }
+
+    logInfo() << "Parsing zypp history file " << _fileName << " in the background" << endl;
+
+    history->setPartialEvents( EventStore() );
+
+    _events.clear();
+    _leadingEvents = false;
+    _resumePoint   = ZyppHistoryParser::ResumePoint();
+    _bytesParsed   = 0;
+    _canceled.storeRelaxed( 0 );
+    _timer.start();
+
+    _thread = QThread::create( [this]() { parseBackwards(); } );
+    CHECK_NEW( _thread );
+
+    connect( _thread, SIGNAL( finished()       ),
+             this,    SLOT  ( workerFinished() ) );
+
+    _thread->start();
+}
+
+
+void ZyppHistoryLoader::parseBackwards()
+{
+    // Worker thread: No logging and no exceptions here!
+
+    const char * data     = (const char *) _mapped;
+    const char * chunkEnd = data + _size;
+    qint64       maxSize  = FIRST_CHUNK_SIZE;
+
+    while ( chunkEnd > data && ! _canceled.loadRelaxed() )
+    {
+        const char * start = chunkStart( data, chunkEnd, maxSize );
+        Chunk *      chunk = new Chunk( _fileName );
+
+        chunk->size = chunkEnd - start;
+        chunk->parser.parseChunk( chunk->events, start, chunk->size, start - data,
+                                  &_canceled );
+
+        if ( _canceled.loadRelaxed() )  // Incomplete chunk
+        {
+            delete chunk;
+            break;
+        }
+
+        {
+            QMutexLocker locker( &_mutex );
+            _parsedChunks << chunk;
+        }
+
+        emit chunkParsed();
+
+        chunkEnd = start;
+        maxSize *= 2;
+    }
+}
+
+
+const char *
+ZyppHistoryLoader::chunkStart( const char * data,
+                               const char * end,
+                               qint64       maxSize )
+{
+    while ( end - data > maxSize )
+    {
+        // Find the first command line after 'pos', so the chunk doesn't start
+        // in the middle of a command
+
+        const char * pos = end - maxSize;
+
+        while ( pos < end )
+        {
+            const char * newline = (const char *) memchr( pos, '\n', end - pos );
+
+            if ( ! newline || newline + 1 >= end )
+                break;
+
+            const char * lineStart = newline + 1;
+            const char * lineEnd   = (const char *) memchr( lineStart, '\n', end - lineStart );
+
+            if ( ! lineEnd )
+                lineEnd = end;
+
+            if ( ZyppHistoryParser::isCommandLine( lineStart, lineEnd ) )
+                return lineStart;
+
+            pos = lineEnd;
+        }
+
+        // No command in the last 'maxSize' bytes: Try a larger chunk
+
+        maxSize *= 2;
+    }
+
+    return data;
+}
+
+
+void ZyppHistoryLoader::processParsedChunks()
+{
+    QList<Chunk *> chunks;
+
+    {
+        QMutexLocker locker( &_mutex );
+        chunks.swap( _parsedChunks );
+    }
+
+    if ( chunks.isEmpty() )
+        return;
+
+    for ( Chunk * chunk: chunks )
+        prependChunk( chunk );
+
+    ZyppHistory::instance()->setPartialEvents( _events );
+
+    emit eventsChanged();
+    emit progress( _bytesParsed, _size, _timer.elapsed() );
+}
+
+
+void ZyppHistoryLoader::prependChunk( Chunk * chunk )
+{
+    ZyppHistoryParser & parser      = chunk->parser;
+    EventStore &        chunkEvents = chunk->events;
+    bool                isLastChunk = _chunks.isEmpty();  // The end of the file
+    bool                isEmpty     = chunkEvents.isEmpty();
+
+    if ( isLastChunk )
+    {
+        // Continue from the last command there when lines are appended.
+        // Without any command, parse everything again.
+
+        _resumePoint = parser._commandSeen ?
+            parser.resumePoint() : ZyppHistoryParser::ResumePoint();
+    }
+
+    // The events parsed so far start with a command line unless they start
+    // with the beginning of the file or with a command line that could not
+    // be parsed; see also ZyppHistoryParser::mergeChunk().
+
+    bool continueLastCommand = _leadingEvents && ! chunkEvents.isEmpty();
+
+    if ( ! continueLastCommand )
+        chunkEvents.dropEmptyLastCommand();
+
+    int commandBase = chunkEvents.commandCount() - ( continueLastCommand ? 1 : 0 );
+    int eventBase   = chunkEvents.eventCount();
+
+    chunkEvents.append( _events, continueLastCommand );
+    _events = chunkEvents;
+    chunkEvents.clear();
+
+    if ( ! isLastChunk && _resumePoint.offset > 0 )
+    {
+        // The events and lines of the last chunk are now further back
+
+        _resumePoint.lineNo       += parser._lineNo;
+        _resumePoint.commandCount += commandBase;
+        _resumePoint.eventCount   += eventBase;
+    }
+
+    if ( ! isEmpty )
+        _leadingEvents = parser._leadingEvents;
+
+    _bytesParsed += chunk->size;
+    _chunks.prepend( chunk );  // Keep the parser for the parse errors
+}
+
+
+void ZyppHistoryLoader::workerFinished()
+{
+    processParsedChunks();  // Anything that is left
+
+    delete _thread;
+    _thread = 0;
+
+    if ( ! _canceled.loadRelaxed() )
+        finish();
+
+    cleanup();
+}
+
+
+void ZyppHistoryLoader::finish()
+{
+    // Log the parse errors of all chunks in the order of the file
+
+    ZyppHistoryParser errorParser( _fileName );
+
+    try
+    {
+        for ( Chunk * chunk: _chunks )
+            errorParser.mergeChunkErrors( chunk->parser );
+    }
+    catch ( const ZyppHistoryParseException & exception )
+    {
+        CAUGHT( exception );
+
+        _events.clear();
+        ZyppHistory::instance()->setParseFailed();
+
+        emit failed();
+        return;
+    }
+
+    if ( _leadingEvents )
+        logInfo() << "Zypp history file does not start with a command" << endl;
+
+    _events.squeeze();
+
+    logInfo() << "Parsing finished after "
+              << _timer.elapsed() / 1000.0 << " sec" << endl;
+
+    logDebug() << "Lines read: " << errorParser._lineNo
+               << " total history events: " << errorParser._eventCount
+               << " command events: " << _events.commandCount()
+               << " strings: " << _events.stringCount()
+               << endl;
+
+    ZyppHistory::instance()->setParsedEvents( _events, _fileState, _resumePoint );
+    _events.clear();
+
+    emit eventsChanged();
+    emit progress( _size, _size, _timer.elapsed() );
+}
+
+
+void ZyppHistoryLoader::cleanup()
+{
+    qDeleteAll( _parsedChunks );
+    _parsedChunks.clear();
+
+    qDeleteAll( _chunks );
+    _chunks.clear();
+
+    _events.clear();
+
+    if ( _mapped )
+    {
+        _file.unmap( _mapped );
+        _mapped = 0;
+    }
+
+    _file.close();
+}
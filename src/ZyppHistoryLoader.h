@@ -0,0 +1,196 @@
+/*  ---------------------------------------------------------
+               __  __            _
+              |  \/  |_   _ _ __| |_   _ _ __
+              | |\/| | | | | '__| | | | | '_ \
+              | |  | | |_| | |  | | |_| | | | |
+              |_|  |_|\__, |_|  |_|\__, |_| |_|
+                      |___/        |___/
+    ---------------------------------------------------------
+
+    Project:  Myrlyn Package Manager GUI
+    Copyright (c) Stefan Hundhammer <Stefan.Hundhammer@gmx.de>
+    License:  GPL V2 - See file LICENSE for details.
+
+ */
+
+
+#ifndef ZyppHistoryLoader_h
+#define ZyppHistoryLoader_h
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+
+#include "ZyppHistory.h"
+#include "ZyppHistoryEvents.h"
+#include "ZyppHistoryParser.h"
+
+
+class QThread;
+
+
+/**
+ * Loader for the zypp history that parses the file in a background thread
+ * if that takes a while, i.e. if there is no usable parse result from the
+ * last time (see ZyppHistory).
+ *
+ * It parses the file from the end backwards in chunks that start with a
+ * command line, so the most recent days are available first. The first
+ * chunk is small, each one after that twice as large as the one before.
+ * Each parsed chunk is put in front of the events that were parsed so far,
+ * and the result is set in ZyppHistory::instance() right away, so the
+ * history browser can show it while older days are still being parsed.
+ *
+ * libzypp is not involved here, and the worker thread doesn't log anything
+ * (the logger is not thread-safe); all the merging and logging happens in
+ * the main thread.
+ **/
+class ZyppHistoryLoader: public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * Constructor.
+     **/
+    ZyppHistoryLoader( QObject * parent = 0 );
+
+    /**
+     * Destructor. If the file is still being parsed, this stops the worker
+     * thread and clears the partial result.
+     **/
+    virtual ~ZyppHistoryLoader();
+
+    /**
+     * Make the zypp history available in ZyppHistory::instance():
+     *
+     * If it can use the cache and maybe parse a few appended lines, or if
+     * the file can't be mapped into memory, this simply calls
+     * ZyppHistory::read(). This may throw the same exceptions.
+     *
+     * Otherwise, this starts parsing the file in the background and returns
+     * immediately; watch the eventsChanged() signal.
+     **/
+    void load();
+
+    /**
+     * Return 'true' if the file is currently being parsed in the background.
+     **/
+    bool isLoading() const { return _thread != 0; }
+
+
+signals:
+
+    /**
+     * Emitted when more (older) events are available in
+     * ZyppHistory::instance()->events(), and when they are complete.
+     **/
+    void eventsChanged();
+
+    /**
+     * Emitted when 'bytesParsed' of 'bytesTotal' of the file were parsed
+     * in 'millisec' milliseconds.
+     **/
+    void progress( qint64 bytesParsed, qint64 bytesTotal, qint64 millisec );
+
+    /**
+     * Emitted when parsing the file failed because of too many parse errors.
+     * ZyppHistory::instance() is empty then.
+     **/
+    void failed();
+
+    /**
+     * Emitted by the worker thread when it parsed another chunk.
+     * Internal use only.
+     **/
+    void chunkParsed();
+
+
+protected slots:
+
+    /**
+     * Put the chunks that the worker thread parsed in front of the events
+     * so far.
+     **/
+    void processParsedChunks();
+
+    /**
+     * Notification that the worker thread is finished.
+     **/
+    void workerFinished();
+
+
+protected:
+
+    /**
+     * One chunk of the file, parsed by its own parser into its own
+     * EventStore.
+     **/
+    struct Chunk
+    {
+        Chunk( const QString & fileName ): parser( fileName ) {}
+
+        ZyppHistoryParser              parser;
+        ZyppHistoryEvents::EventStore  events;
+        qint64                         size;
+    };
+
+    /**
+     * Parse the mapped file in chunks from the end backwards.
+     * This runs in the worker thread.
+     **/
+    void parseBackwards();
+
+    /**
+     * Return the start of the chunk that ends at 'end': The start of the
+     * first command line in the last 'maxSize' bytes before 'end', or 'data'
+     * (the start of the file) if that is closer.
+     **/
+    static const char * chunkStart( const char * data,
+                                    const char * end,
+                                    qint64       maxSize );
+
+    /**
+     * Put the events of 'chunk' in front of the events parsed so far.
+     **/
+    void prependChunk( Chunk * chunk );
+
+    /**
+     * Log the parse errors and hand over the complete result to
+     * ZyppHistory.
+     **/
+    void finish();
+
+    /**
+     * Unmap and close the file and delete all chunks.
+     **/
+    void cleanup();
+
+
+    // Data members
+
+    QString                         _fileName;
+    QFile                           _file;
+    uchar *                         _mapped;
+    qint64                          _size;
+    ZyppHistory::FileState          _fileState;
+
+    QThread *                       _thread;
+    QAtomicInt                      _canceled;
+    QMutex                          _mutex;         // for _parsedChunks
+    QList<Chunk *>                  _parsedChunks;  // from the worker thread
+
+    QList<Chunk *>                  _chunks;        // merged, in file order
+    ZyppHistoryEvents::EventStore   _events;        // merged so far
+    bool                            _leadingEvents; // before the first command
+    ZyppHistoryParser::ResumePoint  _resumePoint;
+    qint64                          _bytesParsed;
+    QElapsedTimer                   _timer;
+};
+
+
+#endif // ZyppHistoryLoader_h
@@ -14,9 +14,11 @@
  */
 
 
+#include <cstring>      // memchr()
+
 #include <QFile>
-#include <QTextStream>
 #include <QElapsedTimer>
+#include <QThread>
 
 #include "ZyppHistoryParser.h"
 #include "Logger.h"
@@ -24,16 +26,28 @@
 
 #define MAX_ERR_COUNT       100
 #define MAX_ZYPPER_ARG_LEN  100
+#define MIN_CHUNK_SIZE      ( 4 * 1024 * 1024 )  // Don't bother with threads below that
 
 using namespace ZyppHistoryEvents;
 
 
+int ZyppHistoryParser::_maxThreads = 0;
+
+
 ZyppHistoryParser::ZyppHistoryParser( const QString & fileName ):
     _fileName( fileName ),
+    _fileSize(0),
+    _dataOffset(0),
+    _lineOffset(0),
     _lineNo(0),
     _errCount(0),
     _eventCount(0),
-    _lastCommand(0)
+    _commandSeen( false ),
+    _isChunk( false ),
+    _leadingEvents( false ),
+    _gaveUp( false ),
+    _canceled(0),
+    _events(0)
 {
     // NOP
 }
@@ -45,12 +59,13 @@ ZyppHistoryParser::~ZyppHistoryParser()
 }
 
 
-EventList
-ZyppHistoryParser::parse()
+void ZyppHistoryParser::parse( EventStore & events,
+                               qint64       startOffset,
+                               int          startLineNo )
 {
     QFile file( _fileName );
 
-    if ( ! file.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    if ( ! file.open( QIODevice::ReadOnly ) )
     {
         QString msg = QString( "Can't open %1" ).arg( _fileName );
         logError() << msg << endl;
@@ -58,104 +73,462 @@ ZyppHistoryParser::parse()
     }
 
 
-    _events.clear();
-    _lastCommand = 0;
+    _events      = &events;
     _errCount    = 0;
-    _lineNo      = 0;
+    _lineNo      = startLineNo;
     _eventCount  = 0;
+    _commandSeen = false;
+    _fileSize    = file.size();
+    _dataOffset  = qMin( startOffset, _fileSize );
+    _resumePoint.offset       = _dataOffset;
+    _resumePoint.lineNo       = _lineNo;
+    _resumePoint.commandCount = events.commandCount();
+    _resumePoint.eventCount   = events.eventCount();
 
     QElapsedTimer timer;
     timer.start();
 
-    logInfo() << "Parsing zypp history file " << _fileName << endl;
+    if ( _dataOffset == 0 )
+        logInfo() << "Parsing zypp history file " << _fileName << endl;
+    else
+        logInfo() << "Parsing zypp history file " << _fileName << " from byte " << _dataOffset << endl;
 
-    QTextStream stream( &file );
+    qint64       size   = _fileSize - _dataOffset;
+    uchar *      mapped = size > 0 ? file.map( _dataOffset, size ) : 0;
+    QByteArray   buffer;
+    const char * data   = (const char *) mapped;
 
-    while ( ! stream.atEnd() )
+    if ( ! mapped )
     {
-        QString line = stream.readLine().trimmed();
-        _lineNo++;
+        // Not a regular file (e.g. a pipe), or it can't be mapped:
+        // Read it the conventional way.
+
+        if ( _dataOffset > 0 )
+            file.seek( _dataOffset );
+
+        buffer = file.readAll();
+        data   = buffer.constData();
+        size   = buffer.size();
+        _fileSize = _dataOffset + size;
+    }
+
+    try
+    {
+        int threads = threadCount( size );
+
+        if ( threads > 1 )
+            parseParallel( data, size, threads );
+        else
+            parse( data, size );
+    }
+    catch ( ... )
+    {
+        _stringIds.clear();
+        _events = 0;
+
+        if ( mapped )
+            file.unmap( mapped );
 
-        if ( ! line.isEmpty() && ! line.startsWith( "#" ) )
-            parseLine( line );
+        throw;
     }
 
+    _stringIds.clear(); // The keys point into the mapped file
+
+    if ( mapped )
+        file.unmap( mapped );
+
     finalizeLastCommand();
 
+    if ( _dataOffset == 0 ) // Not worthwhile for just a few appended lines
+        events.squeeze();
+
+    _events = 0;
+
     logInfo() << "Parsing finished after "
               << timer.elapsed() / 1000.0 << " sec" << endl;
 
     logDebug() << "Lines read: " << _lineNo
                << " total history events: " << _eventCount
-               << " command events: " << _events.size()
+               << " command events: " << events.commandCount()
+               << " strings: " << events.stringCount()
                << endl;
+}
+
+
+void ZyppHistoryParser::parse( const char * data, qint64 size )
+{
+    const char * end       = data + size;
+    const char * lineStart = data;
+
+    while ( lineStart < end && ! _gaveUp &&
+            ! ( _canceled && _canceled->loadRelaxed() ) )
+    {
+        const char * lineEnd = (const char *) memchr( lineStart, '\n', end - lineStart );
+
+        if ( ! lineEnd )
+            lineEnd = end;
+
+        _lineNo++;
+        _lineOffset = _dataOffset + ( lineStart - data );
+        parseLine( lineStart, lineEnd );
+        lineStart = lineEnd + 1;
+    }
+}
+
+
+int ZyppHistoryParser::threadCount( qint64 size )
+{
+    int threads = _maxThreads > 0 ? _maxThreads : QThread::idealThreadCount();
+
+    return (int) qMin( (qint64) threads, size / MIN_CHUNK_SIZE );
+}
+
+
+void ZyppHistoryParser::parseParallel( const char * data, qint64 size, int chunkCount )
+{
+    const char * end = data + size;
+
+    // Split the data into chunks of about the same size at line boundaries
+
+    QList<const char *> chunkStarts;
+    chunkStarts << data;
+
+    for ( int i = 1; i < chunkCount; i++ )
+    {
+        const char * pos = data + size * i / chunkCount;
+
+        if ( pos <= chunkStarts.last() )
+            continue;
+
+        const char * newline = (const char *) memchr( pos, '\n', end - pos );
+
+        if ( ! newline || newline + 1 >= end )
+            break;
+
+        chunkStarts << newline + 1;
+    }
+
+    chunkCount = chunkStarts.size();
+    chunkStarts << end;
+
+    logDebug() << "Parsing in " << chunkCount << " threads" << endl;
+
+    // Parse each chunk in its own thread into its own EventStore
+
+    QList<ZyppHistoryParser *> chunkParsers;
+    QList<QThread *>           threads;
+    QVector<EventStore>        chunkEvents( chunkCount );
+
+    for ( int i = 0; i < chunkCount; i++ )
+    {
+        ZyppHistoryParser * chunkParser = new ZyppHistoryParser( _fileName );
+        CHECK_NEW( chunkParser );
+        chunkParsers << chunkParser;
+
+        const char * chunkData   = chunkStarts.at( i );
+        qint64       chunkSize   = chunkStarts.at( i + 1 ) - chunkData;
+        qint64       chunkOffset = _dataOffset + ( chunkData - data );
+        EventStore * events      = &chunkEvents[ i ];
+
+        QThread * thread = QThread::create( [=]()
+            {
+                chunkParser->parseChunk( *events, chunkData, chunkSize, chunkOffset );
+            } );
+        CHECK_NEW( thread );
+
+        threads << thread;
+        thread->start();
+    }
 
-    return _events;
+    for ( QThread * thread: threads )
+        thread->wait();
+
+    qDeleteAll( threads );
+
+    // Merge the results in the order of the chunks
+
+    try
+    {
+        for ( int i = 0; i < chunkCount; i++ )
+        {
+            mergeChunk( *chunkParsers.at( i ), chunkEvents.at( i ) );
+            chunkEvents[ i ].clear();  // Free the memory as soon as possible
+        }
+    }
+    catch ( ... )
+    {
+        qDeleteAll( chunkParsers );
+        throw;
+    }
+
+    qDeleteAll( chunkParsers );
+}
+
+
+void ZyppHistoryParser::parseChunk( EventStore &       events,
+                                    const char *       data,
+                                    qint64             size,
+                                    qint64             dataOffset,
+                                    const QAtomicInt * canceled )
+{
+    _events     = &events;
+    _isChunk    = true;
+    _dataOffset = dataOffset;
+    _canceled   = canceled;
+
+    parse( data, size );
+
+    // Intentionally not calling finalizeLastCommand() here: The last command
+    // might still get child events from the next chunk.
+
+    _stringIds.clear(); // The keys point into the mapped file
+    _events = 0;
+}
+
+
+void ZyppHistoryParser::mergeChunk( const ZyppHistoryParser & chunkParser,
+                                    const EventStore &        chunkEvents )
+{
+    int lineBase = _lineNo;
+    mergeChunkErrors( chunkParser );  // This may throw
+
+    // Events at the start of the chunk before its first command belong to
+    // the last command of the previous chunk. If there is none, this is the
+    // beginning of the file, and the artificial command of the chunk is
+    // needed.
+
+    bool continueLastCommand = chunkParser._leadingEvents && ! _events->isEmpty();
+
+    if ( chunkParser._leadingEvents && _events->isEmpty() )
+        logInfo() << "Zypp history file does not start with a command" << endl;
+
+    int eventBase = _events->eventCount();
+    _events->append( chunkEvents, continueLastCommand );
+
+    if ( chunkParser._commandSeen )
+    {
+        // Translate the resume point of the chunk to the merged events
+
+        int skippedCommands = continueLastCommand ? 1 : 0;
+        int commandBase     = _events->commandCount() - ( chunkEvents.commandCount() - skippedCommands );
+        const ResumePoint & chunkResumePoint = chunkParser.resumePoint();
+
+        _resumePoint.offset       = chunkResumePoint.offset;
+        _resumePoint.lineNo       = lineBase    + chunkResumePoint.lineNo;
+        _resumePoint.commandCount = commandBase + chunkResumePoint.commandCount - skippedCommands;
+        _resumePoint.eventCount   = eventBase   + chunkResumePoint.eventCount;
+        _commandSeen = true;
+    }
+}
+
+
+void ZyppHistoryParser::mergeChunkErrors( const ZyppHistoryParser & chunkParser )
+{
+    for ( const QPair<int, QString> & error: chunkParser._chunkErrors )
+        logError() << error.second << " in line " << _lineNo + error.first << endl;
+
+    _lineNo     += chunkParser._lineNo;
+    _errCount   += chunkParser._errCount;
+    _eventCount += chunkParser._eventCount;
+
+    if ( chunkParser._gaveUp || _errCount >= MAX_ERR_COUNT )
+        THROW( ZyppHistoryParseException( "Too many parse errors - giving up" ) );
 }
 
 
-void ZyppHistoryParser::parseLine( const QString & line )
+static inline bool isSpace( char c )
 {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+
+/**
+ * Return 'field' without leading and trailing whitespace.
+ **/
+static inline QByteArrayView trimmedField( QByteArrayView field )
+{
+    const char * begin = field.data();
+    const char * end   = begin + field.size();
+
+    while ( begin < end && isSpace( *begin ) )
+        ++begin;
+
+    while ( end > begin && isSpace( end[-1] ) )
+        --end;
+
+    return QByteArrayView( begin, end - begin );
+}
+
+
+bool ZyppHistoryParser::isCommandLine( const char * begin, const char * end )
+{
+    // 2025-12-09 17:54:12|command|root@meteor|'zypper' 'dup'|
+    //      0                 1         2            3
+
+    const char * sep = (const char *) memchr( begin, '|', end - begin );
+
+    if ( ! sep )
+        return false;
+
+    ++sep;
+
+    const char * fieldEnd = (const char *) memchr( sep, '|', end - sep );
+
+    if ( ! fieldEnd )
+        return false;
+
+    QByteArrayView field = trimmedField( QByteArrayView( sep, fieldEnd - sep ) );
+
+    return field.size() == 7 && qstrnicmp( field.data(), "command", 7 ) == 0;
+}
+
+
+bool ZyppHistoryParser::splitFields( const char * begin,
+                                     const char * end,
+                                     Fields &     fields )
+{
+    fields.count = 0;
+
+    while ( fields.count < MaxFields )
+    {
+        const char * sep = (const char *) memchr( begin, '|', end - begin );
+
+        if ( ! sep )
+            sep = end;
+
+        fields.field[ fields.count++ ] = QByteArrayView( begin, sep - begin );
+
+        if ( sep == end )
+            return true;
+
+        begin = sep + 1;
+    }
+
+    return false;  // There are more fields
+}
+
+
+void ZyppHistoryParser::parseLine( const char * begin, const char * end )
+{
+    // Trim leading and trailing whitespace (including a '\r' from DOS line
+    // endings)
+
+    while ( begin < end && isSpace( *begin ) )
+        ++begin;
+
+    while ( end > begin && isSpace( end[-1] ) )
+        --end;
+
+    if ( begin == end || *begin == '#' )
+        return;
+
     // 2025-12-09 17:54:12|install|MozillaFirefox|145.0.2-1.1|x86_64|root@meteor|slowroll-oss|2ead...b676|
     //      0                 1          2            3         4         5         6            7
-    QStringList fields = line.split( '|' );
+    Fields fields;
+
+    if ( ! splitFields( begin, end, fields ) )
+    {
+        // No event type uses that many fields; still use the first ones
+
+        parseError( QString( "More than %1 fields" ).arg( (int) MaxFields ) );
+
+        incErrCount(); // this may throw an exception
+    }
 
     if ( ! checkFieldsCount( fields, 2 ) )
         return;
 
-    Event * event = 0;
     EventType eventType = parseEventType( fields.at( 1 ) );
 
+    if ( eventType == EventType::Unknown )
+        return;
+
+    Timestamp timestamp = packTimestamp( fields.at( 0 ) );
+
+    if ( timestamp == 0 )
+    {
+        parseError( QString( "Invalid timestamp \"%1\"" ).arg( QString::fromUtf8( fields.at( 0 ) ) ) );
+
+        incErrCount(); // this may throw an exception
+        return;
+    }
+
+    bool ok = false;
+
     switch ( eventType )
     {
-        case EventType::Command:     event = parseCommandEvent   ( fields ); break;
-        case EventType::PkgInstall:  event = parsePkgInstallEvent( fields ); break;
-        case EventType::PkgRemove:   event = parsePkgRemoveEvent ( fields ); break;
-        case EventType::RepoAdd:     event = parseRepoAddEvent   ( fields ); break;
-        case EventType::RepoRemove:  event = parseRepoRemoveEvent( fields ); break;
-        case EventType::RepoUrl:     event = parseRepoUrlEvent   ( fields ); break;
-        case EventType::RepoAlias:   event = parseRepoAliasEvent ( fields ); break;
-        case EventType::Patch:       event = parsePatchEvent     ( fields ); break;
+        case EventType::Command:     ok = parseCommandEvent   ( fields, timestamp ); break;
+        case EventType::PkgInstall:  ok = parsePkgInstallEvent( fields, timestamp ); break;
+        case EventType::PkgRemove:   ok = parsePkgRemoveEvent ( fields, timestamp ); break;
+        case EventType::RepoAdd:     ok = parseRepoAddEvent   ( fields, timestamp ); break;
+        case EventType::RepoRemove:  ok = parseRepoRemoveEvent( fields, timestamp ); break;
+        case EventType::RepoUrl:     ok = parseRepoUrlEvent   ( fields, timestamp ); break;
+        case EventType::RepoAlias:   ok = parseRepoAliasEvent ( fields, timestamp ); break;
+        case EventType::Patch:       ok = parsePatchEvent     ( fields, timestamp ); break;
 
         case EventType::Unknown:
             break;
     }
 
-    if ( event )
-    {
-        event->timestamp = fields.at( 0 );
-        event->eventType = eventType;
+    if ( ok )
         _eventCount++;
-
-        if ( eventType != EventType::Command )
-            addChildEvent( event );
-    }
 }
 
 
 EventType
-ZyppHistoryParser::parseEventType( const QString & strOrig )
+ZyppHistoryParser::parseEventType( QByteArrayView rawField )
 {
-    QString str = strOrig.trimmed().toLower();
+    // libzypp pads this field with blanks to 7 characters: "patch  ", "radd   "
 
-    if ( str == "command" ) return EventType::Command;
-    if ( str == "install" ) return EventType::PkgInstall;
-    if ( str == "remove"  ) return EventType::PkgRemove;
-    if ( str == "radd"    ) return EventType::RepoAdd;
-    if ( str == "rremove" ) return EventType::RepoRemove;
-    if ( str == "rurl"    ) return EventType::RepoUrl;
-    if ( str == "ralias"  ) return EventType::RepoAlias;
-    if ( str == "patch"   ) return EventType::Patch;
+    QByteArrayView field = trimmedField( rawField );
 
-    logError() << "Unknown zypp history event type \"" << str << "\""
-               << " in line " << _lineNo << endl;
+    // Dispatch on the length first; only compare the bytes of a candidate
+
+    switch ( field.size() )
+    {
+        case 4:
+            if ( qstrnicmp( field.data(), "radd",    4 ) == 0 ) return EventType::RepoAdd;
+            if ( qstrnicmp( field.data(), "rurl",    4 ) == 0 ) return EventType::RepoUrl;
+            break;
+
+        case 5:
+            if ( qstrnicmp( field.data(), "patch",   5 ) == 0 ) return EventType::Patch;
+            break;
+
+        case 6:
+            if ( qstrnicmp( field.data(), "remove",  6 ) == 0 ) return EventType::PkgRemove;
+            if ( qstrnicmp( field.data(), "ralias",  6 ) == 0 ) return EventType::RepoAlias;
+            break;
+
+        case 7:
+            if ( qstrnicmp( field.data(), "command", 7 ) == 0 ) return EventType::Command;
+            if ( qstrnicmp( field.data(), "install", 7 ) == 0 ) return EventType::PkgInstall;
+            if ( qstrnicmp( field.data(), "rremove", 7 ) == 0 ) return EventType::RepoRemove;
+            break;
+    }
+
+    parseError( QString( "Unknown zypp history event type \"%1\"" ).arg( QString::fromUtf8( field ) ) );
 
     return EventType::Unknown;
 }
 
 
-Event *
-ZyppHistoryParser::parseCommandEvent( const QStringList & fields )
+StringId ZyppHistoryParser::str( QByteArrayView field )
+{
+    QHash<QByteArrayView, StringId>::const_iterator it = _stringIds.constFind( field );
+
+    if ( it != _stringIds.constEnd() )
+        return it.value();
+
+    // Only convert the bytes to a QString the first time they appear
+    StringId id = _events->addString( QString::fromUtf8( field ) );
+    _stringIds.insert( field, id );
+
+    return id;
+}
+
+
+bool ZyppHistoryParser::parseCommandEvent( const Fields & fields, Timestamp timestamp )
 {
     //        #0             #1        #2         #3
     // 2024-09-13 17:42:20|command|root@meteor|'zypper' 'in' 'xhost'|
@@ -165,178 +538,168 @@ ZyppHistoryParser::parseCommandEvent( const QStringList & fields )
     // 2026-01-01 19:54:45|command|root@meteor|'/usr/bin/myrlyn'|
 
     if ( ! checkFieldsCount( fields, 4 ) )
-        return 0;
+        return false;
 
     finalizeLastCommand();
-    CommandEvent * event = new CommandEvent;
-    CHECK_NEW( event );
 
-    QString command = fields.at( 3 ).simplified();
+    _resumePoint.offset       = _lineOffset;
+    _resumePoint.lineNo       = _lineNo - 1;  // Without this line
+    _resumePoint.commandCount = _events->commandCount();
+    _resumePoint.eventCount   = _events->eventCount();
+    _commandSeen              = true;
+
+    QString command = QString::fromUtf8( fields.at( 3 ) ).simplified();
     command.remove( '\'' ); // Remove all single quotes: 'zypper' 'in' 'xhost'
-    event->rawCommand = command;
-    event->command    = prettyCommand( command );
-    _lastCommand      = event;
 
-    // Intentionally not doing
-    //
-    //   _events << event;
-    //
-    // here and now: This is done in finalizeLastCommand(), but only if it has
-    // child events.
+    // If this command doesn't get any child events, finalizeLastCommand()
+    // will remove it again.
 
-    return event;
+    _events->addCommand( timestamp,
+                         _events->addString( prettyCommand( command ) ),
+                         _events->addString( command ) );
+
+    return true;
 }
 
 
-Event *
-ZyppHistoryParser::parsePkgInstallEvent( const QStringList & fields )
+bool ZyppHistoryParser::parsePkgInstallEvent( const Fields & fields, Timestamp timestamp )
 {
     //      #0                #1       #2     #3      #4       #5              #6                    #7
     // 2024-09-13 18:20:50|install|qdirstat|1.9-1.3|x86_64|root@meteor|download.opensuse.org-oss|4138...527a0|
 
     if ( ! checkFieldsCount( fields, 7 ) )
-        return 0;
-
-    PkgEvent * event = new PkgEvent;
-    CHECK_NEW( event );
-
-    event->name      = fields.at( 2 );
-    event->version   = fields.at( 3 );
-    event->arch      = fields.at( 4 );
-    event->repoAlias = fields.at( 6 );
-
-    return event;
+        return false;
+
+    ensureCommand( timestamp );
+    _events->addPkgEvent( EventType::PkgInstall,
+                          timestamp,
+                          str( fields.at( 2 ) ),    // name
+                          str( fields.at( 3 ) ),    // version
+                          str( fields.at( 4 ) ),    // arch
+                          str( fields.at( 6 ) ) );  // repoAlias
+    return true;
 }
 
 
-Event *
-ZyppHistoryParser::parsePkgRemoveEvent( const QStringList & fields )
+bool ZyppHistoryParser::parsePkgRemoveEvent( const Fields & fields, Timestamp timestamp )
 {
     //      #0               #1       #2      #3       #4      #5
     // 2024-09-13 18:13:28|remove |drkonqi6|6.1.4-1.1|x86_64|root@meteor|
 
-    if ( ! checkFieldsCount( fields, 4 ) )
-        return 0;
-
-    PkgEvent * event = new PkgEvent;
-    CHECK_NEW( event );
-
-    event->name    = fields.at( 2 );
-    event->version = fields.at( 3 );
-    event->arch    = fields.at( 4 );
-
-    return event;
+    if ( ! checkFieldsCount( fields, 5 ) )
+        return false;
+
+    ensureCommand( timestamp );
+    _events->addPkgEvent( EventType::PkgRemove,
+                          timestamp,
+                          str( fields.at( 2 ) ),    // name
+                          str( fields.at( 3 ) ),    // version
+                          str( fields.at( 4 ) ),    // arch
+                          0 );                      // repoAlias
+    return true;
 }
 
 
-Event *
-ZyppHistoryParser::parseRepoAddEvent( const QStringList & fields )
+bool ZyppHistoryParser::parseRepoAddEvent( const Fields & fields, Timestamp timestamp )
 {
     //      #0              #1         #2                               #3
     // 2025-01-16 22:04:52|radd   |download.nvidia.com-tumbleweed|https://download.nvidia.com/opensuse/tumbleweed/|
 
     if ( ! checkFieldsCount( fields, 4 ) )
-        return 0;
-
-    RepoEvent * event = new RepoEvent;
-    CHECK_NEW( event );
-
-    event->repoAlias = fields.at( 2 );
-    event->url       = fields.at( 3 );
-
-    return event;
+        return false;
+
+    ensureCommand( timestamp );
+    _events->addRepoEvent( EventType::RepoAdd,
+                           timestamp,
+                           str( fields.at( 2 ) ),    // repoAlias
+                           str( fields.at( 3 ) ) );  // url
+    return true;
 }
 
 
-Event *
-ZyppHistoryParser::parseRepoRemoveEvent( const QStringList & fields )
+bool ZyppHistoryParser::parseRepoRemoveEvent( const Fields & fields, Timestamp timestamp )
 {
     //      #0               #1         #2
     // 2025-01-16 22:07:11|rremove|download.nvidia.com-tumbleweed|
 
     if ( ! checkFieldsCount( fields, 3 ) )
-        return 0;
-
-    RepoEvent * event = new RepoEvent;
-    CHECK_NEW( event );
-
-    event->repoAlias = fields.at( 2 );
-
-    return event;
+        return false;
+
+    ensureCommand( timestamp );
+    _events->addRepoEvent( EventType::RepoRemove,
+                           timestamp,
+                           str( fields.at( 2 ) ),    // repoAlias
+                           0 );                      // url
+    return true;
 }
 
 
-Event *
-ZyppHistoryParser::parseRepoUrlEvent( const QStringList & fields )
+bool ZyppHistoryParser::parseRepoUrlEvent( const Fields & fields, Timestamp timestamp )
 {
     //      #0              #1          #2                                                       #3
     // 2025-02-07 13:06:26|rurl   |http://codecs.opensuse.org/openh264/openSUSE_Tumbleweed|https://codecs.opensuse.org/openh264/openSUSE_Tumbleweed|
 
     if ( ! checkFieldsCount( fields, 4 ) )
-        return 0;
-
-    RepoEvent * event = new RepoEvent;
-    CHECK_NEW( event );
-
-    event->oldUrl = fields.at( 2 );
-    event->url    = fields.at( 3 );
-
-    return event;
+        return false;
+
+    ensureCommand( timestamp );
+    _events->addRepoEvent( EventType::RepoUrl,
+                           timestamp,
+                           0,                        // repoAlias
+                           str( fields.at( 3 ) ),    // url
+                           0,                        // oldRepoAlias
+                           str( fields.at( 2 ) ) );  // oldUrl
+    return true;
 }
 
 
-Event *
-ZyppHistoryParser::parseRepoAliasEvent( const QStringList & fields )
+bool ZyppHistoryParser::parseRepoAliasEvent( const Fields & fields, Timestamp timestamp )
 {
     //      #0               #1        #2                         #3
     // 2024-09-25 10:01:06|ralias |download.opensuse.org-oss_1|slowroll-update|
 
     if ( ! checkFieldsCount( fields, 4 ) )
-        return 0;
-
-    RepoEvent * event = new RepoEvent;
-    CHECK_NEW( event );
-
-    event->oldRepoAlias = fields.at( 2 );
-    event->repoAlias    = fields.at( 3 );
-
-    return event;
+        return false;
+
+    ensureCommand( timestamp );
+    _events->addRepoEvent( EventType::RepoAlias,
+                           timestamp,
+                           str( fields.at( 3 ) ),    // repoAlias
+                           0,                        // url
+                           str( fields.at( 2 ) ) );  // oldRepoAlias
+    return true;
 }
 
 
-Event *
-ZyppHistoryParser::parsePatchEvent( const QStringList & fields )
+bool ZyppHistoryParser::parsePatchEvent( const Fields & fields, Timestamp timestamp )
 {
     //      #0              #1        #2            #3   #4         #5                #6        #7       #8     #9
     // 2026-01-07 16:24:32|patch  |openSUSE-2024-157|1|noarch|repo-backports-update|important|security|needed|applied|
 
     if ( ! checkFieldsCount( fields, 10 ) )
-        return 0;
-
-    PatchEvent * event = new PatchEvent;
-    CHECK_NEW( event );
-
-    event->name       = fields.at( 2 );
-    event->version    = fields.at( 3 );
-    event->arch       = fields.at( 4 );
-    event->repoAlias  = fields.at( 5 );
-    event->patchState = fields.at( 9 );
-
-    return event;
+        return false;
+
+    ensureCommand( timestamp );
+    _events->addPatchEvent( timestamp,
+                            str( fields.at( 2 ) ),    // name
+                            str( fields.at( 3 ) ),    // version
+                            str( fields.at( 4 ) ),    // arch
+                            str( fields.at( 5 ) ),    // repoAlias
+                            str( fields.at( 9 ) ) );  // patchState
+    return true;
 }
 
 
 // ----------------------------------------------------------------------
 
 
-bool ZyppHistoryParser::checkFieldsCount( const QStringList & fields, int requiredCount )
+bool ZyppHistoryParser::checkFieldsCount( const Fields & fields, int requiredCount )
 {
     if ( fields.size() >= requiredCount )
         return true;  // ok
 
-    logError() << "Only " << fields.size() << " fields in line " << _lineNo
-               << " but at least " << requiredCount << " required"
-               << endl;
+    parseError( QString( "Only %1 fields but at least %2 required" )
+                .arg( fields.size() ).arg( requiredCount ) );
 
     incErrCount(); // this may throw an exception
 
@@ -344,40 +707,35 @@ bool ZyppHistoryParser::checkFieldsCount( const QStringList & fields, int requir
 }
 
 
-void ZyppHistoryParser::incErrCount()
+void ZyppHistoryParser::parseError( const QString & msg )
 {
-    if ( ++_errCount >= MAX_ERR_COUNT )
-        THROW( ZyppHistoryParseException( "Too many parse errors - giving up" ) );
+    if ( _isChunk )  // Not in the main thread: mergeChunk() logs this
+        _chunkErrors << qMakePair( _lineNo, msg );
+    else
+        logError() << msg << " in line " << _lineNo << endl;
 }
 
 
-void ZyppHistoryParser::finalizeLastCommand()
+void ZyppHistoryParser::incErrCount()
 {
-    if ( _lastCommand )
+    if ( ++_errCount >= MAX_ERR_COUNT )
     {
-        // Only append _lastCommand to _events if it has any child events to
-        // prevent lots of empty commands apearing in the history; e.g. when a
-        // user (like myself) often checks with Myrlyn if there are any
-        // updates, or if trying a zypper dry-run that has no effect.
-
-        if ( _lastCommand->hasChildEvents() )
-        {
-            _lastCommand->squeezeChildEvents();
-            _events << _lastCommand;
-        }
+        if ( _isChunk )
+            _gaveUp = true;  // mergeChunk() throws the exception
         else
-        {
-#if 0
-            logDebug() << "Deleting empty command "
-                       << _lastCommand->timestamp << " "
-                       << _lastCommand->command << endl;
-#endif
+            THROW( ZyppHistoryParseException( "Too many parse errors - giving up" ) );
+    }
+}
 
-            delete _lastCommand;
-        }
 
-        _lastCommand = 0;
-    }
+void ZyppHistoryParser::finalizeLastCommand()
+{
+    // Only keep the last command if it has any child events to prevent lots
+    // of empty commands apearing in the history; e.g. when a user (like
+    // myself) often checks with Myrlyn if there are any updates, or if trying
+    // a zypper dry-run that has no effect.
+
+    _events->dropEmptyLastCommand();
 }
 
 
@@ -431,26 +789,21 @@ QString ZyppHistoryParser::prettyCommand( const QString & rawCommandLine )
 }
 
 
-void ZyppHistoryParser::addChildEvent( Event * event )
+void ZyppHistoryParser::ensureCommand( Timestamp timestamp )
 {
-    CHECK_PTR( event );
-
-    if ( ! _lastCommand )
+    if ( _events->isEmpty() )
     {
         // Special case: The beginning of the history file was cut off, so the
         // history doesn't start with a command.  So let's create an artificial
-        // one as a bracket for the first events until a real command appears,
-        // and add this new child event to this artificial first one.
-
-        CommandEvent * commandEvent = new CommandEvent;
-        CHECK_NEW( commandEvent );
+        // one as a bracket for the first events until a real command appears.
 
-        commandEvent->command   = "<\?\?\?>";  // ?? is interpreted as a trigraph
-        commandEvent->timestamp = event->timestamp;
-        _lastCommand = commandEvent;
+        _events->addCommand( timestamp,
+                             _events->addString( "<\?\?\?>" ),  // ?? is interpreted as a trigraph
+                             0 );
 
-        logInfo() << "Zypp history file does not start with a command" << endl;
+        if ( _isChunk )
+            _leadingEvents = true;  // mergeChunk() takes care of this
+        else
+            logInfo() << "Zypp history file does not start with a command" << endl;
     }
-
-    _lastCommand->addChildEvent( event );
 }
@@ -16,14 +16,32 @@
 #ifndef ZyppHistoryParser_h
 #define ZyppHistoryParser_h
 
-#include <QTextStream>
+#include <QAtomicInt>
+#include <QByteArrayView>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
 
-#include "ZyppHistory.h"
+#include "ZyppHistoryEvents.h"
 #include "Exception.h"
 
 
+/**
+ * Parser for the zypp history file.
+ *
+ * This maps the file into memory and splits each line into fields that are
+ * just slices of the raw (UTF-8) bytes. The events are stored in an
+ * EventStore which only keeps the IDs of the strings; a field is only
+ * converted to QString the first time that its content appears.
+ *
+ * Large files are split into chunks at line boundaries that are parsed in
+ * parallel, each into its own EventStore; those are merged at the end.
+ **/
 class ZyppHistoryParser
 {
+    friend class ZyppHistoryLoader;  // Uses the chunk parsing
+
 public:
 
     /**
@@ -37,31 +55,162 @@ public:
     virtual ~ZyppHistoryParser();
 
     /**
-     * Parse the zypp history file and return the list of history events in
-     * that file. Ownership of the events is transferred to the caller.
+     * Parse the zypp history file from byte offset 'startOffset' on and add
+     * the history events to 'events'.
+     *
+     * 'startOffset' has to be the start of a line, and 'startLineNo' is the
+     * number of lines before it for counting the lines in error messages.
+     * To continue a previous parse, use its resumePoint() and truncate
+     * 'events' to the command and event count of that resume point first.
      *
      * This may throw Exceptions:
      *   - FileException
      *   - ZyppHistoryParseException
      **/
-    ZyppHistoryEvents::EventList parse();
+    void parse( ZyppHistoryEvents::EventStore & events,
+                qint64                          startOffset = 0,
+                int                             startLineNo = 0 );
+
+    /**
+     * Where to continue parsing when more lines are appended to the file:
+     * The start of the last command line, the number of lines in the file
+     * before it, and the number of commands and events in the event store
+     * before that line.
+     *
+     * The last command is parsed again from there because it might still be
+     * getting more child events, or it was dropped because it had none yet.
+     * This also takes care of a last line that was only partially written.
+     **/
+    struct ResumePoint
+    {
+        qint64 offset;
+        int    lineNo;
+        int    commandCount;
+        int    eventCount;
+
+        ResumePoint(): offset(0), lineNo(0), commandCount(0), eventCount(0) {}
+    };
+
+    /**
+     * Return the resume point of the last parse().
+     **/
+    const ResumePoint & resumePoint() const { return _resumePoint; }
+
+    /**
+     * Return the size of the file at the time of the last parse().
+     **/
+    qint64 fileSize() const { return _fileSize; }
+
+    /**
+     * Set the maximum number of threads for parsing large files.
+     * 0 (the default) means one for each CPU core; 1 disables threads.
+     **/
+    static void setMaxThreads( int maxThreads ) { _maxThreads = maxThreads; }
+
+    /**
+     * Return 'true' if the line from 'begin' to 'end' is a command line,
+     * i.e. the start of a new command.
+     **/
+    static bool isCommandLine( const char * begin, const char * end );
 
 protected:
 
-    void parseLine( const QString & line );
-    ZyppHistoryEvents::EventType parseEventType( const QString & str );
+    enum { MaxFields = 16 };
+
+    /**
+     * The fields of one line of the zypp history file, separated by '|'.
+     * Each field is a slice of the raw bytes of the file.
+     **/
+    struct Fields
+    {
+        QByteArrayView field[ MaxFields ];
+        int            count;
+
+        const QByteArrayView & at( int i ) const { return field[ i ]; }
+        int size() const { return count; }
+    };
+
+    /**
+     * Parse 'size' bytes of zypp history lines starting at 'data'.
+     **/
+    void parse( const char * data, qint64 size );
 
-    // Parse a history event of the given type and create an Event struct from it.
-    // Ownership is transferred to the caller.
+    /**
+     * Return the number of threads to use for parsing 'size' bytes.
+     **/
+    static int threadCount( qint64 size );
 
-    ZyppHistoryEvents::Event * parseCommandEvent   ( const QStringList & fields );
-    ZyppHistoryEvents::Event * parsePkgInstallEvent( const QStringList & fields );
-    ZyppHistoryEvents::Event * parsePkgRemoveEvent ( const QStringList & fields );
-    ZyppHistoryEvents::Event * parseRepoAddEvent   ( const QStringList & fields );
-    ZyppHistoryEvents::Event * parseRepoRemoveEvent( const QStringList & fields );
-    ZyppHistoryEvents::Event * parseRepoUrlEvent   ( const QStringList & fields );
-    ZyppHistoryEvents::Event * parseRepoAliasEvent ( const QStringList & fields );
-    ZyppHistoryEvents::Event * parsePatchEvent     ( const QStringList & fields );
+    /**
+     * Split 'size' bytes starting at 'data' into 'chunkCount' chunks, parse
+     * them in parallel and merge the results.
+     **/
+    void parseParallel( const char * data, qint64 size, int chunkCount );
+
+    /**
+     * Parse one chunk into 'events' in a worker thread. 'dataOffset' is the
+     * file offset of 'data'.
+     *
+     * If 'canceled' is set, this checks it before each line and stops
+     * parsing as soon as it is non-zero; the result is incomplete then.
+     *
+     * This doesn't log anything (the logger is not thread-safe) and it
+     * doesn't throw any exceptions; mergeChunk() takes care of that in the
+     * main thread.
+     **/
+    void parseChunk( ZyppHistoryEvents::EventStore & events,
+                     const char *                    data,
+                     qint64                          size,
+                     qint64                          dataOffset,
+                     const QAtomicInt *              canceled = 0 );
+
+    /**
+     * Merge the events of a chunk that 'chunkParser' parsed into
+     * 'chunkEvents' into the events of this parser.
+     **/
+    void mergeChunk( const ZyppHistoryParser &             chunkParser,
+                     const ZyppHistoryEvents::EventStore & chunkEvents );
+
+    /**
+     * Log the parse errors of a chunk that 'chunkParser' parsed with the
+     * line numbers of this parser and add its line and error counts to this
+     * parser. Throw an exception if there were too many errors.
+     **/
+    void mergeChunkErrors( const ZyppHistoryParser & chunkParser );
+
+    /**
+     * Report a parse error in the current line.
+     **/
+    void parseError( const QString & msg );
+
+    /**
+     * Parse one line from 'begin' to 'end' (exclusive, without the newline).
+     **/
+    void parseLine( const char * begin, const char * end );
+
+    /**
+     * Split a line into fields. Return 'false' if the line has more than
+     * MaxFields fields; the fields after that are not in 'fields'.
+     **/
+    static bool splitFields( const char * begin, const char * end, Fields & fields );
+
+    ZyppHistoryEvents::EventType parseEventType( QByteArrayView field );
+
+    // Parse a history event of the given type and add it to the event store.
+    // Return 'true' on success, 'false' on error.
+
+    bool parseCommandEvent   ( const Fields & fields, ZyppHistoryEvents::Timestamp timestamp );
+    bool parsePkgInstallEvent( const Fields & fields, ZyppHistoryEvents::Timestamp timestamp );
+    bool parsePkgRemoveEvent ( const Fields & fields, ZyppHistoryEvents::Timestamp timestamp );
+    bool parseRepoAddEvent   ( const Fields & fields, ZyppHistoryEvents::Timestamp timestamp );
+    bool parseRepoRemoveEvent( const Fields & fields, ZyppHistoryEvents::Timestamp timestamp );
+    bool parseRepoUrlEvent   ( const Fields & fields, ZyppHistoryEvents::Timestamp timestamp );
+    bool parseRepoAliasEvent ( const Fields & fields, ZyppHistoryEvents::Timestamp timestamp );
+    bool parsePatchEvent     ( const Fields & fields, ZyppHistoryEvents::Timestamp timestamp );
+
+    /**
+     * Return the string ID of a field in the event store.
+     **/
+    ZyppHistoryEvents::StringId str( QByteArrayView field );
 
     /**
      * Increase the parse error counter and throw an exception if it reaches a
@@ -74,24 +223,46 @@ protected:
      * Return 'true' if ok. If not, increase the error count and return
      * 'false'. Throw an exception if there are too many parse errors.
      **/
-    bool checkFieldsCount( const QStringList & fields, int requiredCount );
+    bool checkFieldsCount( const Fields & fields, int requiredCount );
 
     void    finalizeLastCommand();
     QString prettyCommand( const QString & rawCommand );
-    void    addChildEvent( ZyppHistoryEvents::Event * event );
+
+    /**
+     * Make sure there is a command for the next child event.
+     **/
+    void    ensureCommand( ZyppHistoryEvents::Timestamp timestamp );
 
 
     //
     // Data members
     //
 
-    QString _fileName;
-    int     _lineNo;
-    int     _errCount;
-    int     _eventCount;
+    static int  _maxThreads;
+
+    QString     _fileName;
+    qint64      _fileSize;
+    qint64      _dataOffset;    // File offset of the parsed data
+    qint64      _lineOffset;    // File offset of the current line
+    ResumePoint _resumePoint;
+    int         _lineNo;
+    int         _errCount;
+    int         _eventCount;
+    bool        _commandSeen;
+
+    // Only for parsing a chunk in a worker thread
+
+    bool        _isChunk;
+    bool        _leadingEvents; // Events before the first command
+    bool        _gaveUp;        // Too many parse errors
+    QList<QPair<int, QString> > _chunkErrors;  // line number, message
+    const QAtomicInt *          _canceled;     // Stop parsing when non-zero
+
+    // Only valid during parse()
+    ZyppHistoryEvents::EventStore *   _events;
 
-    ZyppHistoryEvents::EventList      _events;
-    ZyppHistoryEvents::CommandEvent * _lastCommand;
+    // Only valid during parse(): The keys point into the mapped file
+    QHash<QByteArrayView, ZyppHistoryEvents::StringId> _stringIds;
 };
 
 
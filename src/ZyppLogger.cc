@@ -14,7 +14,6 @@
  */
 
 
-#include <unistd.h>	// getpid()
 #include <QString>
 
 #include "Logger.h"
@@ -22,10 +21,17 @@
 #include "ZyppLogger.h"
 
 
+// The formatter and the writer are called one after the other for each line
+// in the same thread; this is how the writer knows the log level.
+
+static thread_local bool zyppErrorLine = false;
+
+
 ZyppLogger::ZyppLogger()
     : _lineWriter   ( new ZyppLogLineWriter( this ) )
     , _lineFormatter( new ZyppLogLineFormatter() )
     , _zyppThreadLogger( Logger::lastLogDir(), "zypp.log" )
+    , _shutDown( 0 )
 {
     logInfo() << "Installing the zypp logger" << endl;
 
@@ -38,25 +44,30 @@ ZyppLogger::~ZyppLogger()
 {
     logInfo() << "Uninstalling the zypp logger" << endl;
 
-    // Avoid error "QMutex: destroying locked mutex" in the (main) log:
-    // The zypp thread might still be writing log messages.
-    // Give it some time to complete that.
-
-    bool locked = _mutex.tryLock( 1000 ); // millisec
-
     zypp::base::LogControl::instance().setLineFormater( 0 );
     zypp::base::LogControl::instance().setLineWriter  ( 0 );
 
+    // A zypp thread might still be inside logLine(). Give it some time to
+    // complete that, and don't let it start writing another line.
+
+    bool locked = _shutdownLock.tryLockForWrite( 1000 ); // millisec
+    _shutDown.storeRelaxed( 1 );
+
     if ( locked )
-        _mutex.unlock();
+        _shutdownLock.unlock();
+
+    // Destroying _zyppThreadLogger writes all pending lines
 }
 
 
-void ZyppLogger::logLine( const std::string & message )
+void ZyppLogger::logLine( const std::string & message, bool sync )
 {
-    QMutexLocker locker( &_mutex );
+    QReadLocker locker( &_shutdownLock );
 
-    _zyppThreadLogger.logStream() << message << endl;
+    if ( _shutDown.loadRelaxed() )
+        return;
+
+    _zyppThreadLogger.logStream().writeLine( QByteArray::fromStdString( message ), sync );
 }
 
 
@@ -66,7 +77,7 @@ void ZyppLogLineWriter::writeOut( const std::string & formatted_msg )
 {
     if ( ! formatted_msg.empty() && _zyppLogger )
     {
-        _zyppLogger->logLine( formatted_msg );
+        _zyppLogger->logLine( formatted_msg, zyppErrorLine );
     }
 }
 
@@ -82,6 +93,9 @@ ZyppLogLineFormatter::format( const std::string &          log_group,
     if ( log_level <= zypp::base::logger::E_DBG )
         return std::string(); // Ignore log level Zypp E_DBG and lower
 
+    zyppErrorLine = log_level >= zypp::base::logger::E_ERR &&
+                    log_level <= zypp::base::logger::E_INT;
+
     QString severity;
 
     switch ( log_level )
@@ -102,7 +116,7 @@ ZyppLogLineFormatter::format( const std::string &          log_group,
 
     QString lineHeader( Logger::timeStamp() );
 
-    lineHeader += QString( " [%1] " ).arg( (int) getpid() );
+    lineHeader += QString( " [%1] " ).arg( Logger::pid() );
     lineHeader += severity + " ";
 
     QString logComponent = fromUTF8( log_group );
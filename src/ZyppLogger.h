@@ -20,7 +20,8 @@
 
 #include <memory>
 #include <string>
-#include <QMutex>
+#include <QAtomicInt>
+#include <QReadWriteLock>
 
 #include <zypp-core/base/Logger.h>
 #include <zypp-core/base/LogControl.h>
@@ -64,6 +65,12 @@ struct ZyppLogLineFormatter: public zypp::base::LogControl::LineFormater
 /**
  * Class to redirect the Zypp log to the application's log for the life time of
  * this object.
+ *
+ * libzypp may log from other threads than the main thread. The lines are
+ * handed over to the background writer of the zypp logger; the threads only
+ * take a read lock, so they don't wait for each other, and heavy logging
+ * during a commit doesn't slow it down. Without a background writer, the
+ * log stream writes the lines under its own mutex.
  **/
 class ZyppLogger
 {
@@ -73,9 +80,12 @@ public:
     ~ZyppLogger();
 
     /**
-     * Write a single line to the zypp log file, protected by a mutex.
+     * Write a single line to the zypp log file. This is thread-safe.
+     * If 'sync' is 'true', wait until it is written.
+     *
+     * This does nothing once the destructor has started.
      **/
-    void logLine( const std::string & message );
+    void logLine( const std::string & message, bool sync = false );
 
 
 private:
@@ -83,8 +93,10 @@ private:
     zypp::shared_ptr<ZyppLogLineWriter>    _lineWriter;
     zypp::shared_ptr<ZyppLogLineFormatter> _lineFormatter;
 
-    QMutex _mutex;
     Logger _zyppThreadLogger;
+
+    QReadWriteLock _shutdownLock;   // locked for writing by the destructor
+    QAtomicInt     _shutDown;       // also set if the lock timed out
 };
 
 #endif // ZyppLogger_h
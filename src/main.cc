@@ -45,6 +45,7 @@ void usage()
 	 << "  -r | --read-only (default for non-root users)\n"
 	 << "  -n | --dry-run\n"
 	 << "  -d | --download-only\n"
+	 << "  -p | --prefetch\n"
          << "  -f | --no-repo-refresh\n"
          << "  -v | --force-service-view\n"
          << "  -z | --zypp-history </path/to/zypp/history>\n"
@@ -137,6 +138,7 @@ parseCommandLineOptions( QStringList & argList )
     if ( commandLineSwitch( "--read-only",          "-r", argList ) ) optFlags |= OptReadOnly;
     if ( commandLineSwitch( "--dry-run",            "-n", argList ) ) optFlags |= OptDryRun;
     if ( commandLineSwitch( "--download-only",      "-d", argList ) ) optFlags |= OptDownloadOnly;
+    if ( commandLineSwitch( "--prefetch",           "-p", argList ) ) optFlags |= OptPrefetch;
     if ( commandLineSwitch( "--no-repo-refresh",    "-f", argList ) ) optFlags |= OptNoRepoRefresh;
     if ( commandLineSwitch( "--force-service-view", "-v", argList ) ) optFlags |= OptForceServiceView;
     if ( commandLineSwitch( "--fake-root",          "",   argList ) ) optFlags |= OptFakeRoot;
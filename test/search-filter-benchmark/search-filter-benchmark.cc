@@ -0,0 +1,114 @@
+/*
+    Project:  Myrlyn Package Manager GUI
+    Copyright (c) Stefan Hundhammer <Stefan.Hundhammer@gmx.de>
+    License:  GPL V2 - See file LICENSE for details.
+
+    Microbenchmark for the SearchFilter matching: Matches per second for
+    each filter mode with typical package names.
+ */
+
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include "../../src/Logger.h"
+#include "../../src/SearchFilter.h"
+
+
+#define ROUNDS  20
+
+
+using std::cout;
+using std::endl;
+using std::string;
+
+
+/**
+ * Return a list of strings that look like package names from a full
+ * distribution: ~60k names with the usual prefixes and suffixes.
+ **/
+std::vector<string> pkgNames()
+{
+    static const char * prefixes[] = { "", "lib", "python3-", "perl-", "ghc-", "rubygem-", "texlive-", "golang-" };
+    static const char * stems[]    = { "foo", "bar", "zypp", "qt6-base", "kde-frameworks", "gtk4", "xml", "ssl", "curl", "yaml" };
+    static const char * suffixes[] = { "", "-devel", "-debuginfo", "-doc", "-lang", "-32bit" };
+
+    std::vector<string> names;
+
+    for ( int i = 0; i < 125; ++i )
+    {
+        for ( const char * prefix: prefixes )
+        {
+            for ( const char * stem: stems )
+            {
+                for ( const char * suffix: suffixes )
+                    names.push_back( string( prefix ) + stem + std::to_string( i ) + suffix );
+            }
+        }
+    }
+
+    return names;
+}
+
+
+void benchmark( const std::vector<string> & names,
+                const QString &             pattern,
+                SearchFilter::FilterMode    filterMode,
+                bool                        caseSensitive )
+{
+    SearchFilter filter( pattern, filterMode );
+    filter.setCaseSensitive( caseSensitive );
+
+    QElapsedTimer timer;
+    long matchCount = 0;
+    timer.start();
+
+    for ( int round = 0; round < ROUNDS; ++round )
+    {
+        for ( const string & name: names )
+        {
+            if ( filter.matches( name ) )
+                ++matchCount;
+        }
+    }
+
+    qint64 nanoSec    = timer.nsecsElapsed();
+    double perSec     = nanoSec > 0 ? names.size() * (double) ROUNDS * 1e9 / nanoSec : 0.0;
+
+    cout << qPrintable( SearchFilter::toString( filterMode ).leftJustified( 12 ) )
+         << ( caseSensitive ? "case sensitive   " : "case insensitive " )
+         << qPrintable( QString( "\"%1\"" ).arg( pattern ).leftJustified( 12 ) )
+         << (long) ( perSec / 1e6 ) << "."
+         << (long) ( perSec / 1e5 ) % 10 << " M matches/sec"
+         << "  (" << matchCount / ROUNDS << " hits)"
+         << endl;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    Q_UNUSED( argc );
+    Q_UNUSED( argv );
+
+    Logger logger( "/tmp/myrlyn-$USER", "search-filter-benchmark.log" );
+
+    std::vector<string> names = pkgNames();
+    cout << names.size() << " package names, " << ROUNDS << " rounds each\n" << endl;
+
+    for ( bool caseSensitive: { false, true } )
+    {
+        benchmark( names, "devel",        SearchFilter::Contains,   caseSensitive );
+        benchmark( names, "Frameworks",   SearchFilter::Contains,   caseSensitive );
+        benchmark( names, "lib",          SearchFilter::StartsWith, caseSensitive );
+        benchmark( names, "zypp42",       SearchFilter::ExactMatch, caseSensitive );
+        benchmark( names, "lib*-devel",   SearchFilter::Wildcard,   caseSensitive );
+        benchmark( names, "^python3-.*x", SearchFilter::RegExp,     caseSensitive );
+        cout << endl;
+    }
+
+    return 0;
+}
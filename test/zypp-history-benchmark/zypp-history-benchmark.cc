@@ -0,0 +1,239 @@
+/*
+    Project:  Myrlyn Package Manager GUI
+    Copyright (c) Stefan Hundhammer <Stefan.Hundhammer@gmx.de>
+    License:  GPL V2 - See file LICENSE for details.
+
+    Benchmark for the zypp history parser: Parse a large history file
+    (a sample history replicated to 1 GB by default) with one thread and
+    with one thread per CPU core.
+
+    With the default sample history, this also checks the number of
+    commands and events of each type that the parser finds, both in the
+    sample itself and in the replicated file.
+ */
+
+
+#include <iostream>
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include <QThread>
+#include <QVector>
+
+#include "../../src/Logger.h"
+#include "../../src/ZyppHistoryEvents.h"
+#include "../../src/ZyppHistoryParser.h"
+
+
+#define DEFAULT_SIZE_MB         1024
+#define DEFAULT_HISTORY_FILE    TEST_DATA_DIR "/zypp-history-morgul-vm-Leap-15.6.log"
+
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+using namespace ZyppHistoryEvents;
+
+
+/**
+ * The number of commands (index EventType::Command) and of the child events
+ * of each type (index: the EventType).
+ **/
+typedef QVector<int> EventCounts;
+
+
+// The known counts in DEFAULT_HISTORY_FILE, in the order of EventType:
+// Command, PkgInstall, PkgRemove, RepoAdd, RepoRemove, RepoUrl, RepoAlias, Patch
+
+static const int  sampleCounts[] = { 5, 2682, 0, 15, 10, 0, 0, 699 };
+static const char * countNames[] = { "commands", "install", "remove", "radd",
+                                     "rremove", "rurl", "ralias", "patch" };
+
+
+/**
+ * Count the commands and the child events of each type in 'events'.
+ **/
+EventCounts countEvents( const EventStore & events )
+{
+    EventCounts counts( (int) EventType::Patch + 1, 0 );
+    counts[ (int) EventType::Command ] = events.commandCount();
+
+    for ( int eventNo = 0; eventNo < events.eventCount(); eventNo++ )
+    {
+        int type = (int) events.eventType( eventNo );
+
+        if ( type >= 0 && type < counts.size() )
+            counts[ type ]++;
+    }
+
+    return counts;
+}
+
+
+/**
+ * Check 'counts' against the known counts of the default sample history
+ * replicated 'factor' times. Return 'true' if they are all as expected.
+ **/
+bool checkCounts( const EventCounts & counts, int factor )
+{
+    bool ok = true;
+
+    for ( int i = 0; i < counts.size(); i++ )
+    {
+        int expected = sampleCounts[ i ] * factor;
+
+        if ( counts.at( i ) != expected )
+        {
+            cerr << "ERROR: " << counts.at( i ) << " " << countNames[ i ]
+                 << ", expected " << expected << endl;
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+
+/**
+ * Parse the default sample history file 'fileName' as it is and check the
+ * counts. Return 'true' if they are all as expected.
+ **/
+bool checkSample( const QString & fileName )
+{
+    ZyppHistoryParser::setMaxThreads( 1 );
+    ZyppHistoryParser parser( fileName );
+    EventStore        events;
+
+    parser.parse( events );
+
+    return checkCounts( countEvents( events ), 1 );
+}
+
+
+/**
+ * Write 'sample' to 'fileName' over and over again until it has at least
+ * 'sizeMB' MB. Return the number of copies or 0 if there was an error.
+ **/
+int writeBigFile( const QString & fileName, const QByteArray & sample, qint64 sizeMB )
+{
+    QFile file( fileName );
+
+    if ( ! file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+        return 0;
+
+    qint64 size   = sizeMB * 1024 * 1024;
+    int    copies = 0;
+
+    while ( file.size() < size )
+    {
+        if ( file.write( sample ) != sample.size() )
+            return 0;
+
+        ++copies;
+    }
+
+    return copies;
+}
+
+
+/**
+ * Parse 'fileName' with a maximum of 'maxThreads' threads.
+ * Return the number of commands and events of each type.
+ **/
+EventCounts benchmark( const QString & fileName, int maxThreads )
+{
+    ZyppHistoryParser::setMaxThreads( maxThreads );
+    ZyppHistoryParser parser( fileName );
+    EventStore        events;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    parser.parse( events );
+
+    qint64 millisec = timer.elapsed();
+    double mbPerSec = millisec > 0 ? parser.fileSize() / 1024.0 / 1024.0 * 1000.0 / millisec : 0.0;
+
+    cout << maxThreads << ( maxThreads == 1 ? " thread:  " : " threads: " )
+         << millisec << " millisec  "
+         << (long) mbPerSec << " MB/sec  "
+         << events.commandCount() << " commands  "
+         << events.eventCount()   << " events  "
+         << events.stringCount()  << " strings"
+         << endl;
+
+    return countEvents( events );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    qint64  sizeMB      = argc > 1 ? QString( argv[1] ).toLongLong() : DEFAULT_SIZE_MB;
+    QString historyFile = argc > 2 ? QString( argv[2] ) : QString( DEFAULT_HISTORY_FILE );
+
+    Logger logger( "/tmp/myrlyn-$USER", "zypp-history-benchmark.log" );
+
+    QFile sampleFile( historyFile );
+
+    if ( sizeMB <= 0 || ! sampleFile.open( QIODevice::ReadOnly ) )
+    {
+        cerr << "Usage: " << argv[0] << " [size-MB] [history-file]" << endl;
+        return 1;
+    }
+
+    QByteArray sample      = sampleFile.readAll();
+    bool       knownSample = historyFile == DEFAULT_HISTORY_FILE;
+
+    if ( knownSample && ! checkSample( historyFile ) )
+    {
+        cerr << "\nERROR: Wrong results for " << qPrintable( historyFile ) << endl;
+        return 2;
+    }
+
+    if ( ! sample.endsWith( '\n' ) )
+        sample += '\n';
+
+    QString bigFile = QDir::tempPath() + "/zypp-history-benchmark.log";
+    cout << "Writing " << sizeMB << " MB to " << qPrintable( bigFile ) << endl;
+
+    int copies = writeBigFile( bigFile, sample, sizeMB );
+
+    if ( copies == 0 )
+    {
+        cerr << "Can't write " << qPrintable( bigFile ) << endl;
+        QFile::remove( bigFile );
+        return 1;
+    }
+
+    cout << endl;
+
+    // The first round also gets the file into the page cache
+
+    benchmark( bigFile, 1 );
+    EventCounts expected = benchmark( bigFile, 1 );
+    int result = 0;
+
+    // Both the single-threaded and the multi-threaded parser might lose the
+    // same events, so compare with the known counts of the sample, too
+
+    if ( knownSample && ! checkCounts( expected, copies ) )
+    {
+        cerr << "\nERROR: Wrong results with 1 thread for "
+             << copies << " copies of the sample" << endl;
+        result = 2;
+    }
+
+    if ( QThread::idealThreadCount() > 1 &&
+         benchmark( bigFile, QThread::idealThreadCount() ) != expected )
+    {
+        cerr << "\nERROR: Different results with multiple threads" << endl;
+        result = 2;
+    }
+
+    QFile::remove( bigFile );
+
+    return result;
+}